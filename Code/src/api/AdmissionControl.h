@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "../metrics/Metrics.h"
+
+// Route classes in priority order; lower values are shed last under overload
+enum class RouteClass {
+    Emergency = 0,      // /api/emergency/*
+    HelpRequest,        // POST /api/help-requests
+    Standard,           // auth, profiles, single-record reads and updates
+    Dashboard,          // collection listings, security and admin views
+    Signup,             // POST */signup
+    Count
+};
+
+inline const char* routeClassName(RouteClass routeClass) {
+    static const char* names[] = {"emergency", "help_request", "standard", "dashboard", "signup"};
+    return names[static_cast<int>(routeClass)];
+}
+
+inline RouteClass classifyRoute(const std::string& method, const std::string& uri) {
+    std::size_t end = uri.find('?');
+    std::string path = uri.substr(0, end);
+
+    if (path.compare(0, 15, "/api/emergency/") == 0 || path == "/api/emergency") return RouteClass::Emergency;
+    if (method == "POST" && path == "/api/help-requests") return RouteClass::HelpRequest;
+    if (method == "POST" && path.size() > 7 && path.compare(path.size() - 7, 7, "/signup") == 0) {
+        return RouteClass::Signup;
+    }
+    if (method == "GET") {
+        if (path.compare(0, 14, "/api/security/") == 0 || path.compare(0, 11, "/api/admin/") == 0) {
+            return RouteClass::Dashboard;
+        }
+        // A bare collection such as /api/volunteers lists every row
+        if (path.compare(0, 5, "/api/") == 0 && path.find('/', 5) == std::string::npos) {
+            return RouteClass::Dashboard;
+        }
+    }
+    return RouteClass::Standard;
+}
+
+// Token-bucket admission control in front of the request handlers.
+//
+// Every request is charged against two buckets: one for its client within
+// its route class and one shared by the whole class, so a single noisy client
+// and a crowd of clients are both held to a rate. On top of that, each class
+// may only hold a share of the requests the scheduler can take, running or
+// queued (RequestScheduler::capacity()): admitted requests wait their turn
+// in the scheduler's queues, and only past that, as the server fills up,
+// are signups refused first and emergency traffic last, so critical requests
+// still find room when the rest is being shed. Refusals carry a
+// Retry-After hint derived from the bucket deficit.
+class AdmissionControl {
+public:
+    static constexpr std::size_t kClasses = static_cast<std::size_t>(RouteClass::Count);
+
+    struct Limits {
+        double clientRate;       // tokens per second per client (0 = unlimited)
+        double clientBurst;
+        double classRate;        // tokens per second for the class (0 = unlimited)
+        double classBurst;
+        double workerShare;      // fraction of the scheduler's capacity the class may occupy
+    };
+
+    struct Decision {
+        bool admitted;
+        int retryAfterSeconds;
+        const char* reason;      // "client", "class" or "overload" when refused
+    };
+
+private:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxClientsPerShard = 4096;
+    static constexpr int64_t kIdleNanos = 60LL * 1000000000LL;
+
+    struct Bucket {
+        double tokens = -1;      // negative until first use, then starts full
+        int64_t lastNanos = 0;
+
+        // Seconds to wait for one token, or 0 if one was taken
+        double take(double rate, double burst, int64_t nowNanos) {
+            if (rate <= 0) return 0;
+            if (tokens < 0) {
+                tokens = burst;
+            } else {
+                double elapsed = static_cast<double>(nowNanos - lastNanos) / 1e9;
+                tokens = std::min(burst, tokens + elapsed * rate);
+            }
+            lastNanos = nowNanos;
+            if (tokens >= 1) {
+                tokens -= 1;
+                return 0;
+            }
+            return (1 - tokens) / rate;
+        }
+    };
+
+    struct ClientBuckets {
+        std::string key;
+        std::array<Bucket, kClasses> buckets;
+        int64_t lastNanos = 0;
+    };
+
+    // Clients in least-recently-seen order; the map's keys view the list nodes
+    struct Shard {
+        std::mutex mutex;
+        std::list<ClientBuckets> recent;   // most recently seen first
+        std::unordered_map<std::string_view, std::list<ClientBuckets>::iterator> clients;
+    };
+
+    struct ClassState {
+        std::mutex mutex;
+        Bucket bucket;
+        std::atomic<int> inFlight{0};
+        metrics::Counter* admitted = nullptr;
+        metrics::Counter* rejectedClient = nullptr;
+        metrics::Counter* rejectedClass = nullptr;
+        metrics::Counter* rejectedOverload = nullptr;
+    };
+
+    std::array<Limits, kClasses> limits = {{
+        {50, 100, 0, 0, 1.0},       // emergency
+        {5, 10, 200, 400, 0.9},     // help request
+        {20, 40, 500, 1000, 0.75},  // standard
+        {10, 20, 300, 600, 0.6},    // dashboard
+        {1, 5, 50, 100, 0.5},       // signup
+    }};
+
+    std::array<Shard, kShards> shards;
+    std::array<ClassState, kClasses> classes;
+    std::atomic<int> inFlight{0};
+    std::atomic<int> capacity{80};
+
+    AdmissionControl() {
+        metrics::Registry& registry = metrics::Registry::instance();
+        for (std::size_t i = 0; i < kClasses; ++i) {
+            std::string name = routeClassName(static_cast<RouteClass>(i));
+            ClassState& state = classes[i];
+            state.admitted = &registry.counter("admission_admitted_total",
+                "Requests admitted by route class", metrics::labels({{"class", name}}));
+            state.rejectedClient = &registry.counter("admission_rejected_total",
+                "Requests refused by route class and reason", metrics::labels({{"class", name}, {"reason", "client"}}));
+            state.rejectedClass = &registry.counter("admission_rejected_total",
+                "Requests refused by route class and reason", metrics::labels({{"class", name}, {"reason", "class"}}));
+            state.rejectedOverload = &registry.counter("admission_rejected_total",
+                "Requests refused by route class and reason", metrics::labels({{"class", name}, {"reason", "overload"}}));
+            registry.gauge("admission_in_flight", "Requests currently being served by route class",
+                [&state]() { return static_cast<double>(state.inFlight.load(std::memory_order_relaxed)); },
+                metrics::labels({{"class", name}}));
+        }
+    }
+
+    static int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static int retryAfter(double seconds) {
+        return std::max(1, static_cast<int>(std::ceil(seconds)));
+    }
+
+    // Caller holds the shard lock. Moves the client to the front of the shard,
+    // then drops clients from the back while they have been idle for a minute
+    // or the shard holds more than kMaxClientsPerShard; each call does work
+    // only for the entries it removes.
+    static ClientBuckets& touch(Shard& shard, const std::string& key, int64_t now) {
+        auto found = shard.clients.find(key);
+        if (found != shard.clients.end()) {
+            shard.recent.splice(shard.recent.begin(), shard.recent, found->second);
+        } else {
+            shard.recent.emplace_front();
+            shard.recent.front().key = key;
+            shard.clients.emplace(shard.recent.front().key, shard.recent.begin());
+        }
+        ClientBuckets& client = shard.recent.front();
+        client.lastNanos = now;
+        while (shard.recent.size() > 1 &&
+               (shard.recent.size() > kMaxClientsPerShard || now - shard.recent.back().lastNanos > kIdleNanos)) {
+            shard.clients.erase(shard.recent.back().key);
+            shard.recent.pop_back();
+        }
+        return client;
+    }
+
+public:
+    // Releases the request's worker share when the request finishes
+    class Ticket {
+    private:
+        AdmissionControl* owner = nullptr;
+        RouteClass routeClass = RouteClass::Standard;
+
+    public:
+        Ticket() {}
+        Ticket(AdmissionControl* owner, RouteClass routeClass) : owner(owner), routeClass(routeClass) {}
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+        Ticket(Ticket&& other) noexcept : owner(other.owner), routeClass(other.routeClass) { other.owner = nullptr; }
+        Ticket& operator=(Ticket&& other) noexcept {
+            if (this != &other) {
+                release();
+                owner = other.owner;
+                routeClass = other.routeClass;
+                other.owner = nullptr;
+            }
+            return *this;
+        }
+        ~Ticket() { release(); }
+
+        void release() {
+            if (owner) owner->finish(routeClass);
+            owner = nullptr;
+        }
+    };
+
+    static AdmissionControl& instance() {
+        static AdmissionControl control;
+        return control;
+    }
+
+    // Requests the shares are computed against: the scheduler's slots plus
+    // one queue's depth, since admitted requests are counted while they wait
+    void setCapacity(int count) {
+        if (count > 0) capacity.store(count, std::memory_order_relaxed);
+    }
+
+    void setLimits(RouteClass routeClass, const Limits& classLimits) {
+        ClassState& state = classes[static_cast<std::size_t>(routeClass)];
+        std::lock_guard<std::mutex> lock(state.mutex);
+        limits[static_cast<std::size_t>(routeClass)] = classLimits;
+    }
+
+    // Admit or refuse one request; on admission the ticket holds its worker share
+    Decision admit(RouteClass routeClass, const std::string& clientKey, Ticket& ticket) {
+        std::size_t index = static_cast<std::size_t>(routeClass);
+        ClassState& state = classes[index];
+        int64_t now = nowNanos();
+        Limits classLimits;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            classLimits = limits[index];
+        }
+
+        // Occupancy first: it is the cheapest check and the one that protects critical traffic
+        int share = std::max(1, static_cast<int>(capacity.load(std::memory_order_relaxed) * classLimits.workerShare));
+        int occupied = inFlight.fetch_add(1, std::memory_order_acq_rel);
+        if (occupied >= share) {
+            inFlight.fetch_sub(1, std::memory_order_acq_rel);
+            state.rejectedOverload->inc();
+            return {false, 1, "overload"};
+        }
+
+        double wait = 0;
+        {
+            Shard& shard = shards[std::hash<std::string>()(clientKey) % kShards];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ClientBuckets& client = touch(shard, clientKey, now);
+            wait = client.buckets[index].take(classLimits.clientRate, classLimits.clientBurst, now);
+        }
+        if (wait > 0) {
+            inFlight.fetch_sub(1, std::memory_order_acq_rel);
+            state.rejectedClient->inc();
+            return {false, retryAfter(wait), "client"};
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            wait = state.bucket.take(classLimits.classRate, classLimits.classBurst, now);
+        }
+        if (wait > 0) {
+            inFlight.fetch_sub(1, std::memory_order_acq_rel);
+            state.rejectedClass->inc();
+            return {false, retryAfter(wait), "class"};
+        }
+
+        state.inFlight.fetch_add(1, std::memory_order_relaxed);
+        state.admitted->inc();
+        ticket = Ticket(this, routeClass);
+        return {true, 0, ""};
+    }
+
+    void finish(RouteClass routeClass) {
+        classes[static_cast<std::size_t>(routeClass)].inFlight.fetch_sub(1, std::memory_order_relaxed);
+        inFlight.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    int inFlightRequests() const {
+        return inFlight.load(std::memory_order_relaxed);
+    }
+};
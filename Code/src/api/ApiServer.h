@@ -5,6 +5,7 @@
 #include <Poco/Net/HTTPRequestHandler.h>
 #include <Poco/Net/HTTPRequestHandlerFactory.h>
 #include <Poco/Net/HTTPServerRequest.h>
+#include <Poco/Net/HTTPServerRequestImpl.h>
 #include <Poco/Net/HTTPServerResponse.h>
 #include <Poco/Net/ServerSocket.h>
 #include <Poco/Util/ServerApplication.h>
@@ -12,8 +13,20 @@
 #include <Poco/JSON/Parser.h>
 #include <Poco/Dynamic/Var.h>
 #include <Poco/JSON/Array.h>
+#include <Poco/URI.h>
+#include <Poco/Timespan.h>
+#include <Poco/Util/Option.h>
+#include <Poco/Util/OptionSet.h>
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <initializer_list>
+#include <string_view>
 
 #include "../controllers/PeopleInCrisisController.h"
 #include "../controllers/VolunteerController.h"
@@ -22,7 +35,29 @@
 #include "../controllers/AdminController.h"
 #include "../controllers/AlertSystemController.h"
 #include "../controllers/HelpRequestController.h"
+#include "../controllers/ExportController.h"
+#include "../controllers/ImportController.h"
+#include "../controllers/SearchController.h"
 #include "../database/DatabaseManager.h"
+#include "../database/StatementDeadline.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+#include "../security/SessionStore.h"
+#include "../security/PasswordHasher.h"
+#include "../security/CredentialIndex.h"
+#include "../security/LoginThrottle.h"
+#include "../security/AuditLog.h"
+#include "AdmissionControl.h"
+#include "RequestScheduler.h"
+#include "ServerConfig.h"
+#include "Arena.h"
+#include "Compression.h"
+#include "Json.h"
+#include "JsonDecode.h"
+#include "Lifecycle.h"
+#include "ListenerHandoff.h"
+#include "../cluster/ClusterChannel.h"
+#include "../cluster/Supervisor.h"
 
 using namespace Poco::Net;
 using namespace Poco::Util;
@@ -38,16 +73,45 @@ private:
     ReliefProviderController reliefProviderController;
     GovernmentAgencyController governmentAgencyController;
     AdminController adminController;
+    ExportController exportController;
+    ImportController importController;
+    SearchController searchController;
     AlertSystem alertSystem;
+    AdmissionControl::Ticket ticket;  // released when the handler is destroyed
+    RequestScheduler::Slot slot;
+    Lifecycle::Request inFlight;      // shutdown waits for this to be released
 
 public:
-    ApiRequestHandler() : adminController(&alertSystem) {}
+    // Limits for the request after its headers are read; main() sets them from
+    // ServerConfig. The header timeout is the one HTTPServerParams applies
+    struct Timeouts {
+        StatementDeadline::Clock::duration handler = std::chrono::seconds(30);
+        Poco::Timespan header{10, 0};
+        Poco::Timespan body{30, 0};
+        Poco::Timespan write{30, 0};
+    };
+
+    static Timeouts& timeouts() {
+        static Timeouts configured;
+        return configured;
+    }
+
+    explicit ApiRequestHandler(Lifecycle::Request request)
+        : adminController(&alertSystem), inFlight(std::move(request)) {}
+
+    ApiRequestHandler(Lifecycle::Request request, AdmissionControl::Ticket admission, RequestScheduler::Slot execution)
+        : adminController(&alertSystem), ticket(std::move(admission)), slot(std::move(execution)),
+          inFlight(std::move(request)) {}
 
     void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
         response.setContentType("application/json");
         response.add("Access-Control-Allow-Origin", "*");
         response.add("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        response.add("Access-Control-Allow-Headers", "Content-Type");
+        response.add("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        if (Lifecycle::instance().isDraining()) {
+            // Let the client reconnect to the process taking over
+            response.setKeepAlive(false);
+        }
         
         if (request.getMethod() == "OPTIONS") {
             response.setStatus(HTTPResponse::HTTP_OK);
@@ -55,29 +119,24 @@ public:
             return;
         }
         
+        std::size_t route = matchRoute(request.getURI());
+        SocketTimeouts socketTimeouts(request);
+        StatementDeadline::Scope deadline(route < routes().size() && routes()[route].bulk
+                                              ? StatementDeadline::Clock::duration::zero()
+                                              : timeouts().handler);
+
+        // Per-request scratch memory, reset when the request is done
+        Arena::Scope arena;
+        // Encodings and cached copy the client can take, for sendJson()
+        ResponseCompression::Scope compression(request.get("Accept-Encoding", ""), request.get("If-None-Match", ""),
+                                               request.getMethod() == "GET");
+        
         std::string uri = request.getURI();
+        auto started = std::chrono::steady_clock::now();
         
         try {
-            if (uri.find("/api/people-in-crisis") == 0) {
-                handlePeopleInCrisisRequests(request, response);
-            } else if (uri.find("/api/help-requests") == 0) {
-                handleHelpRequestsRequests(request, response);
-            } else if (uri.find("/api/volunteers") == 0) {
-                handleVolunteerRequests(request, response);
-            } else if (uri.find("/api/relief-providers") == 0) {
-                handleReliefProviderRequests(request, response);
-            } else if (uri.find("/api/government-agencies") == 0) {
-                handleGovernmentAgencyRequests(request, response);
-            } else if (uri.find("/api/alerts/config") == 0) {
-                handleAlertConfigRequests(request, response);
-            } else if (uri.find("/api/auth") == 0) {
-                handleAuthRequests(request, response);
-            } else if (uri.find("/api/profiles") == 0) {
-                handleProfileRequests(request, response);
-            } else if (uri.find("/api/emergency") == 0) {
-                handleEmergencyRequests(request, response);
-            } else if (uri.find("/api/security") == 0) {
-                handleSecurityRequests(request, response);
+            if (route < routes().size()) {
+                (this->*routes()[route].handle)(request, response);
             } else {
                 // Not found
                 Object result;
@@ -94,12 +153,93 @@ public:
             response.setStatus(HTTPResponse::HTTP_INTERNAL_SERVER_ERROR);
             Poco::JSON::Stringifier::stringify(result, response.send());
         }
+        
+        routeMetrics().record(route, request.getMethod(), static_cast<int>(response.getStatus()),
+                              std::chrono::steady_clock::now() - started);
     }
 
-private:
-    // Helper to parse JSON from request body
-    Object::Ptr parseJsonBody(HTTPServerRequest& request) {
-        std::istream& body = request.stream();
+    // Body and write timeouts on the request's socket, back to the header timeout afterwards
+    class SocketTimeouts {
+    private:
+        Poco::Net::StreamSocket* socket = nullptr;
+
+    public:
+        explicit SocketTimeouts(HTTPServerRequest& request) {
+            auto* impl = dynamic_cast<Poco::Net::HTTPServerRequestImpl*>(&request);
+            if (!impl) return;
+            try {
+                impl->socket().setReceiveTimeout(timeouts().body);
+                impl->socket().setSendTimeout(timeouts().write);
+                socket = &impl->socket();
+            } catch (const Poco::Exception&) {
+                // Closed already; the request fails on its first read or write
+            }
+        }
+        SocketTimeouts(const SocketTimeouts&) = delete;
+        SocketTimeouts& operator=(const SocketTimeouts&) = delete;
+        ~SocketTimeouts() {
+            if (!socket) return;
+            try {
+                socket->setReceiveTimeout(timeouts().header);
+                socket->setSendTimeout(timeouts().header);
+            } catch (const Poco::Exception&) {
+            }
+        }
+    };
+
+    // A handler for every URI starting with prefix, or only for prefix itself when exact
+    struct Route {
+        const char* prefix;
+        bool exact;
+        void (ApiRequestHandler::*handle)(HTTPServerRequest&, HTTPServerResponse&);
+        bool bulk = false;  // streams whole tables; no statement deadline
+    };
+
+    // Checked in order; the first match handles the request
+    static const std::vector<Route>& routes() {
+        static const std::vector<Route> table = {
+            {"/metrics", true, &ApiRequestHandler::handleMetricsRequest},
+            {"/api/people-in-crisis", false, &ApiRequestHandler::handlePeopleInCrisisRequests},
+            {"/api/help-requests", false, &ApiRequestHandler::handleHelpRequestsRequests},
+            {"/api/volunteers", false, &ApiRequestHandler::handleVolunteerRequests},
+            {"/api/relief-providers", false, &ApiRequestHandler::handleReliefProviderRequests},
+            {"/api/government-agencies", false, &ApiRequestHandler::handleGovernmentAgencyRequests},
+            {"/api/alerts/config", false, &ApiRequestHandler::handleAlertConfigRequests},
+            {"/api/auth", false, &ApiRequestHandler::handleAuthRequests},
+            {"/api/profiles", false, &ApiRequestHandler::handleProfileRequests},
+            {"/api/emergency", false, &ApiRequestHandler::handleEmergencyRequests},
+            {"/api/admin", false, &ApiRequestHandler::handleAdminRequests},
+            {"/api/security", false, &ApiRequestHandler::handleSecurityRequests},
+            {"/api/import", false, &ApiRequestHandler::handleImportRequests, true},
+            {"/api/export", false, &ApiRequestHandler::handleExportRequests, true},
+            {"/api/search", false, &ApiRequestHandler::handleSearchRequests},
+        };
+        return table;
+    }
+
+    // Index of the route handling uri, or routes().size() if none does
+    static std::size_t matchRoute(const std::string& uri) {
+        const auto& table = routes();
+        for (std::size_t i = 0; i < table.size(); ++i) {
+            bool match = table[i].exact ? uri == table[i].prefix
+                                        : uri.compare(0, std::strlen(table[i].prefix), table[i].prefix) == 0;
+            if (match) return i;
+        }
+        return table.size();
+    }
+
+    // Request latency and status codes, labelled by the matched route's prefix
+    static metrics::RouteSet& routeMetrics() {
+        static metrics::RouteSet set([] {
+            std::vector<std::string> prefixes;
+            for (const auto& route : routes()) prefixes.push_back(route.prefix);
+            return prefixes;
+        }());
+        return set;
+    }
+
+    // Parse a JSON object from a request body stream
+    static Object::Ptr parseJsonStream(std::istream& body) {
         std::string json;
         char c;
         while (body.get(c)) {
@@ -114,6 +254,177 @@ private:
         Poco::Dynamic::Var result = parser.parse(json);
         return result.extract<Poco::JSON::Object::Ptr>();
     }
+
+    // Request body copied into the arena; contentLength < 0 when unknown (chunked).
+    // A declared length is trusted for sizing only up to 1 MiB; larger bodies grow as they arrive.
+    static std::string_view readBody(std::istream& body, Arena& arena, std::streamsize contentLength) {
+        if (contentLength >= 0 && contentLength <= (1 << 20)) {
+            char* data = static_cast<char*>(arena.allocate(static_cast<std::size_t>(contentLength), 1));
+            body.read(data, contentLength);
+            return std::string_view(data, static_cast<std::size_t>(body.gcount()));
+        }
+        std::size_t capacity = 4096;
+        std::size_t size = 0;
+        char* data = static_cast<char*>(arena.allocate(capacity, 1));
+        while (body.read(data + size, static_cast<std::streamsize>(capacity - size)), body.gcount() > 0) {
+            size += static_cast<std::size_t>(body.gcount());
+            if (size == capacity) {
+                char* larger = static_cast<char*>(arena.allocate(capacity * 2, 1));
+                std::memcpy(larger, data, size);
+                data = larger;
+                capacity *= 2;
+            }
+        }
+        return std::string_view(data, size);
+    }
+
+    // Token from an "Authorization: Bearer <token>" header
+    static std::string bearerToken(const HTTPServerRequest& request) {
+        const std::string prefix = "Bearer ";
+        std::string header = request.get("Authorization", "");
+        if (header.compare(0, prefix.size(), prefix) != 0) return "";
+        return header.substr(prefix.size());
+    }
+
+private:
+    // Helper to parse JSON from request body
+    Object::Ptr parseJsonBody(HTTPServerRequest& request) {
+        return parseJsonStream(request.stream());
+    }
+    
+    // Body as a JSON object in the request arena; on malformed input sends
+    // 400 and returns nullptr. An empty body reads as {} like parseJsonBody().
+    static const json::Value* parseArenaBody(HTTPServerRequest& request, HTTPServerResponse& response) {
+        Arena& arena = Arena::forThread();
+        std::string_view body = readBody(request.stream(), arena, request.getContentLength());
+        json::Parser parser(arena);
+        const json::Value* root = parser.parse(body.empty() ? std::string_view("{}") : body);
+        if (!root || !root->isObject()) {
+            std::string message = root ? std::string("Request body must be a JSON object")
+                                       : std::string("Invalid JSON: ") + parser.error() + " at offset " +
+                                             std::to_string(parser.errorOffset());
+            sendError(response, HTTPResponse::HTTP_BAD_REQUEST, message);
+            return nullptr;
+        }
+        return root;
+    }
+
+    // Body decoded straight into a model (json::Decoder); on malformed input,
+    // a wrong field type or a missing required field sends 400 and returns false
+    template <typename Model>
+    static bool decodeArenaBody(HTTPServerRequest& request, HTTPServerResponse& response, Model& model) {
+        Arena& arena = Arena::forThread();
+        std::string_view body = readBody(request.stream(), arena, request.getContentLength());
+        json::Decoder decoder(arena);
+        if (!decoder.decode(body, model)) {
+            sendError(response, HTTPResponse::HTTP_BAD_REQUEST,
+                      std::string("Invalid request: ") + decoder.error() + " at offset " +
+                          std::to_string(decoder.errorOffset()));
+            return false;
+        }
+        return true;
+    }
+
+    // Sends body, compressed when it is large enough and the client accepts
+    // it. Successful GETs carry an ETag; a client that sends it back gets 304.
+    static void sendJson(HTTPServerResponse& response, const std::string& body) {
+        ResponseCompression& compression = ResponseCompression::instance();
+        std::string tag;
+        if (ResponseCompression::conditional() && response.getStatus() == HTTPResponse::HTTP_OK) {
+            tag = ResponseCompression::etag(body);
+            response.set("ETag", tag);
+            if (ResponseCompression::notModified(tag)) {
+                response.setStatus(HTTPResponse::HTTP_NOT_MODIFIED);
+                response.setContentLength(0);
+                response.send();
+                return;
+            }
+        }
+        if (!compression.worthCompressing(body.size())) {
+            response.setContentLength(static_cast<std::streamsize>(body.size()));
+            response.send().write(body.data(), static_cast<std::streamsize>(body.size()));
+            return;
+        }
+
+        response.set("Vary", "Accept-Encoding");
+        ContentEncoding encoding = ResponseCompression::acceptedEncoding();
+        if (encoding == ContentEncoding::Identity) {
+            response.setContentLength(static_cast<std::streamsize>(body.size()));
+            response.send().write(body.data(), static_cast<std::streamsize>(body.size()));
+            return;
+        }
+        // Tagged bodies are compressed once and reused while unchanged
+        std::shared_ptr<const std::string> packed =
+            tag.empty() ? std::make_shared<const std::string>(compression.compress(body, encoding))
+                        : compression.compressed(tag, body, encoding);
+        response.set("Content-Encoding", ResponseCompression::name(encoding));
+        response.setContentLength(static_cast<std::streamsize>(packed->size()));
+        response.send().write(packed->data(), static_cast<std::streamsize>(packed->size()));
+    }
+
+    // A Poco tree, stringified so it goes through the same path
+    static void sendJson(HTTPServerResponse& response, const Array& tree) {
+        std::ostringstream body;
+        Poco::JSON::Stringifier::stringify(tree, body);
+        sendJson(response, body.str());
+    }
+
+    // {"status":"success"} or {"status":"error","message":failure}
+    static void sendStatus(HTTPServerResponse& response, bool success, std::string_view failure) {
+        std::string& body = json::responseBuffer();
+        json::Writer writer(body);
+        writer.beginObject().field("status", success ? "success" : "error");
+        if (!success) writer.field("message", failure);
+        writer.endObject();
+        sendJson(response, body);
+    }
+
+    static void sendError(HTTPServerResponse& response, HTTPResponse::HTTPStatus status, std::string_view message) {
+        response.setStatus(status);
+        sendStatus(response, false, message);
+    }
+
+    // Query parameter as a decimal number; false unless all of it is one that fits
+    template <typename T>
+    static bool parseNumber(const std::string& text, T& value) {
+        const char* end = text.data() + text.size();
+        auto parsed = std::from_chars(text.data(), end, value);
+        return parsed.ec == std::errc() && parsed.ptr == end;
+    }
+
+    // Session for the request's bearer token; invalid if missing or expired
+    SessionInfo authenticate(const HTTPServerRequest& request) {
+        return SessionStore::instance().validate(bearerToken(request));
+    }
+
+    // Sends 401 without a valid session and 403 unless it belongs to one of
+    // the user types allowed; true if the request may go on
+    bool requireSession(const HTTPServerRequest& request, HTTPServerResponse& response,
+                        std::initializer_list<std::string_view> allowed) {
+        SessionInfo session = authenticate(request);
+        if (!session.valid()) {
+            sendError(response, HTTPResponse::HTTP_UNAUTHORIZED, "Invalid or expired session");
+            return false;
+        }
+        if (std::find(allowed.begin(), allowed.end(), session.userType) == allowed.end()) {
+            sendError(response, HTTPResponse::HTTP_FORBIDDEN, "Not permitted for this account");
+            return false;
+        }
+        return true;
+    }
+    
+    // Handle Prometheus scrape requests
+    void handleMetricsRequest(HTTPServerRequest& request, HTTPServerResponse& response) {
+        if (request.getMethod() != "GET") {
+            response.setStatus(HTTPResponse::HTTP_METHOD_NOT_ALLOWED);
+            response.send();
+            return;
+        }
+        std::string body = metrics::Registry::instance().exposition();
+        response.setContentType("text/plain; version=0.0.4");
+        response.setContentLength(static_cast<std::streamsize>(body.size()));
+        response.send() << body;
+    }
     
     // Handle PeopleInCrisis API endpoints
     void handlePeopleInCrisisRequests(HTTPServerRequest& request, HTTPServerResponse& response) {
@@ -149,15 +460,10 @@ private:
             }
         } else if (method == "POST" && uri == "/api/people-in-crisis/signup") {
             // Create new person in crisis
-            auto json = parseJsonBody(request);
-            bool success = peopleInCrisisController.signUp(json);
-            
-            Object result;
-            result.set("status", success ? "success" : "error");
-            if (!success) {
-                result.set("message", "Failed to create user. Username may already exist.");
-            }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            PeopleInCrisis person;
+            if (!decodeArenaBody(request, response, person)) return;
+            bool success = peopleInCrisisController.signUp(person);
+            sendStatus(response, success, "Failed to create user. Username may already exist.");
         } else if (method == "PUT" && uri.find("/api/people-in-crisis/") == 0) {
             // Update person
             std::string idStr = uri.substr(22); // Extract ID from URI
@@ -206,19 +512,37 @@ private:
         }
     }
     
-    // Handle HelpRequests API endpoints
+    // Handle HelpRequests API endpoints. Bodies are parsed into the request
+    // arena and responses streamed by json::Writer, without Poco JSON trees.
     void handleHelpRequestsRequests(HTTPServerRequest& request, HTTPServerResponse& response) {
         std::string uri = request.getURI();
         std::string method = request.getMethod();
         
-        if (method == "GET" && uri == "/api/help-requests") {
-            // Get all help requests
-            auto all = helpRequestController.getAllRequests();
-            Array result;
+        if (method == "GET" && Poco::URI(uri).getPath() == "/api/help-requests") {
+            // Get all help requests, or ?from=&to= (datetime or epoch ms) for a time window
+            Poco::URI parsed(uri);
+            EpochMillis from = INT64_MIN;
+            EpochMillis to = INT64_MAX;
+            bool windowed = false;
+            for (const auto& param : parsed.getQueryParameters()) {
+                if (param.first != "from" && param.first != "to") continue;
+                if (!parseTimestampOrMillis(param.second, param.first == "from" ? from : to)) {
+                    sendError(response, HTTPResponse::HTTP_BAD_REQUEST,
+                        param.first + " must be a datetime or epoch milliseconds");
+                    return;
+                }
+                windowed = true;
+            }
+            auto all = windowed ? helpRequestController.getRequestsBetween(from, to)
+                                : helpRequestController.getAllRequests();
+            std::string& body = json::responseBuffer();
+            json::Writer writer(body);
+            writer.beginArray();
             for (const auto& req : all) {
-                result.add(req.toJSON());
+                req.writeJSON(writer);
             }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            writer.endArray();
+            sendJson(response, body);
 
         } else if (method == "GET" && uri.find("/api/help-requests/user/") == 0) {
             // Get help requests by user ID
@@ -226,11 +550,14 @@ private:
             int id = std::stoi(idStr);
             
             auto requests = helpRequestController.getRequestsByRequesterId(id);
-            Array result;
+            std::string& body = json::responseBuffer();
+            json::Writer writer(body);
+            writer.beginArray();
             for (const auto& req : requests) {
-                result.add(req.toJSON());
+                req.writeJSON(writer);
             }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            writer.endArray();
+            sendJson(response, body);
 
         } else if (method == "GET" && uri.find("/api/help-requests/") == 0) {
             // Get help request by ID
@@ -239,45 +566,30 @@ private:
             
             auto request = helpRequestController.getRequestById(id);
             if (request.getId() != 0) {
-                std::ostringstream oss;
-                Poco::JSON::Stringifier::stringify(request.toJSON(), oss);
-                response.send() << oss.str();
-            }else {
-                Object result;
-                result.set("status", "error");
-                result.set("message", "Help request not found");
-                response.setStatus(HTTPResponse::HTTP_NOT_FOUND);
-                Poco::JSON::Stringifier::stringify(result, response.send());
-
+                std::string& body = json::responseBuffer();
+                json::Writer writer(body);
+                request.writeJSON(writer);
+                sendJson(response, body);
+            } else {
+                sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Help request not found");
             }
         } else if (method == "POST" && uri == "/api/help-requests") {
             // Create new help request
-            auto json = parseJsonBody(request);
-            bool success = helpRequestController.createRequest(json);
-            
-            Object result;
-            result.set("status", success ? "success" : "error");
-            if (!success) {
-                result.set("message", "Failed to create help request");
-            }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            HelpRequest helpRequest;
+            if (!decodeArenaBody(request, response, helpRequest)) return;
+            bool success = helpRequestController.createRequest(helpRequest);
+            sendStatus(response, success, "Failed to create help request");
 
         } else if (method == "PUT" && uri.find("/api/help-requests/") == 0) {
             // Update help request status
             std::string idStr = uri.substr(19); // Extract ID from URI
             int id = std::stoi(idStr);
             
-            auto json = parseJsonBody(request);
-            std::string status = json->getValue<std::string>("status");
-            
-            bool success = helpRequestController.updateStatus(id, status);
-            
-            Object result;
-            result.set("status", success ? "success" : "error");
-            if (!success) {
-                result.set("message", "Failed to update help request");
-            }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            const json::Value* json = parseArenaBody(request, response);
+            if (!json) return;
+            std::string status;
+            bool success = json->get("status", status) && helpRequestController.updateStatus(id, status);
+            sendStatus(response, success, "Failed to update help request");
 
         } else if (method == "DELETE" && uri.find("/api/help-requests/") == 0) {
             // Delete help request
@@ -285,22 +597,10 @@ private:
             int id = std::stoi(idStr);
             
             bool success = helpRequestController.deleteRequest(id);
-            
-            Object result;
-            result.set("status", success ? "success" : "error");
-            if (!success) {
-                result.set("message", "Failed to delete help request");
-            }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            sendStatus(response, success, "Failed to delete help request");
 
         } else {
-            // Not found
-            Object result;
-            result.set("status", "error");
-            result.set("message", "Endpoint not found");
-            response.setStatus(HTTPResponse::HTTP_NOT_FOUND);
-            Poco::JSON::Stringifier::stringify(result, response.send());
-
+            sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Endpoint not found");
         }
     }
     
@@ -316,7 +616,7 @@ private:
             for (const auto& volunteer : all) {
                 result.add(volunteer.toJSON());
             }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            sendJson(response, result);
         } else if (method == "GET" && uri.find("/api/volunteers/history/") == 0) {
             // Get volunteer history
             std::string idStr = uri.substr(25); // Extract ID from URI
@@ -347,14 +647,10 @@ private:
             }
         } else if (method == "POST" && uri == "/api/volunteers/signup") {
             // Sign up new volunteer
-            auto json = parseJsonBody(request);
-            bool success = volunteerController.signUp(json);
-            Object result;
-            result.set("status", success ? "success" : "error");
-            if (!success) {
-                result.set("message", "Failed to sign up volunteer.");
-            }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            Volunteer volunteer;
+            if (!decodeArenaBody(request, response, volunteer)) return;
+            bool success = volunteerController.signUp(volunteer);
+            sendStatus(response, success, "Failed to sign up volunteer.");
         } else if (method == "POST" && uri.find("/api/volunteers/donate/") == 0) {
             // Handle donation
             std::string idStr = uri.substr(24); // Extract ID from URI
@@ -449,51 +745,93 @@ private:
             std::string password = json->getValue<std::string>("password");
             std::string userType = json->getValue<std::string>("userType");
             
-            bool authenticated = false;
-            int userId = 0;
+            // Refuse locked accounts and addresses before doing any hashing work
+            std::string clientIp = request.clientAddress().host().toString();
+            LoginThrottle::Decision decision = LoginThrottle::instance().check(userType, username, clientIp);
+            if (!decision.allowed) {
+                Object result;
+                result.set("status", "error");
+                result.set("message", "Too many failed login attempts, try again later");
+                response.setStatus(HTTPResponse::HTTP_TOO_MANY_REQUESTS);
+                response.set("Retry-After", std::to_string(decision.retryAfterSeconds));
+                Poco::JSON::Stringifier::stringify(result, response.send());
+                return;
+            }
             
-            if (userType == "people_in_crisis") {
-                authenticated = peopleInCrisisController.authenticate(username, password);
-                if (authenticated) {
-                    auto person = peopleInCrisisController.getByUsername(username);
-                    userId = person.getId();
-                }
-            } else if (userType == "volunteer") {
-                auto volunteer = volunteerController.getByUsername(username);
-                if (volunteer.getUserID() != 0 && volunteer.verifyPassword(password)) {
-                    authenticated = true;
-                    userId = volunteer.getUserID();
-                }
-            } else if (userType == "relief_provider") {
-                auto provider = reliefProviderController.getByUsername(username);
-                if (provider.getId() != 0 && provider.verifyPassword(password)) {
-                    authenticated = true;
-                    userId = provider.getId();
-                }
-            } else if (userType == "government_agency") {
-                auto agency = governmentAgencyController.getByUsername(username);
-                if (agency.getId() != 0 && agency.verifyPassword(password)) {
-                    authenticated = true;
-                    userId = agency.getId();
+            // One index probe (or one indexed query on a miss), then verify on the hashing pool
+            Credential credential = CredentialIndex::instance().lookup(userType, username);
+            int userId = credential.id;
+            
+            bool authenticated = false;
+            {
+                // Unknown accounts are checked against a dummy hash so they take as long as known ones
+                const std::string& stored = userId != 0 ? credential.passwordHash : PasswordHasher::instance().dummyHash();
+                PasswordCheck check = PasswordHasher::instance().verify(password, stored);
+                if (check.status == HashStatus::Busy) {
+                    Object result;
+                    result.set("status", "error");
+                    result.set("message", "Server busy, retry shortly");
+                    response.setStatus(HTTPResponse::HTTP_SERVICE_UNAVAILABLE);
+                    response.set("Retry-After", "1");
+                    Poco::JSON::Stringifier::stringify(result, response.send());
+                    return;
                 }
-            } else if (userType == "admin") {
-                auto admin = adminController.login(username, password);
-                if (admin.getId() != 0) {
-                    authenticated = true;
-                    userId = admin.getId();
+                authenticated = userId != 0 && check.status == HashStatus::Match;
+                if (authenticated && check.needsRehash) {
+                    // Bring hashes made with an older iteration count up to date in the background
+                    PasswordHasher::instance().rehashAsync(CredentialIndex::tableFor(userType), userId, password,
+                        credential.passwordHash, [userType, userId](const std::string& hashed) {
+                            CredentialIndex::instance().updateHash(userType, userId, hashed);
+                        });
                 }
             }
             
+            if (authenticated) {
+                LoginThrottle::instance().recordSuccess(userType, username);
+            } else {
+                LoginThrottle::instance().recordFailure(userType, username, clientIp, userId != 0);
+            }
+            
             Object result;
             if (authenticated) {
+                SessionInfo issued;
+                std::string token = SessionStore::instance().create(userId, userType, &issued);
                 result.set("status", "success");
                 result.set("userId", userId);
                 result.set("userType", userType);
+                result.set("token", token);
+                result.set("expiresAt", static_cast<Poco::Int64>(issued.expiresAt));
             } else {
                 result.set("status", "error");
                 result.set("message", "Invalid credentials");
             }
             
+            Poco::JSON::Stringifier::stringify(result, response.send());
+        } else if (method == "POST" && uri == "/api/auth/logout") {
+            bool revoked = SessionStore::instance().revoke(bearerToken(request));
+
+            Object result;
+            result.set("status", revoked ? "success" : "error");
+            if (!revoked) {
+                result.set("message", "Invalid or expired session");
+                response.setStatus(HTTPResponse::HTTP_UNAUTHORIZED);
+            }
+            Poco::JSON::Stringifier::stringify(result, response.send());
+        } else if (method == "GET" && uri == "/api/auth/session") {
+            // Resolve the caller's token without touching the database
+            SessionInfo session = authenticate(request);
+
+            Object result;
+            if (session.valid()) {
+                result.set("status", "success");
+                result.set("userId", session.userId);
+                result.set("userType", session.userType);
+                result.set("expiresAt", static_cast<Poco::Int64>(session.expiresAt));
+            } else {
+                result.set("status", "error");
+                result.set("message", "Invalid or expired session");
+                response.setStatus(HTTPResponse::HTTP_UNAUTHORIZED);
+            }
             Poco::JSON::Stringifier::stringify(result, response.send());
         } else {
             // Not found
@@ -527,7 +865,7 @@ private:
             for (const auto& provider : all) {
                 result.add(provider.toJSON());
             }
-            Poco::JSON::Stringifier::stringify(result, response.send());
+            sendJson(response, result);
         } else if (method == "GET" && uri.find("/api/relief-providers/") == 0) {
             // Get relief provider by ID
             std::string idStr = uri.substr(22); // Extract ID from URI
@@ -727,6 +1065,46 @@ private:
             // Get security logs
             auto logs = adminController.getSecurityLogs();
             Poco::JSON::Stringifier::stringify(logs, response.send());
+        } else if (method == "GET" && uri.find("/api/security/audit") == 0) {
+            // Stream audit events as NDJSON: ?limit=N for the latest N (newest first),
+            // or ?from=&to= (epoch ms) for a time window in time order
+            Poco::URI parsed(uri);
+            std::size_t limit = 100;
+            int64_t from = -1;
+            int64_t to = INT64_MAX;
+            for (const auto& param : parsed.getQueryParameters()) {
+                bool valid = true;
+                if (param.first == "limit") valid = parseNumber(param.second, limit);
+                else if (param.first == "from") valid = parseNumber(param.second, from) && from >= 0;
+                else if (param.first == "to") valid = parseNumber(param.second, to) && to >= 0;
+                if (!valid) {
+                    sendError(response, HTTPResponse::HTTP_BAD_REQUEST,
+                        param.first + " must be a non-negative number");
+                    return;
+                }
+            }
+            limit = std::min<std::size_t>(limit, 100000);
+
+            response.setContentType("application/x-ndjson");
+            response.setChunkedTransferEncoding(true);
+            std::ostream& out = response.send();
+            auto writeRecord = [&out](const AuditRecord& record) {
+                Poco::JSON::Stringifier::stringify(AdminController::auditRecordToJSON(record), out);
+                out << '\n';
+                return static_cast<bool>(out);
+            };
+            if (from >= 0) {
+                std::size_t written = 0;
+                AuditLog::instance().scan(from, to, [&](const AuditRecord& record) {
+                    if (written >= limit) return false;
+                    ++written;
+                    return writeRecord(record) && written < limit;
+                });
+            } else {
+                for (const auto& record : AuditLog::instance().latest(limit)) {
+                    if (!writeRecord(record)) break;
+                }
+            }
         } else if (method == "PUT" && uri == "/api/security/settings") {
             // Update security settings
             auto json = parseJsonBody(request);
@@ -765,39 +1143,513 @@ private:
             Poco::JSON::Stringifier::stringify(result, response.send());
         }
     }
+
+    // Bulk import: POST /api/import/{entity}, NDJSON or CSV body; admin and
+    // agency sessions only. The format comes from ?format=, then the
+    // Content-Type, then the first byte.
+    void handleImportRequests(HTTPServerRequest& request, HTTPServerResponse& response) {
+        Poco::URI parsed(request.getURI());
+        const std::string prefix = "/api/import/";
+        std::string path = parsed.getPath();
+        if (request.getMethod() != "POST" || path.compare(0, prefix.size(), prefix) != 0) {
+            sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Endpoint not found");
+            return;
+        }
+        if (!requireSession(request, response, {"admin", "government_agency"})) return;
+        std::string entity = path.substr(prefix.size());
+
+        std::string format;
+        for (const auto& param : parsed.getQueryParameters()) {
+            if (param.first == "format") format = param.second;
+        }
+        if (format.empty()) {
+            std::string type = request.getContentType();
+            if (type.find("csv") != std::string::npos) {
+                format = "csv";
+            } else if (type.find("ndjson") != std::string::npos || type.find("jsonlines") != std::string::npos) {
+                format = "ndjson";
+            } else {
+                int first = request.stream().peek();
+                format = first == '{' ? "ndjson" : "csv";
+            }
+        }
+        if (format != "csv" && format != "ndjson") {
+            sendError(response, HTTPResponse::HTTP_BAD_REQUEST, "format must be csv or ndjson");
+            return;
+        }
+
+        ImportReport report;
+        ImportController::Format kind = format == "csv" ? ImportController::Format::CSV
+                                                        : ImportController::Format::NDJSON;
+        if (!importController.importEntity(entity, request.stream(), kind, report)) {
+            sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Unknown import entity: " + entity);
+            return;
+        }
+
+        std::string& body = json::responseBuffer();
+        json::Writer writer(body);
+        writer.beginObject()
+            .field("status", report.fatal.empty() ? "success" : "error")
+            .field("rows", report.rows)
+            .field("inserted", report.inserted)
+            .field("duplicates", report.duplicates)
+            .field("failed", report.failed);
+        if (!report.fatal.empty()) writer.field("message", report.fatal);
+        writer.key("errors").beginArray();
+        for (const auto& error : report.errors) {
+            writer.beginObject().field("line", error.first).field("message", error.second).endObject();
+        }
+        writer.endArray().field("errorsTruncated", report.errorsTruncated).endObject();
+        // Rows before a fatal error stay imported; the report says how far it got
+        if (!report.fatal.empty()) response.setStatus(HTTPResponse::HTTP_BAD_REQUEST);
+        sendJson(response, body);
+    }
+
+    // Table export: GET /api/export/{table}[?format=csv|ndjson], streamed in
+    // chunks, compressed when the client accepts it; admin and agency sessions only
+    void handleExportRequests(HTTPServerRequest& request, HTTPServerResponse& response) {
+        Poco::URI parsed(request.getURI());
+        const std::string prefix = "/api/export/";
+        std::string path = parsed.getPath();
+        if (request.getMethod() != "GET" || path.compare(0, prefix.size(), prefix) != 0) {
+            sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Endpoint not found");
+            return;
+        }
+        // Tables include people in crisis and their contact details
+        if (!requireSession(request, response, {"admin", "government_agency"})) return;
+        std::string table = path.substr(prefix.size());
+        if (!ExportController::exportable(table)) {
+            sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Unknown export table: " + table);
+            return;
+        }
+
+        std::string format = "ndjson";
+        for (const auto& param : parsed.getQueryParameters()) {
+            if (param.first == "format") format = param.second;
+        }
+        if (format != "csv" && format != "ndjson") {
+            sendError(response, HTTPResponse::HTTP_BAD_REQUEST, "format must be csv or ndjson");
+            return;
+        }
+        ExportController::Format kind = format == "csv" ? ExportController::Format::CSV
+                                                        : ExportController::Format::NDJSON;
+
+        ContentEncoding encoding = ResponseCompression::acceptedEncoding();
+        response.setContentType(format == "csv" ? "text/csv; charset=utf-8" : "application/x-ndjson");
+        response.set("Content-Disposition", "attachment; filename=\"" + table + "." + format + "\"");
+        response.set("Vary", "Accept-Encoding");
+        if (encoding != ContentEncoding::Identity) {
+            response.set("Content-Encoding", ResponseCompression::name(encoding));
+        }
+        response.setChunkedTransferEncoding(true);
+        std::ostream& out = response.send();
+        // Headers are out; a failure from here on can only cut the body short
+        if (encoding != ContentEncoding::Identity) {
+            auto compressed = ResponseCompression::instance().stream(out, encoding);
+            exportController.exportTable(table, kind, *compressed);
+            compressed->close();
+        } else {
+            exportController.exportTable(table, kind, out);
+        }
+    }
+
+    // Full-text search: GET /api/search?q=...[&types=help_requests,people_in_crisis,incident_reports]
+    // [&location=...][&status=...][&limit=20][&offset=0], best matches first; score is
+    // relative to the best match in the same table (1), so higher is better
+    void handleSearchRequests(HTTPServerRequest& request, HTTPServerResponse& response) {
+        Poco::URI parsed(request.getURI());
+        if (request.getMethod() != "GET" || parsed.getPath() != "/api/search") {
+            sendError(response, HTTPResponse::HTTP_NOT_FOUND, "Endpoint not found");
+            return;
+        }
+
+        SearchQuery query;
+        for (const auto& param : parsed.getQueryParameters()) {
+            if (param.first == "q") {
+                query.text = param.second;
+            } else if (param.first == "location") {
+                query.location = param.second;
+            } else if (param.first == "status") {
+                query.status = param.second;
+            } else if (param.first == "limit" || param.first == "offset") {
+                if (!parseNumber(param.second, param.first == "limit" ? query.limit : query.offset)) {
+                    sendError(response, HTTPResponse::HTTP_BAD_REQUEST, "limit and offset must be numbers");
+                    return;
+                }
+            } else if (param.first == "types") {
+                std::istringstream types(param.second);
+                std::string type;
+                while (std::getline(types, type, ',')) {
+                    if (!SearchController::searchable(type)) {
+                        sendError(response, HTTPResponse::HTTP_BAD_REQUEST, "Unknown search type: " + type);
+                        return;
+                    }
+                    query.sources.push_back(type);
+                }
+            }
+        }
+        if (SearchController::matchExpression(query.text).empty()) {
+            sendError(response, HTTPResponse::HTTP_BAD_REQUEST, "q must contain at least one word");
+            return;
+        }
+
+        std::vector<SearchHit> hits;
+        if (!searchController.search(query, hits)) {
+            sendError(response, HTTPResponse::HTTP_SERVICE_UNAVAILABLE, "Search is not available");
+            return;
+        }
+
+        std::string& body = json::responseBuffer();
+        json::Writer writer(body);
+        writer.beginObject().field("status", "success").key("results").beginArray();
+        for (const auto& hit : hits) {
+            writer.beginObject()
+                .field("type", hit.source)
+                .field("id", hit.id)
+                .field("score", hit.score)
+                .field("snippet", hit.snippet)
+                .field("location", hit.location)
+                .field("status", hit.status);
+            writer.key("timestamp");
+            if (hit.timestamp != kNoTimestamp) {
+                writer.value(formatTimestamp(hit.timestamp));
+            } else {
+                writer.null();
+            }
+            writer.endObject();
+        }
+        writer.endArray().endObject();
+        sendJson(response, body);
+    }
+
+    // Handle Admin diagnostics endpoints; admin sessions only
+    void handleAdminRequests(HTTPServerRequest& request, HTTPServerResponse& response) {
+        std::string uri = request.getURI();
+        std::string method = request.getMethod();
+
+        if (uri.find("/api/admin/query-profile") == 0 && !requireSession(request, response, {"admin"})) return;
+        if (method == "GET" && uri.find("/api/admin/query-profile") == 0) {
+            // Per-statement timings, slowest executions and recent slow queries
+            Poco::URI parsed(uri);
+            std::size_t limit = 50;
+            for (const auto& param : parsed.getQueryParameters()) {
+                if (param.first == "limit" && !parseNumber(param.second, limit)) {
+                    sendError(response, HTTPResponse::HTTP_BAD_REQUEST, "limit must be a non-negative number");
+                    return;
+                }
+            }
+            Object result;
+            result.set("status", "success");
+            result.set("profile", QueryProfiler::instance().report(limit));
+            Poco::JSON::Stringifier::stringify(result, response.send());
+        } else if (method == "DELETE" && uri == "/api/admin/query-profile") {
+            QueryProfiler::instance().reset();
+            Object result;
+            result.set("status", "success");
+            Poco::JSON::Stringifier::stringify(result, response.send());
+        } else {
+            Object result;
+            result.set("status", "error");
+            result.set("message", "Endpoint not found");
+            response.setStatus(HTTPResponse::HTTP_NOT_FOUND);
+            Poco::JSON::Stringifier::stringify(result, response.send());
+        }
+    }
+};
+
+// Answers a request refused by admission control or the scheduler
+class RejectedRequestHandler : public HTTPRequestHandler {
+private:
+    HTTPResponse::HTTPStatus status;
+    int retryAfterSeconds;
+    std::string message;
+    Lifecycle::Request inFlight;
+
+public:
+    RejectedRequestHandler(Lifecycle::Request request, HTTPResponse::HTTPStatus status, int retryAfterSeconds,
+                           const std::string& message)
+        : status(status), retryAfterSeconds(retryAfterSeconds), message(message), inFlight(std::move(request)) {}
+
+    void handleRequest(HTTPServerRequest& request, HTTPServerResponse& response) override {
+        auto started = std::chrono::steady_clock::now();
+        response.setContentType("application/json");
+        response.add("Access-Control-Allow-Origin", "*");
+        response.setStatus(status);
+        response.set("Retry-After", std::to_string(retryAfterSeconds));
+        if (Lifecycle::instance().isDraining()) {
+            response.setKeepAlive(false);
+        }
+
+        Object result;
+        result.set("status", "error");
+        result.set("message", message);
+        Poco::JSON::Stringifier::stringify(result, response.send());
+
+        ApiRequestHandler::routeMetrics().record(ApiRequestHandler::matchRoute(request.getURI()), request.getMethod(),
+                                                 static_cast<int>(response.getStatus()),
+                                                 std::chrono::steady_clock::now() - started);
+    }
 };
 
 // Factory for creating request handlers
 class ApiRequestHandlerFactory : public HTTPRequestHandlerFactory {
+private:
+    // Signed-in clients are limited per account, everyone else per address
+    static std::string clientKey(const HTTPServerRequest& request, const SessionInfo& session) {
+        if (session.valid()) {
+            return "user\n" + session.userType + "\n" + std::to_string(session.userId);
+        }
+        return "ip\n" + request.clientAddress().host().toString();
+    }
+
 public:
     ApiRequestHandlerFactory() {
         // Initialize database
         DatabaseManager::getInstance();
+        
+        // Persisted sessions are loaded by ApiServer::recoverState()
+        SessionStore::instance();
+        AdmissionControl::instance();
+        RequestScheduler::instance();
     }
 
-    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest&) override {
-        return new ApiRequestHandler();
+    HTTPRequestHandler* createRequestHandler(const HTTPServerRequest& request) override {
+        // Counted from here so a drain also waits for requests queued for a slot
+        Lifecycle::Request inFlight;
+        // Requests already read from kept-alive connections while draining are
+        // served as usual; handleRequest() answers them with Connection: close
+        // Preflight and scrapes are never shed
+        if (request.getMethod() == "OPTIONS" || request.getURI() == "/metrics") {
+            return new ApiRequestHandler(std::move(inFlight));
+        }
+        std::string token = ApiRequestHandler::bearerToken(request);
+        SessionInfo session = token.empty() ? SessionInfo() : SessionStore::instance().validate(token);
+
+        AdmissionControl::Ticket ticket;
+        AdmissionControl::Decision decision = AdmissionControl::instance().admit(
+            classifyRoute(request.getMethod(), request.getURI()), clientKey(request, session), ticket);
+        if (!decision.admitted) {
+            return new RejectedRequestHandler(std::move(inFlight), HTTPResponse::HTTP_TOO_MANY_REQUESTS,
+                decision.retryAfterSeconds,
+                std::string(decision.reason) == "overload"
+                    ? "Server is busy, please retry shortly"
+                    : "Too many requests, please slow down");
+        }
+
+        // Blocks this connection thread until the request's queue is served
+        RequestScheduler::Slot slot = RequestScheduler::instance().acquire(
+            schedulingQueueFor(request.getURI(), session.userType));
+        if (!slot) {
+            return new RejectedRequestHandler(std::move(inFlight), HTTPResponse::HTTP_SERVICE_UNAVAILABLE, 1,
+                "Server is busy, please retry shortly");
+        }
+        return new ApiRequestHandler(std::move(inFlight), std::move(ticket), std::move(slot));
     }
 };
 
 // Main server application
 class ApiServer : public ServerApplication {
+private:
+    // Expose the HTTP server's connection queue and thread pool as gauges
+    static void registerServerGauges(HTTPServer& server) {
+        metrics::Registry& registry = metrics::Registry::instance();
+        registry.gauge("http_server_queued_connections", "Connections waiting in the HTTPServerParams queue",
+            [&server]() { return static_cast<double>(server.queuedConnections()); });
+        registry.gauge("http_server_current_threads", "Worker threads currently serving connections",
+            [&server]() { return static_cast<double>(server.currentThreads()); });
+        registry.gauge("http_server_max_threads", "Configured maximum worker threads",
+            [&server]() { return static_cast<double>(server.maxThreads()); });
+        registry.gauge("http_server_refused_connections", "Connections refused because the queue was full",
+            [&server]() { return static_cast<double>(server.refusedConnections()); });
+        registry.gauge("auth_active_sessions", "Sessions currently held by the session store",
+            []() { return static_cast<double>(SessionStore::instance().activeSessions()); });
+    }
+    
+    static void unregisterServerGauges() {
+        metrics::Registry& registry = metrics::Registry::instance();
+        registry.removeGauge("http_server_queued_connections");
+        registry.removeGauge("http_server_current_threads");
+        registry.removeGauge("http_server_max_threads");
+        registry.removeGauge("http_server_refused_connections");
+        registry.removeGauge("auth_active_sessions");
+    }
+
+    // Load sessions and login failures left by the previous process; on a hot
+    // restart only once it has flushed them, so none are missed
+    static void recoverState() {
+        SessionStore::instance().recover();
+        LoginThrottle::instance().restore();
+        AuditLog::instance().resume();
+    }
+
+    // Write everything still buffered in memory before the process exits
+    static void flushState() {
+        SessionStore::instance().flush();
+        LoginThrottle::instance().flush();
+        AuditLog::instance().sync();
+        if (!ClusterChannel::instance().isWorker()) {
+            DatabaseManager::getInstance()->checkpoint();
+        }
+        logging::Logger::instance().sync();
+    }
+    
 protected:
+    void defineOptions(OptionSet& options) override {
+        ServerApplication::defineOptions(options);
+        options.addOption(Option("config-file", "c", "Load settings from a properties file")
+            .required(false).repeatable(false).argument("path").binding("server.configFile"));
+        options.addOption(Option("port", "p", "Port to listen on")
+            .required(false).repeatable(false).argument("port").binding("server.port"));
+        options.addOption(Option("workers", "w", "Concurrent request handlers")
+            .required(false).repeatable(false).argument("count").binding("server.workers"));
+        options.addOption(Option("processes", "", "Worker processes sharing the port")
+            .required(false).repeatable(false).argument("count").binding("server.processes"));
+        options.addOption(Option("worker-channel", "", "Internal: supervisor link of a worker process")
+            .required(false).repeatable(false).argument("fd").binding("server.workerChannel"));
+        options.addOption(Option("define", "D", "Set a configuration property")
+            .required(false).repeatable(true).argument("key=value"));
+    }
+
+    // Fork workers and act as their relay and single writer until asked to stop
+    int runSupervisor(const ServerConfig& settings) {
+        DatabaseManager::getInstance();
+        SessionStore::instance().recover();
+        AuditLog::instance();
+
+        Supervisor supervisor(settings.processes, argv());
+        if (!supervisor.start()) {
+            LOG_ERROR("Could not start worker processes");
+            supervisor.stop(std::chrono::seconds(5));
+            return Application::EXIT_SOFTWARE;
+        }
+        LOG_INFO("Supervisor started: " << settings.describe());
+
+        waitForTerminationRequest();
+
+        LOG_INFO("Stopping worker processes...");
+        // Workers drain on SIGTERM; their final writes arrive while we wait
+        supervisor.stop(std::chrono::seconds(settings.drainTimeout + 5));
+        flushState();
+        return Application::EXIT_OK;
+    }
+
+    void handleOption(const std::string& name, const std::string& value) override {
+        ServerApplication::handleOption(name, value);
+        if (name == "define") {
+            std::string::size_type pos = value.find('=');
+            if (pos == std::string::npos) {
+                config().setString(value, "");
+            } else {
+                config().setString(value.substr(0, pos), value.substr(pos + 1));
+            }
+        }
+    }
+
+    void initialize(Application& self) override {
+        // Options are already bound into the application layer; files and environment sit below it
+        std::string configFile = config().getString("server.configFile", "");
+        if (!configFile.empty()) {
+            loadConfiguration(configFile);
+        } else {
+            loadConfiguration();
+        }
+        ServerConfig::addEnvironmentLayer(config());
+        ServerApplication::initialize(self);
+    }
+
     int main(const std::vector<std::string>&) override {
+        ServerConfig settings = ServerConfig::load(config());
+
+        logging::Logger& logger = logging::Logger::instance();
+        logger.setLevel(logging::parseLevel(settings.logLevel));
+        if (!settings.logFile.empty() && !logger.setOutputFile(settings.logFile)) {
+            LOG_WARN("Cannot open log file " << settings.logFile << ", logging to stderr");
+        }
+        // Before the database opens: migrations may write to the audit log and are profiled
+        AuditLog::instance().setDirectory(settings.auditDirectory);
+        QueryProfiler::instance().configure(static_cast<uint64_t>(settings.slowQueryMs), settings.slowQueryLog,
+            static_cast<std::size_t>(settings.slowestKept));
+
+        if (settings.workerChannel >= 0) {
+            // Connect before any replicated subsystem starts so it knows it is a worker
+            ClusterChannel::instance().connect(settings.workerChannel);
+        } else if (settings.processes > 1) {
+            return runSupervisor(settings);
+        }
+
         HTTPServerParams* params = new HTTPServerParams;
-        params->setMaxQueued(100);
-        params->setMaxThreads(16);
+        params->setMaxQueued(settings.queueDepth);
+        // Connection threads mostly parse and wait; the scheduler's slots bound concurrent handlers
+        params->setMaxThreads(settings.connectionThreads);
+        params->setThreadIdleTime(Poco::Timespan(settings.threadIdleTime, 0));
+        params->setKeepAlive(settings.keepAlive);
+        params->setKeepAliveTimeout(Poco::Timespan(settings.keepAliveTimeout, 0));
+        params->setMaxKeepAliveRequests(settings.maxKeepAliveRequests);
+        params->setTimeout(Poco::Timespan(settings.headerTimeout, 0));
+        auto& timeouts = ApiRequestHandler::timeouts();
+        timeouts.header = Poco::Timespan(settings.headerTimeout, 0);
+        timeouts.body = Poco::Timespan(settings.bodyTimeout, 0);
+        timeouts.write = Poco::Timespan(settings.handlerTimeout, 0);
+        timeouts.handler = std::chrono::seconds(settings.handlerTimeout);
+        PasswordHasher::instance().configure(static_cast<std::size_t>(settings.hasherThreads),
+            static_cast<std::size_t>(settings.hasherQueueDepth), static_cast<unsigned>(settings.hasherIterations));
+        RequestScheduler::instance().configure(settings.workers, settings.reservedWorkers,
+            settings.schedulerQueueDepth, std::chrono::milliseconds(settings.schedulerWait));
+        AdmissionControl::instance().setCapacity(static_cast<int>(RequestScheduler::instance().capacity()));
+        ResponseCompression::instance().configure(static_cast<std::size_t>(settings.compressMinBytes),
+            settings.compressLevel, static_cast<std::size_t>(settings.compressCacheMB) << 20);
         
-        ServerSocket socket(8080); // Listen on port 8080
+        // Take over the listening socket of a running predecessor, if any
+        ListenerHandoff::Inherited inherited = ListenerHandoff::receive(settings.handoffSocket);
+        ServerSocket socket;
+        if (inherited.valid()) {
+            socket = ServerSocket::fromFileDescriptor(inherited.listenFd);
+            LOG_INFO("Inherited listening socket from the previous process");
+            // The predecessor keeps writing the audit log until it has drained
+            AuditLog::instance().pause();
+        } else {
+            socket.bind(SocketAddress(static_cast<Poco::UInt16>(settings.port)), true, settings.reusePort);
+            socket.listen(settings.backlog);
+        }
         HTTPServer server(new ApiRequestHandlerFactory(), socket, params);
+        if (!inherited.valid()) {
+            recoverState();
+        }
+        
+        registerServerGauges(server);
         
         server.start();
-        std::cout << "Server started on port 8080" << std::endl;
+        ListenerHandoff::confirm(inherited);
+        LOG_INFO("Server started: " << settings.describe());
+        if (inherited.valid()) {
+            if (!ListenerHandoff::awaitFlushed(inherited, std::chrono::seconds(settings.drainTimeout + 10))) {
+                LOG_WARN("Previous process did not report its state flushed, loading what it wrote");
+            }
+            recoverState();
+        }
+
+        ListenerHandoff handoff(settings.handoffSocket, socket.impl()->sockfd(), [] {
+            ServerApplication::terminate();
+        });
+        if (!settings.handoffSocket.empty()) {
+            handoff.start();
+        }
         
         waitForTerminationRequest();
         
-        std::cout << "Shutting down..." << std::endl;
+        LOG_INFO("Shutting down, draining " << Lifecycle::instance().inFlightRequests() << " requests...");
+        Lifecycle::instance().beginDrain();
+        handoff.stop();
         server.stop();
+        if (!Lifecycle::instance().waitIdle(std::chrono::seconds(settings.drainTimeout))) {
+            LOG_WARN("Drain deadline passed with " << Lifecycle::instance().inFlightRequests()
+                     << " requests in flight, closing connections");
+            server.stopAll(true);
+        }
+        unregisterServerGauges();
+        flushState();
+        handoff.flushed();
+        ClusterChannel::instance().disconnect();
         
         return Application::EXIT_OK;
     }
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include "../metrics/Metrics.h"
+
+// Monotonic (bump) allocator for memory that lives exactly as long as one
+// request: parsed JSON trees, decoded strings, response scratch.
+//
+// allocate() moves a pointer forward inside the current block and only goes
+// to the heap when the block is full. Nothing is freed individually; reset()
+// drops everything at once. After a request that overflowed, reset()
+// replaces the chain with one block big enough for it, so a worker that sees
+// the same request shape again runs without touching the heap. Each worker
+// thread owns one arena (forThread()) and a Scope resets it when the request
+// ends.
+//
+// Only trivially destructible objects may live in an arena: destructors are
+// never run.
+class Arena {
+private:
+    struct Block {
+        Block* next;
+        std::size_t size;
+    };
+
+    static constexpr std::size_t kHeader = (sizeof(Block) + alignof(std::max_align_t) - 1) &
+                                           ~(alignof(std::max_align_t) - 1);
+    // Memory kept across resets; a rare huge request does not pin its peak
+    static constexpr std::size_t kMaxRetained = std::size_t(1) << 20;
+
+    Block* head = nullptr;      // most recent block; older ones follow
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    std::size_t initialSize;
+    std::size_t usedBefore = 0;  // bytes handed out from blocks other than head
+    std::size_t reserved = 0;    // total block bytes, headers excluded
+    int depth = 0;
+
+    static metrics::Counter& heapBlocks() {
+        static metrics::Counter& counter = metrics::Registry::instance().counter(
+            "request_arena_heap_blocks_total", "Blocks request arenas had to take from the heap");
+        return counter;
+    }
+
+    void grow(std::size_t size, std::size_t align) {
+        std::size_t need = size + align;
+        std::size_t blockSize = std::max(need, head ? head->size * 2 : initialSize);
+        Block* block = static_cast<Block*>(std::malloc(kHeader + blockSize));
+        if (!block) throw std::bad_alloc();
+        heapBlocks().inc();
+        if (head) usedBefore += static_cast<std::size_t>(cursor - (reinterpret_cast<char*>(head) + kHeader));
+        block->next = head;
+        block->size = blockSize;
+        head = block;
+        reserved += blockSize;
+        cursor = reinterpret_cast<char*>(block) + kHeader;
+        limit = cursor + blockSize;
+    }
+
+    void release() {
+        while (head) {
+            Block* next = head->next;
+            std::free(head);
+            head = next;
+        }
+        cursor = limit = nullptr;
+        usedBefore = 0;
+        reserved = 0;
+    }
+
+public:
+    explicit Arena(std::size_t initialSize = 16 * 1024) : initialSize(initialSize) {}
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) {
+        std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~(std::uintptr_t(align) - 1);
+        if (!cursor || p + size > reinterpret_cast<std::uintptr_t>(limit)) {
+            grow(size, align);
+            p = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~(std::uintptr_t(align) - 1);
+        }
+        cursor = reinterpret_cast<char*>(p + size);
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T>
+    T* allocateArray(std::size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copy of text owned by the arena
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) return std::string_view();
+        char* out = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(out, text.data(), text.size());
+        return std::string_view(out, text.size());
+    }
+
+    // Bytes handed out since the last reset
+    std::size_t used() const {
+        return usedBefore + (head ? static_cast<std::size_t>(cursor - (reinterpret_cast<char*>(head) + kHeader)) : 0);
+    }
+
+    std::size_t capacity() const { return reserved; }
+
+    // Forget every allocation; keeps one block sized for what was just used
+    void reset() {
+        std::size_t peak = used();
+        if (head && head->next) {
+            release();
+            std::size_t keep = std::min(std::max(peak + peak / 4, initialSize), kMaxRetained);
+            grow(keep - alignof(std::max_align_t), alignof(std::max_align_t));
+        } else if (head && head->size > kMaxRetained) {
+            release();
+        }
+        if (head) {
+            usedBefore = 0;
+            cursor = reinterpret_cast<char*>(head) + kHeader;
+        }
+    }
+
+    // The calling worker thread's arena
+    static Arena& forThread() {
+        thread_local Arena arena;
+        return arena;
+    }
+
+    // Resets the thread's arena when the outermost scope on the thread ends
+    class Scope {
+    private:
+        Arena& arena;
+
+    public:
+        Scope() : arena(forThread()) { ++arena.depth; }
+        ~Scope() {
+            if (--arena.depth == 0) arena.reset();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        Arena& get() { return arena; }
+    };
+};
+
+// std allocator adaptor, for containers whose lifetime ends with the request
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(arena->allocate(sizeof(T) * count, alignof(T)));
+    }
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
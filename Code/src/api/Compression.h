@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <Poco/DeflatingStream.h>
+#include "../metrics/Metrics.h"
+#include "../models/Enums.h"
+
+enum class ContentEncoding { Identity, Gzip, Deflate };
+
+// Negotiated compression of response bodies.
+//
+// Bodies under the size threshold go out as they are: for a few hundred
+// bytes the deflate header and the CPU cost outweigh what is saved (see the
+// Compression/* benchmarks). Larger ones are compressed in the encoding the
+// client prefers. Buffered bodies get a weak ETag from a hash of their
+// content; the compressed form is kept by ETag and encoding in a small LRU,
+// so a listing that has not changed is compressed once and the copy reused,
+// and a client that already holds it gets 304 Not Modified. Streamed bodies
+// (exports) compress on the fly through stream().
+//
+// Only gzip and deflate are offered: they are what Poco's zlib provides.
+class ResponseCompression {
+private:
+    // What the request being handled on this thread accepts; set by Scope
+    struct Accepted {
+        ContentEncoding encoding = ContentEncoding::Identity;
+        std::string ifNoneMatch;
+        bool conditional = false;  // GET: eligible for ETag and 304
+    };
+
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> bytes;
+    };
+
+    std::atomic<std::size_t> minBytes{1024};
+    std::atomic<int> level{6};
+    std::size_t capacity = 16 << 20;  // bytes of compressed bodies kept
+
+    std::mutex mutex;
+    std::list<Entry> entries;  // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::size_t cached = 0;
+
+    static Accepted& accepted() {
+        thread_local Accepted current;
+        return current;
+    }
+
+    static metrics::CacheStats& cacheStats() {
+        static metrics::CacheStats stats = metrics::cache("compressed_responses");
+        return stats;
+    }
+
+    // Quality the client gives a coding in Accept-Encoding, or -1 if it does not name it
+    static double quality(std::string_view header, std::string_view coding) {
+        double star = -1;
+        std::size_t start = 0;
+        while (start < header.size()) {
+            std::size_t end = header.find(',', start);
+            if (end == std::string_view::npos) end = header.size();
+            std::string_view item = header.substr(start, end - start);
+            start = end + 1;
+
+            std::size_t semicolon = item.find(';');
+            std::string_view name = item.substr(0, semicolon);
+            while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+            while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+            double q = 1;
+            if (semicolon != std::string_view::npos) {
+                std::size_t at = item.find("q=", semicolon);
+                if (at != std::string_view::npos) q = std::strtod(std::string(item.substr(at + 2)).c_str(), nullptr);
+            }
+            if (equalsIgnoreCase(name, coding)) return q;
+            if (name == "*") star = q;
+        }
+        return star;
+    }
+
+public:
+    static ResponseCompression& instance() {
+        static ResponseCompression compression;
+        return compression;
+    }
+
+    // minBytes 0 compresses everything; level is zlib's 1 (fastest) to 9 (smallest)
+    void configure(std::size_t threshold, int compressionLevel, std::size_t cacheBytes) {
+        minBytes.store(threshold, std::memory_order_relaxed);
+        level.store(std::max(1, std::min(9, compressionLevel)), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = cacheBytes;
+        while (cached > capacity && !entries.empty()) {
+            cached -= entries.back().bytes->size();
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+    // Preferred coding in an Accept-Encoding header; gzip wins ties
+    static ContentEncoding negotiate(std::string_view acceptEncoding) {
+        double gzip = quality(acceptEncoding, "gzip");
+        double deflate = quality(acceptEncoding, "deflate");
+        if (gzip > 0 && gzip >= deflate) return ContentEncoding::Gzip;
+        if (deflate > 0) return ContentEncoding::Deflate;
+        return ContentEncoding::Identity;
+    }
+
+    static const char* name(ContentEncoding encoding) {
+        switch (encoding) {
+            case ContentEncoding::Gzip: return "gzip";
+            case ContentEncoding::Deflate: return "deflate";
+            default: return "identity";
+        }
+    }
+
+    // Remembers what the current request accepts, for responses sent while it lives
+    class Scope {
+    public:
+        Scope(std::string_view acceptEncoding, std::string ifNoneMatch, bool conditional) {
+            Accepted& current = accepted();
+            current.encoding = negotiate(acceptEncoding);
+            current.ifNoneMatch = std::move(ifNoneMatch);
+            current.conditional = conditional;
+        }
+        ~Scope() { accepted() = Accepted(); }
+    };
+
+    static ContentEncoding acceptedEncoding() { return accepted().encoding; }
+
+    // Weak validator from the body's content; equal bodies get equal tags in
+    // every process running the same build
+    static std::string etag(std::string_view body) {
+        static const char hex[] = "0123456789abcdef";
+        uint64_t hash = std::hash<std::string_view>()(body);
+        std::string tag = "W/\"0000000000000000\"";
+        for (int i = 0; i < 16; ++i) tag[3 + i] = hex[(hash >> (60 - 4 * i)) & 0xF];
+        return tag;
+    }
+
+    // True if the current request is a GET whose If-None-Match holds tag
+    static bool notModified(const std::string& tag) {
+        const Accepted& current = accepted();
+        if (!current.conditional || current.ifNoneMatch.empty()) return false;
+        return current.ifNoneMatch == "*" || current.ifNoneMatch.find(tag.substr(2)) != std::string::npos;
+    }
+
+    static bool conditional() { return accepted().conditional; }
+
+    bool worthCompressing(std::size_t size) const { return size >= minBytes.load(std::memory_order_relaxed); }
+
+    std::string compress(std::string_view body, ContentEncoding encoding) const {
+        std::ostringstream out;
+        {
+            Poco::DeflatingOutputStream deflate(out, encoding == ContentEncoding::Gzip
+                                                         ? Poco::DeflatingStreamBuf::STREAM_GZIP
+                                                         : Poco::DeflatingStreamBuf::STREAM_ZLIB,
+                                                level.load(std::memory_order_relaxed));
+            deflate.write(body.data(), static_cast<std::streamsize>(body.size()));
+            deflate.close();
+        }
+        return out.str();
+    }
+
+    // Compressed body for tag, compressed at most once while it stays cached
+    std::shared_ptr<const std::string> compressed(const std::string& tag, std::string_view body,
+                                                  ContentEncoding encoding) {
+        std::string key = tag + name(encoding);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = index.find(key);
+            if (found != index.end()) {
+                cacheStats().record(true);
+                entries.splice(entries.begin(), entries, found->second);
+                return found->second->bytes;
+            }
+        }
+        cacheStats().record(false);
+        // Compress outside the lock; two threads may race to fill the same entry
+        auto bytes = std::make_shared<const std::string>(compress(body, encoding));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (bytes->size() > capacity || index.count(key)) return bytes;
+        entries.push_front(Entry{key, bytes});
+        index[key] = entries.begin();
+        cached += bytes->size();
+        while (cached > capacity) {
+            cached -= entries.back().bytes->size();
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+        return bytes;
+    }
+
+    // Compressing view of out for streamed bodies; close() it before out ends
+    std::unique_ptr<Poco::DeflatingOutputStream> stream(std::ostream& out, ContentEncoding encoding) const {
+        return std::make_unique<Poco::DeflatingOutputStream>(
+            out,
+            encoding == ContentEncoding::Gzip ? Poco::DeflatingStreamBuf::STREAM_GZIP
+                                              : Poco::DeflatingStreamBuf::STREAM_ZLIB,
+            level.load(std::memory_order_relaxed));
+    }
+};
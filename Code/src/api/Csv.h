@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+
+namespace csv {
+
+// Splits a byte stream into records without holding more than one chunk and
+// one record in memory: lines for NDJSON, RFC 4180 records for CSV, where a
+// quoted field may span lines. Records are views into the stream's buffer,
+// valid until the next call to next(). Blank lines are skipped, a trailing
+// "\r" is dropped and a leading UTF-8 byte order mark is ignored.
+class RecordStream {
+public:
+    enum Result {
+        Record,     // a record is available
+        End,        // input exhausted
+        TooLong,    // a record exceeded the limit and was skipped
+        Malformed,  // CSV framing lost (unterminated quote, or a record outgrew the limit before it ended)
+    };
+
+private:
+    static constexpr std::size_t kChunk = 64 * 1024;
+
+    std::istream& in;
+    bool quoted;  // CSV: '"' opens and closes quoted fields
+    std::size_t maxRecord;
+    std::vector<char> buffer;
+    std::size_t begin = 0;    // start of the current record
+    std::size_t scanned = 0;  // bytes of the current record already scanned
+    std::size_t end = 0;      // end of data read so far
+    bool inQuotes = false;
+    std::size_t newlinesInRecord = 0;
+    std::size_t line = 1;     // line the current record starts on
+    bool eof = false;
+    bool first = true;
+    bool broken = false;
+    std::size_t reported = 0;
+
+    // Moves the unconsumed tail to the front and reads more; false at end of input
+    bool fill() {
+        if (eof) return false;
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            scanned -= begin;
+            end -= begin;
+            begin = 0;
+        }
+        if (buffer.size() - end < kChunk) buffer.resize(end + kChunk);
+        in.read(buffer.data() + end, static_cast<std::streamsize>(buffer.size() - end));
+        std::size_t got = static_cast<std::size_t>(in.gcount());
+        end += got;
+        if (got == 0) eof = true;
+        return got > 0;
+    }
+
+    // Offset of the newline ending the current record, or end when not yet read
+    std::size_t scan() {
+        const char* data = buffer.data();
+        if (!quoted) {
+            const void* newline = std::memchr(data + scanned, '\n', end - scanned);
+            scanned = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - data) : end;
+            return scanned;
+        }
+        for (; scanned < end; ++scanned) {
+            char c = data[scanned];
+            if (c == '"') {
+                inQuotes = !inQuotes;
+            } else if (c == '\n') {
+                if (!inQuotes) return scanned;
+                ++newlinesInRecord;
+            }
+        }
+        return end;
+    }
+
+    void consume(std::size_t newline) {
+        begin = scanned = newline + 1;
+        line += newlinesInRecord + 1;
+        newlinesInRecord = 0;
+        inQuotes = false;
+    }
+
+public:
+    RecordStream(std::istream& in, bool quoted, std::size_t maxRecord = 1 << 20)
+        : in(in), quoted(quoted), maxRecord(maxRecord) {}
+
+    // Line the record or error last returned by next() started on, from 1
+    std::size_t recordLine() const { return reported; }
+
+    Result next(std::string_view& record) {
+        while (!broken) {
+            std::size_t newline = scan();
+            bool complete = newline < end;
+            if (!complete && end - begin <= maxRecord) {
+                if (fill()) continue;
+                newline = end;  // fill() may have moved the data
+                if (begin == end) return End;
+                if (inQuotes) {
+                    reported = line;
+                    broken = true;
+                    return Malformed;
+                }
+            }
+            if (newline - begin > maxRecord) {
+                reported = line;
+                if (!complete) {
+                    if (quoted) {
+                        broken = true;
+                        return Malformed;
+                    }
+                    // Drop what was read and keep dropping up to the end of the line
+                    do {
+                        begin = scanned = end;
+                    } while (fill() && scan() == end);
+                    newline = scanned;
+                }
+                if (newline < end) {
+                    consume(newline);
+                } else {
+                    begin = scanned = end;
+                }
+                return TooLong;
+            }
+
+            const char* data = buffer.data() + begin;
+            std::size_t size = newline - begin;
+            reported = line;
+            if (newline == end) {
+                begin = scanned = end;
+            } else {
+                consume(newline);
+            }
+            if (first) {
+                first = false;
+                if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) {
+                    data += 3;
+                    size -= 3;
+                }
+            }
+            if (size > 0 && data[size - 1] == '\r') --size;
+            if (size == 0) continue;
+            record = std::string_view(data, size);
+            return Record;
+        }
+        return Malformed;
+    }
+};
+
+// Splits one CSV record into fields. Unquoted fields are views into record;
+// quoted ones with "" escapes are unescaped into the arena. Returns nullptr,
+// or what is wrong with the record.
+inline const char* split(std::string_view record, std::vector<std::string_view>& fields, Arena& arena) {
+    fields.clear();
+    std::size_t i = 0;
+    while (true) {
+        if (i < record.size() && record[i] == '"') {
+            std::size_t start = ++i;
+            bool escaped = false;
+            while (true) {
+                const void* quote = std::memchr(record.data() + i, '"', record.size() - i);
+                if (!quote) return "unterminated quoted field";
+                i = static_cast<std::size_t>(static_cast<const char*>(quote) - record.data());
+                if (i + 1 < record.size() && record[i + 1] == '"') {
+                    escaped = true;
+                    i += 2;
+                    continue;
+                }
+                break;
+            }
+            std::string_view field = record.substr(start, i - start);
+            ++i;  // closing quote
+            if (escaped) {
+                char* out = static_cast<char*>(arena.allocate(field.size(), 1));
+                std::size_t size = 0;
+                for (std::size_t j = 0; j < field.size(); ++j) {
+                    out[size++] = field[j];
+                    if (field[j] == '"') ++j;
+                }
+                field = std::string_view(out, size);
+            }
+            fields.push_back(field);
+            if (i < record.size() && record[i] != ',') return "unexpected text after a quoted field";
+        } else {
+            const void* comma = std::memchr(record.data() + i, ',', record.size() - i);
+            std::size_t stop = comma ? static_cast<std::size_t>(static_cast<const char*>(comma) - record.data())
+                                     : record.size();
+            fields.push_back(record.substr(i, stop - i));
+            i = stop;
+        }
+        if (i >= record.size()) return nullptr;
+        ++i;  // comma
+    }
+}
+
+}  // namespace csv
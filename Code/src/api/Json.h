@@ -0,0 +1,720 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+
+// Lightweight JSON for the API layer.
+//
+// Poco::JSON builds a tree of reference-counted Objects, Arrays and
+// Dynamic::Vars: several heap allocations per value, all freed when the
+// request ends. Here the parse tree lives in the request's Arena: a Value is
+// 16 bytes, containers are contiguous arrays, and strings without escapes
+// point straight into the request body. Responses are written by Writer
+// directly into a reusable buffer without building a tree at all.
+namespace json {
+
+enum class Type : uint8_t { Null, Bool, Int, Double, String, Array, Object };
+
+struct Member;
+
+class Value {
+private:
+    Type kind = Type::Null;
+    uint32_t count = 0;  // string length, item or member count
+    union {
+        bool boolean;
+        int64_t integer;
+        double number;
+        const char* chars;
+        const Value* items;
+        const Member* members;
+    };
+
+    friend class Parser;
+
+public:
+    Value() : integer(0) {}
+
+    static const Value& null() {
+        static const Value value;
+        return value;
+    }
+
+    Type type() const { return kind; }
+    bool isNull() const { return kind == Type::Null; }
+    bool isBool() const { return kind == Type::Bool; }
+    bool isInt() const { return kind == Type::Int; }
+    bool isNumber() const { return kind == Type::Int || kind == Type::Double; }
+    bool isString() const { return kind == Type::String; }
+    bool isArray() const { return kind == Type::Array; }
+    bool isObject() const { return kind == Type::Object; }
+
+    bool asBool(bool fallback = false) const { return kind == Type::Bool ? boolean : fallback; }
+
+    int64_t asInt(int64_t fallback = 0) const {
+        if (kind == Type::Int) return integer;
+        if (kind == Type::Double && std::trunc(number) == number) return static_cast<int64_t>(number);
+        return fallback;
+    }
+
+    double asDouble(double fallback = 0) const {
+        if (kind == Type::Double) return number;
+        if (kind == Type::Int) return static_cast<double>(integer);
+        return fallback;
+    }
+
+    std::string_view asString(std::string_view fallback = std::string_view()) const {
+        return kind == Type::String ? std::string_view(chars, count) : fallback;
+    }
+
+    // Items of an array or members of an object
+    std::size_t size() const { return kind == Type::Array || kind == Type::Object ? count : 0; }
+
+    const Value& operator[](std::size_t index) const {
+        return kind == Type::Array && index < count ? items[index] : null();
+    }
+
+    const Value* begin() const { return kind == Type::Array ? items : nullptr; }
+    const Value* end() const { return kind == Type::Array ? items + count : nullptr; }
+
+    inline const Member* memberBegin() const;
+    inline const Member* memberEnd() const;
+
+    // nullptr if this is not an object or has no such key (last one wins on duplicates)
+    inline const Value* find(std::string_view key) const;
+
+    const Value& operator[](std::string_view key) const {
+        const Value* value = find(key);
+        return value ? *value : null();
+    }
+
+    bool has(std::string_view key) const { return find(key) != nullptr; }
+
+    // Typed lookups for validating request bodies: false when the key is
+    // missing or holds another type, and out is left unchanged
+    bool get(std::string_view key, std::string_view& out) const {
+        const Value* value = find(key);
+        if (!value || !value->isString()) return false;
+        out = value->asString();
+        return true;
+    }
+
+    bool get(std::string_view key, std::string& out) const {
+        std::string_view text;
+        if (!get(key, text)) return false;
+        out.assign(text.data(), text.size());
+        return true;
+    }
+
+    bool get(std::string_view key, int& out) const {
+        const Value* value = find(key);
+        if (!value || !value->isNumber()) return false;
+        int64_t number = value->asInt(INT64_MIN);
+        if (number < INT32_MIN || number > INT32_MAX) return false;
+        out = static_cast<int>(number);
+        return true;
+    }
+
+    bool get(std::string_view key, int64_t& out) const {
+        const Value* value = find(key);
+        if (!value || !value->isNumber()) return false;
+        if (value->isDouble() && std::trunc(value->number) != value->number) return false;
+        out = value->asInt();
+        return true;
+    }
+
+    bool get(std::string_view key, double& out) const {
+        const Value* value = find(key);
+        if (!value || !value->isNumber()) return false;
+        out = value->asDouble();
+        return true;
+    }
+
+    bool get(std::string_view key, bool& out) const {
+        const Value* value = find(key);
+        if (!value || !value->isBool()) return false;
+        out = value->asBool();
+        return true;
+    }
+
+private:
+    bool isDouble() const { return kind == Type::Double; }
+};
+
+struct Member {
+    std::string_view key;
+    Value value;
+};
+
+inline const Member* Value::memberBegin() const {
+    return kind == Type::Object ? members : nullptr;
+}
+
+inline const Member* Value::memberEnd() const {
+    return kind == Type::Object ? members + count : nullptr;
+}
+
+inline const Value* Value::find(std::string_view key) const {
+    if (kind != Type::Object) return nullptr;
+    for (uint32_t i = count; i-- > 0;) {
+        if (members[i].key == key) return &members[i].value;
+    }
+    return nullptr;
+}
+
+namespace detail {
+
+inline int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+inline const char* readHex4(const char*& p, const char* end, uint32_t& code) {
+    if (end - p < 4) return "truncated \\u escape";
+    code = 0;
+    for (int i = 0; i < 4; ++i) {
+        int digit = hexDigit(p[i]);
+        if (digit < 0) return "invalid \\u escape";
+        code = code << 4 | static_cast<uint32_t>(digit);
+    }
+    p += 4;
+    return nullptr;
+}
+
+inline char* putUtf8(char* out, uint32_t code) {
+    if (code < 0x80) {
+        *out++ = static_cast<char>(code);
+    } else if (code < 0x800) {
+        *out++ = static_cast<char>(0xC0 | code >> 6);
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *out++ = static_cast<char>(0xE0 | code >> 12);
+        *out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        *out++ = static_cast<char>(0xF0 | code >> 18);
+        *out++ = static_cast<char>(0x80 | (code >> 12 & 0x3F));
+        *out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+    return out;
+}
+
+// One escape sequence; p is just past the backslash. Writes the decoded
+// bytes at w and returns nullptr, or returns what is wrong with it.
+inline const char* decodeEscape(const char*& p, const char* end, char*& w) {
+    if (p >= end) return "unterminated string";
+    switch (*p++) {
+        case '"': *w++ = '"'; break;
+        case '\\': *w++ = '\\'; break;
+        case '/': *w++ = '/'; break;
+        case 'b': *w++ = '\b'; break;
+        case 'f': *w++ = '\f'; break;
+        case 'n': *w++ = '\n'; break;
+        case 'r': *w++ = '\r'; break;
+        case 't': *w++ = '\t'; break;
+        case 'u': {
+            uint32_t code;
+            if (const char* error = readHex4(p, end, code)) return error;
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                uint32_t low;
+                if (end - p < 2 || p[0] != '\\' || p[1] != 'u') return "unpaired surrogate";
+                p += 2;
+                if (const char* error = readHex4(p, end, low)) return error;
+                if (low < 0xDC00 || low > 0xDFFF) return "unpaired surrogate";
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            } else if (code >= 0xDC00 && code <= 0xDFFF) {
+                return "unpaired surrogate";
+            }
+            w = putUtf8(w, code);
+            break;
+        }
+        default:
+            return "invalid escape";
+    }
+    return nullptr;
+}
+
+struct Number {
+    bool integral = true;
+    int64_t integer = 0;
+    double real = 0;
+};
+
+// RFC 8259 number at p, which is advanced past it. Integers that fit in
+// int64 stay exact; everything else goes through strtod.
+inline const char* scanNumber(const char*& p, const char* end, Number& number) {
+    const char* start = p;
+    bool negative = false;
+    if (p < end && *p == '-') {
+        negative = true;
+        ++p;
+    }
+    if (p >= end || *p < '0' || *p > '9') return "invalid number";
+    if (*p == '0' && p + 1 < end && p[1] >= '0' && p[1] <= '9') return "leading zero in number";
+
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        unsigned digit = static_cast<unsigned>(*p - '0');
+        if (magnitude > (UINT64_MAX - digit) / 10) overflow = true;
+        magnitude = magnitude * 10 + digit;
+        ++p;
+    }
+    bool fractional = false;
+    if (p < end && *p == '.') {
+        fractional = true;
+        ++p;
+        if (p >= end || *p < '0' || *p > '9') return "invalid number";
+        while (p < end && *p >= '0' && *p <= '9') ++p;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        fractional = true;
+        ++p;
+        if (p < end && (*p == '+' || *p == '-')) ++p;
+        if (p >= end || *p < '0' || *p > '9') return "invalid number";
+        while (p < end && *p >= '0' && *p <= '9') ++p;
+    }
+
+    uint64_t limit = negative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX);
+    if (!fractional && !overflow && magnitude <= limit) {
+        number.integral = true;
+        number.integer = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        return nullptr;
+    }
+
+    // strtod needs a terminator; numbers are short, so copy onto the stack
+    char buffer[64];
+    std::size_t length = static_cast<std::size_t>(p - start);
+    if (length >= sizeof(buffer)) return "number too long";
+    std::memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    number.integral = false;
+    number.real = std::strtod(buffer, nullptr);
+    if (!std::isfinite(number.real)) return "number out of range";
+    return nullptr;
+}
+
+}  // namespace detail
+
+// Recursive-descent parser following RFC 8259 strictly: no comments, no
+// trailing commas, no leading zeros, one top-level value. Containers are
+// collected on per-thread scratch stacks and copied into the arena once
+// closed, so the scratch capacity is reused across requests.
+class Parser {
+private:
+    static constexpr int kMaxDepth = 64;
+
+    Arena& arena;
+    const char* begin = nullptr;
+    const char* p = nullptr;
+    const char* end = nullptr;
+    const char* failure = nullptr;
+    const char* failedAt = nullptr;
+    int depth = 0;
+
+    static std::vector<Value>& itemStack() {
+        thread_local std::vector<Value> stack;
+        return stack;
+    }
+
+    static std::vector<Member>& memberStack() {
+        thread_local std::vector<Member> stack;
+        return stack;
+    }
+
+    bool fail(const char* message) {
+        if (!failure) {
+            failure = message;
+            failedAt = p;
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    }
+
+    bool literal(const char* word, std::size_t length) {
+        if (static_cast<std::size_t>(end - p) < length || std::memcmp(p, word, length) != 0) {
+            return fail("invalid literal");
+        }
+        p += length;
+        return true;
+    }
+
+    // p is just past the opening quote
+    bool parseString(std::string_view& out) {
+        const char* start = p;
+        while (p < end && *p != '"' && *p != '\\') {
+            if (static_cast<unsigned char>(*p) < 0x20) return fail("control character in string");
+            ++p;
+        }
+        if (p >= end) return fail("unterminated string");
+        if (*p == '"') {
+            out = std::string_view(start, static_cast<std::size_t>(p - start));
+            ++p;
+            return true;
+        }
+
+        // Find the closing quote first: escapes never lengthen the text, so
+        // the decoded copy fits in the string's own span of the input
+        const char* closing = p;
+        while (closing < end && *closing != '"') closing += *closing == '\\' ? 2 : 1;
+        if (closing >= end) return fail("unterminated string");
+        char* decoded = static_cast<char*>(arena.allocate(static_cast<std::size_t>(closing - start), 1));
+        std::memcpy(decoded, start, static_cast<std::size_t>(p - start));
+        char* w = decoded + (p - start);
+        while (p < closing) {
+            char c = *p++;
+            if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+            if (c != '\\') {
+                *w++ = c;
+                continue;
+            }
+            if (const char* error = detail::decodeEscape(p, closing, w)) return fail(error);
+        }
+        ++p;  // closing quote
+        out = std::string_view(decoded, static_cast<std::size_t>(w - decoded));
+        return true;
+    }
+
+    bool parseNumber(Value& value) {
+        detail::Number number;
+        if (const char* error = detail::scanNumber(p, end, number)) return fail(error);
+        if (number.integral) {
+            value.kind = Type::Int;
+            value.integer = number.integer;
+        } else {
+            value.kind = Type::Double;
+            value.number = number.real;
+        }
+        return true;
+    }
+
+    bool parseValue(Value& value) {
+        skipSpace();
+        if (p >= end) return fail("unexpected end of input");
+        switch (*p) {
+            case '{': return parseObject(value);
+            case '[': return parseArray(value);
+            case '"': {
+                ++p;
+                std::string_view text;
+                if (!parseString(text)) return false;
+                if (text.size() > UINT32_MAX) return fail("string too long");
+                value.kind = Type::String;
+                value.count = static_cast<uint32_t>(text.size());
+                value.chars = text.data();
+                return true;
+            }
+            case 't':
+                value.kind = Type::Bool;
+                value.boolean = true;
+                return literal("true", 4);
+            case 'f':
+                value.kind = Type::Bool;
+                value.boolean = false;
+                return literal("false", 5);
+            case 'n':
+                value.kind = Type::Null;
+                return literal("null", 4);
+            default:
+                return parseNumber(value);
+        }
+    }
+
+    bool parseArray(Value& value) {
+        if (++depth > kMaxDepth) return fail("nesting too deep");
+        ++p;
+        std::vector<Value>& stack = itemStack();
+        std::size_t base = stack.size();
+        skipSpace();
+        if (p < end && *p == ']') {
+            ++p;
+        } else {
+            while (true) {
+                Value item;
+                if (!parseValue(item)) return unwind(stack, base);
+                stack.push_back(item);
+                skipSpace();
+                if (p < end && *p == ',') {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == ']') {
+                    ++p;
+                    break;
+                }
+                fail("expected ',' or ']'");
+                return unwind(stack, base);
+            }
+        }
+        std::size_t size = stack.size() - base;
+        Value* items = arena.allocateArray<Value>(size);
+        std::copy(stack.begin() + static_cast<std::ptrdiff_t>(base), stack.end(), items);
+        stack.resize(base);
+        value.kind = Type::Array;
+        value.count = static_cast<uint32_t>(size);
+        value.items = items;
+        --depth;
+        return true;
+    }
+
+    bool parseObject(Value& value) {
+        if (++depth > kMaxDepth) return fail("nesting too deep");
+        ++p;
+        std::vector<Member>& stack = memberStack();
+        std::size_t base = stack.size();
+        skipSpace();
+        if (p < end && *p == '}') {
+            ++p;
+        } else {
+            while (true) {
+                skipSpace();
+                if (p >= end || *p != '"') {
+                    fail("expected member name");
+                    return unwind(stack, base);
+                }
+                ++p;
+                Member member;
+                if (!parseString(member.key)) return unwind(stack, base);
+                skipSpace();
+                if (p >= end || *p != ':') {
+                    fail("expected ':'");
+                    return unwind(stack, base);
+                }
+                ++p;
+                if (!parseValue(member.value)) return unwind(stack, base);
+                stack.push_back(member);
+                skipSpace();
+                if (p < end && *p == ',') {
+                    ++p;
+                    continue;
+                }
+                if (p < end && *p == '}') {
+                    ++p;
+                    break;
+                }
+                fail("expected ',' or '}'");
+                return unwind(stack, base);
+            }
+        }
+        std::size_t size = stack.size() - base;
+        Member* members = arena.allocateArray<Member>(size);
+        std::copy(stack.begin() + static_cast<std::ptrdiff_t>(base), stack.end(), members);
+        stack.resize(base);
+        value.kind = Type::Object;
+        value.count = static_cast<uint32_t>(size);
+        value.members = members;
+        --depth;
+        return true;
+    }
+
+    template <typename T>
+    static bool unwind(std::vector<T>& stack, std::size_t base) {
+        stack.resize(base);
+        return false;
+    }
+
+public:
+    explicit Parser(Arena& arena) : arena(arena) {}
+
+    // Root of the document, or nullptr with error() set. The tree (and any
+    // string that needed no unescaping) points into text, which must outlive it.
+    const Value* parse(std::string_view text) {
+        begin = p = text.data();
+        end = text.data() + text.size();
+        failure = failedAt = nullptr;
+        depth = 0;
+        Value* root = arena.make<Value>();
+        if (!parseValue(*root)) return nullptr;
+        skipSpace();
+        if (p != end) {
+            fail("unexpected data after the document");
+            return nullptr;
+        }
+        return root;
+    }
+
+    const char* error() const { return failure ? failure : ""; }
+    std::size_t errorOffset() const { return failedAt ? static_cast<std::size_t>(failedAt - begin) : 0; }
+};
+
+// Streaming writer. Commas and nesting are tracked on a small fixed stack,
+// so writing allocates only when the output buffer grows.
+class Writer {
+private:
+    static constexpr int kMaxDepth = 64;
+
+    std::string& out;
+    bool needComma[kMaxDepth + 1] = {};
+    int depth = 0;
+    bool afterKey = false;
+
+    void separate() {
+        if (afterKey) {
+            afterKey = false;
+            return;
+        }
+        if (needComma[depth]) out += ',';
+        needComma[depth] = true;
+    }
+
+    void open(char bracket) {
+        separate();
+        out += bracket;
+        if (depth < kMaxDepth) ++depth;
+        needComma[depth] = false;
+    }
+
+    void close(char bracket) {
+        out += bracket;
+        if (depth > 0) --depth;
+    }
+
+    Writer& integer(unsigned long long magnitude, bool negative) {
+        separate();
+        char buffer[24];
+        char* w = buffer + sizeof(buffer);
+        do {
+            *--w = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        if (negative) *--w = '-';
+        out.append(w, static_cast<std::size_t>(buffer + sizeof(buffer) - w));
+        return *this;
+    }
+
+    void appendEscaped(std::string_view text) {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        std::size_t runStart = 0;
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(text.data() + runStart, i - runStart);
+            runStart = i + 1;
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default: {
+                    char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                    out.append(escaped, sizeof(escaped));
+                }
+            }
+        }
+        out.append(text.data() + runStart, text.size() - runStart);
+        out += '"';
+    }
+
+public:
+    explicit Writer(std::string& out) : out(out) {}
+
+    Writer& beginObject() { open('{'); return *this; }
+    Writer& endObject() { close('}'); return *this; }
+    Writer& beginArray() { open('['); return *this; }
+    Writer& endArray() { close(']'); return *this; }
+
+    Writer& key(std::string_view name) {
+        separate();
+        appendEscaped(name);
+        out += ':';
+        afterKey = true;
+        return *this;
+    }
+
+    Writer& value(std::string_view text) {
+        separate();
+        appendEscaped(text);
+        return *this;
+    }
+    Writer& value(const std::string& text) { return value(std::string_view(text)); }
+    Writer& value(const char* text) { return value(std::string_view(text)); }
+
+    Writer& value(bool flag) {
+        separate();
+        out += flag ? "true" : "false";
+        return *this;
+    }
+
+    Writer& value(long long number) {
+        return integer(number < 0 ? 0 - static_cast<unsigned long long>(number) : static_cast<unsigned long long>(number),
+                       number < 0);
+    }
+    Writer& value(long number) { return value(static_cast<long long>(number)); }
+    Writer& value(int number) { return value(static_cast<long long>(number)); }
+    Writer& value(unsigned long long number) { return integer(number, false); }
+    Writer& value(unsigned long number) { return integer(number, false); }
+    Writer& value(unsigned number) { return integer(number, false); }
+
+    Writer& value(double number) {
+        if (!std::isfinite(number)) return null();
+        separate();
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+        out.append(buffer, static_cast<std::size_t>(length));
+        return *this;
+    }
+
+    Writer& null() {
+        separate();
+        out += "null";
+        return *this;
+    }
+
+    // Re-emit a parsed value
+    Writer& value(const Value& value) {
+        switch (value.type()) {
+            case Type::Null: return null();
+            case Type::Bool: return this->value(value.asBool());
+            case Type::Int: return this->value(value.asInt());
+            case Type::Double: return this->value(value.asDouble());
+            case Type::String: return this->value(value.asString());
+            case Type::Array:
+                beginArray();
+                for (const Value& item : value) this->value(item);
+                return endArray();
+            case Type::Object:
+                beginObject();
+                for (const Member* m = value.memberBegin(); m != value.memberEnd(); ++m) {
+                    key(m->key).value(m->value);
+                }
+                return endObject();
+        }
+        return *this;
+    }
+
+    template <typename T>
+    Writer& field(std::string_view name, const T& fieldValue) {
+        return key(name).value(fieldValue);
+    }
+};
+
+// Per-thread output buffer for responses; keeps its capacity between requests
+inline std::string& responseBuffer() {
+    static constexpr std::size_t kMaxRetained = std::size_t(1) << 20;
+    thread_local std::string buffer;
+    if (buffer.capacity() > kMaxRetained) {
+        std::string().swap(buffer);
+    }
+    buffer.clear();
+    return buffer;
+}
+
+}  // namespace json
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "Arena.h"
+#include "Json.h"
+#include "JsonIndex.h"
+#include "../models/Enums.h"
+#include "../models/Fields.h"
+#include "../models/Timestamp.h"
+
+namespace json {
+
+// Decodes a JSON object straight into a model through its ModelFields, with
+// no intermediate tree: the structural index says where each token starts,
+// member names are matched against the field list expanded at compile time,
+// and each value is converted to the setter's type and handed to it.
+//
+// Validation is strict. The document must be one RFC 8259 object in valid
+// UTF-8; a known field must hold its type (integers in range, enum names the
+// enum knows unless the field is OpenEnum), appear at most once, and every
+// Required field must be present. Unknown members are checked for syntax and
+// skipped. Strings that need unescaping are decoded into the arena.
+class Decoder {
+private:
+    static constexpr int kMaxDepth = 64;
+
+    Arena& arena;
+    simd::Isa isa;
+    StructuralIndex index;
+    const char* text = nullptr;
+    std::size_t cursor = 0;
+    const char* failure = nullptr;
+    std::size_t failedAt = 0;
+    std::string message;  // failures that name a field
+
+    bool fail(const char* reason) {
+        if (!failure) {
+            failure = reason;
+            failedAt = cursor < index.size() ? index.offset(cursor) : index.offset(index.size());
+        }
+        return false;
+    }
+
+    bool failField(const char* reason, std::string_view name) {
+        if (failure) return false;
+        message.assign(reason).append(" '").append(name.data(), name.size()).append("'");
+        return fail(message.c_str());
+    }
+
+    char peek() const { return cursor < index.size() ? text[index.offset(cursor)] : '\0'; }
+
+    bool expect(char c, const char* reason) {
+        if (peek() != c) return fail(reason);
+        ++cursor;
+        return true;
+    }
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+    // Bounds of the token at the cursor: up to where the next one starts
+    const char* tokenBegin() const { return text + index.offset(cursor); }
+    const char* tokenEnd() const { return text + index.offset(cursor + 1); }
+
+    bool string(std::string_view& out) {
+        if (peek() != '"') return fail("expected string");
+        const char* start = tokenBegin() + 1;
+        const char* limit = tokenEnd();
+        // Stage one guarantees the closing quote lies before the next token
+        const char* close = static_cast<const char*>(std::memchr(start, '"', static_cast<std::size_t>(limit - start)));
+        const char* escape = static_cast<const char*>(std::memchr(start, '\\', static_cast<std::size_t>(close - start)));
+        if (!escape) {
+            out = std::string_view(start, static_cast<std::size_t>(close - start));
+            ++cursor;
+            return true;
+        }
+
+        char* decoded = static_cast<char*>(arena.allocate(static_cast<std::size_t>(limit - start), 1));
+        std::memcpy(decoded, start, static_cast<std::size_t>(escape - start));
+        char* w = decoded + (escape - start);
+        const char* p = escape;
+        while (true) {
+            char c = *p++;
+            if (c == '"') break;
+            if (c != '\\') {
+                *w++ = c;
+                continue;
+            }
+            if (const char* error = detail::decodeEscape(p, limit, w)) return fail(error);
+        }
+        out = std::string_view(decoded, static_cast<std::size_t>(w - decoded));
+        ++cursor;
+        return true;
+    }
+
+    bool number(detail::Number& out) {
+        const char* p = tokenBegin();
+        const char* end = tokenEnd();
+        if (const char* error = detail::scanNumber(p, end, out)) return fail(error);
+        if (p != end && !isSpace(*p)) return fail("invalid number");
+        ++cursor;
+        return true;
+    }
+
+    bool literal(std::string_view word) {
+        const char* p = tokenBegin();
+        std::size_t available = static_cast<std::size_t>(tokenEnd() - p);
+        if (available < word.size() || std::memcmp(p, word.data(), word.size()) != 0 ||
+            (available > word.size() && !isSpace(p[word.size()]))) {
+            return fail("invalid literal");
+        }
+        ++cursor;
+        return true;
+    }
+
+    // Validates and steps over the value at the cursor
+    bool skipValue(int depth) {
+        if (depth > kMaxDepth) return fail("nesting too deep");
+        switch (peek()) {
+            case '{':
+                ++cursor;
+                if (peek() == '}') {
+                    ++cursor;
+                    return true;
+                }
+                while (true) {
+                    std::string_view key;
+                    if (peek() != '"') return fail("expected member name");
+                    if (!string(key) || !expect(':', "expected ':'") || !skipValue(depth + 1)) return false;
+                    if (peek() == ',') {
+                        ++cursor;
+                        continue;
+                    }
+                    return expect('}', "expected ',' or '}'");
+                }
+            case '[':
+                ++cursor;
+                if (peek() == ']') {
+                    ++cursor;
+                    return true;
+                }
+                while (true) {
+                    if (!skipValue(depth + 1)) return false;
+                    if (peek() == ',') {
+                        ++cursor;
+                        continue;
+                    }
+                    return expect(']', "expected ',' or ']'");
+                }
+            case '"': {
+                std::string_view ignored;
+                return string(ignored);
+            }
+            case 't': return literal("true");
+            case 'f': return literal("false");
+            case 'n': return literal("null");
+            case '}':
+            case ']':
+            case ',':
+            case ':':
+                return fail("expected value");
+            case '\0':
+                if (cursor >= index.size()) return fail("unexpected end of input");
+                return fail("unexpected character");
+            default: {
+                detail::Number ignored;
+                return number(ignored);
+            }
+        }
+    }
+
+    bool readInteger(int64_t& out, int64_t min, int64_t max) {
+        detail::Number value;
+        if (peek() == '"' || peek() == '{' || peek() == '[' || !number(value)) return false;
+        if (!value.integral) {
+            // Integral doubles such as 3.0 or 1e3 are accepted, as json::Value::get() does
+            if (std::trunc(value.real) != value.real || value.real < -0x1p63 || value.real >= 0x1p63) return false;
+            value.integer = static_cast<int64_t>(value.real);
+        }
+        if (value.integer < min || value.integer > max) return false;
+        out = value.integer;
+        return true;
+    }
+
+    // Converts the value at the cursor for one field and calls its setter
+    template <typename Model, typename Field>
+    bool readField(Model& model, const Field& field) {
+        using T = typename Field::value_type;
+        std::size_t at = cursor;
+        bool ok = false;
+        T value{};
+        if constexpr (std::is_same<T, bool>::value) {
+            char c = peek();
+            ok = (c == 't' && literal("true")) || (c == 'f' && literal("false"));
+            value = c == 't';
+        } else if constexpr (std::is_enum<T>::value) {
+            std::string_view name;
+            if (peek() == '"' && string(name)) {
+                ok = parseEnum(name, value);
+                if (!ok && field.has(fields::OpenEnum)) {
+                    value = EnumTraits<T>::fallback;
+                    ok = true;
+                }
+            }
+        } else if constexpr (std::is_same<T, int64_t>::value) {
+            std::string_view text;
+            if (field.has(fields::Timestamp) && peek() == '"') {
+                ok = string(text) && parseTimestamp(text, value);
+            } else {
+                ok = readInteger(value, INT64_MIN, INT64_MAX);
+            }
+        } else if constexpr (std::is_integral<T>::value) {
+            int64_t wide = 0;
+            ok = readInteger(wide, std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+            value = static_cast<T>(wide);
+        } else if constexpr (std::is_floating_point<T>::value) {
+            detail::Number number;
+            if (peek() != '"' && peek() != '{' && peek() != '[' && this->number(number)) {
+                value = static_cast<T>(number.integral ? static_cast<double>(number.integer) : number.real);
+                ok = true;
+            }
+        } else {
+            static_assert(std::is_same<T, std::string>::value, "unsupported field type");
+            std::string_view text;
+            if (peek() == '"' && string(text)) {
+                value.assign(text.data(), text.size());
+                ok = true;
+            }
+        }
+        if (!ok) {
+            if (failure) return false;
+            cursor = at;
+            return failField("invalid value for field", field.name);
+        }
+        (model.*field.set)(std::move(value));
+        return true;
+    }
+
+    template <typename Model>
+    static constexpr uint64_t requiredFields() {
+        uint64_t mask = 0;
+        forEachField<Model>([&mask](const auto& field, auto i) {
+            if (field.has(fields::Required)) mask |= uint64_t(1) << decltype(i)::value;
+        });
+        return mask;
+    }
+
+public:
+    explicit Decoder(Arena& arena, simd::Isa isa = simd::bestIsa()) : arena(arena), isa(isa) {}
+
+    // Sets the fields present in text on model (others keep their values).
+    // On failure model may be partly filled and error() says why.
+    template <typename Model>
+    bool decode(std::string_view input, Model& model) {
+        static_assert(fieldCount<Model>() <= 64, "seen-field mask holds 64 fields");
+        failure = nullptr;
+        failedAt = 0;
+        cursor = 0;
+        text = input.data();
+        if (!index.build(input, isa)) {
+            failure = index.error();
+            failedAt = index.errorOffset();
+            return false;
+        }
+
+        if (!expect('{', "expected an object")) return false;
+        uint64_t seen = 0;
+        if (peek() == '}') {
+            ++cursor;
+        } else {
+            while (true) {
+                std::string_view key;
+                if (peek() != '"') return fail("expected member name");
+                if (!string(key) || !expect(':', "expected ':'")) return false;
+
+                bool known = false;
+                bool ok = true;
+                forEachField<Model>([&](const auto& field, auto i) {
+                    if (known || key != field.name) return;
+                    known = true;
+                    constexpr uint64_t bit = uint64_t(1) << decltype(i)::value;
+                    if (seen & bit) {
+                        ok = failField("duplicate field", field.name);
+                        return;
+                    }
+                    seen |= bit;
+                    ok = readField(model, field);
+                });
+                if (!known) ok = skipValue(2);  // the object itself is depth 1
+                if (!ok) return false;
+
+                if (peek() == ',') {
+                    ++cursor;
+                    continue;
+                }
+                if (!expect('}', "expected ',' or '}'")) return false;
+                break;
+            }
+        }
+        if (cursor != index.size()) return fail("unexpected data after the document");
+
+        constexpr uint64_t required = requiredFields<Model>();
+        if ((seen & required) != required) {
+            bool reported = false;
+            forEachField<Model>([&](const auto& field, auto i) {
+                if (!reported && field.has(fields::Required) && !(seen & uint64_t(1) << decltype(i)::value)) {
+                    reported = true;
+                    failField("missing field", field.name);
+                }
+            });
+            return false;
+        }
+        return true;
+    }
+
+    const char* error() const { return failure ? failure : ""; }
+    std::size_t errorOffset() const { return failedAt; }
+};
+
+}  // namespace json
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_INDEX_X86 1
+#endif
+
+// Structural index of a JSON document: the offset of every token start,
+// found in one pass that classifies 64 bytes at a time (simdjson's "stage
+// one"). Each block yields bitmasks of quotes, backslashes, operators and
+// whitespace; string interiors are masked out with a prefix XOR over the
+// unescaped quotes, so what remains are the braces, brackets, colons and
+// commas outside strings, the opening quote of each string and the first
+// byte of each number or literal. The same pass rejects raw control
+// characters inside strings and notes whether any byte is non-ASCII, in
+// which case the whole input is checked for valid UTF-8 afterwards.
+//
+// Classification runs on AVX2 or SSE4.2 when the CPU has them (checked once
+// at runtime) and on a lookup table otherwise; the three produce identical
+// indexes. json::Decoder walks the index to parse.
+namespace json {
+namespace simd {
+
+enum class Isa : uint8_t { Scalar, Sse42, Avx2 };
+
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Avx2: return "avx2";
+        case Isa::Sse42: return "sse4.2";
+        default: return "scalar";
+    }
+}
+
+inline bool supported(Isa isa) {
+#ifdef JSON_INDEX_X86
+    if (isa == Isa::Avx2) return __builtin_cpu_supports("avx2");
+    if (isa == Isa::Sse42) return __builtin_cpu_supports("sse4.2");
+#endif
+    return isa == Isa::Scalar;
+}
+
+// Widest instruction set this CPU runs
+inline Isa bestIsa() {
+    static const Isa isa = supported(Isa::Avx2) ? Isa::Avx2 : supported(Isa::Sse42) ? Isa::Sse42 : Isa::Scalar;
+    return isa;
+}
+
+// One bit per byte of a 64-byte block
+struct BlockClasses {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t op = 0;       // { } [ ] : ,
+    uint64_t space = 0;    // space, \t, \n, \r
+    uint64_t control = 0;  // below 0x20
+    uint64_t high = 0;     // 0x80 and above
+};
+
+struct ByteClassTable {
+    // Bit order matches the fields of BlockClasses
+    enum : uint8_t { Quote = 1, Backslash = 2, Op = 4, Space = 8, Control = 16, High = 32 };
+    uint8_t classes[256] = {};
+
+    constexpr ByteClassTable() {
+        for (int c = 0; c < 256; ++c) {
+            uint8_t bits = 0;
+            if (c == '"') bits |= Quote;
+            if (c == '\\') bits |= Backslash;
+            if (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') bits |= Op;
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') bits |= Space;
+            if (c < 0x20) bits |= Control;
+            if (c >= 0x80) bits |= High;
+            classes[c] = bits;
+        }
+    }
+};
+
+// Portable fallback: one table lookup per byte, then each class bit is
+// gathered from eight bytes at a time with a multiply
+struct ScalarClassifier {
+    // Bit 0 of each byte of x, packed into the low byte in order
+    static uint64_t gather(uint64_t x) {
+        return ((x & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+    }
+
+    static void classify(const unsigned char* in, BlockClasses& out) {
+        static constexpr ByteClassTable table;
+        BlockClasses c;
+        for (int i = 0; i < 64; i += 8) {
+            unsigned char classes[8];
+            for (int j = 0; j < 8; ++j) classes[j] = table.classes[in[i + j]];
+            uint64_t packed;
+            std::memcpy(&packed, classes, sizeof(packed));
+            c.quote |= gather(packed) << i;
+            c.backslash |= gather(packed >> 1) << i;
+            c.op |= gather(packed >> 2) << i;
+            c.space |= gather(packed >> 3) << i;
+            c.control |= gather(packed >> 4) << i;
+            c.high |= gather(packed >> 5) << i;
+        }
+        out = c;
+    }
+};
+
+#ifdef JSON_INDEX_X86
+
+// Operators and whitespace are found with two nibble lookups (PSHUFB): a
+// byte is whitespace if it equals the table entry for its low nibble, and an
+// operator if it does after OR 0x20 folds '[' ']' onto '{' '}'. Control
+// bytes that alias an operator this way are never accepted as one, because
+// stage two checks the actual character at each position.
+struct Sse42Classifier {
+    __attribute__((target("sse4.2"))) static uint64_t mask(__m128i bytes) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+    }
+
+    __attribute__((target("sse4.2"))) static void classify(const unsigned char* in, BlockClasses& out) {
+        const __m128i spaceTable = _mm_setr_epi8(' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100,
+                                                 '\r', 100, 100);
+        const __m128i opTable = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i curl = _mm_set1_epi8(0x20);
+        const __m128i lastControl = _mm_set1_epi8(0x1F);
+        BlockClasses c;
+        for (int i = 0; i < 4; ++i) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16 * i));
+            int shift = 16 * i;
+            c.quote |= mask(_mm_cmpeq_epi8(x, quote)) << shift;
+            c.backslash |= mask(_mm_cmpeq_epi8(x, backslash)) << shift;
+            c.space |= mask(_mm_cmpeq_epi8(x, _mm_shuffle_epi8(spaceTable, x))) << shift;
+            c.op |= mask(_mm_cmpeq_epi8(_mm_or_si128(x, curl), _mm_shuffle_epi8(opTable, x))) << shift;
+            c.control |= mask(_mm_cmpeq_epi8(_mm_min_epu8(x, lastControl), x)) << shift;
+            c.high |= mask(x) << shift;
+        }
+        out = c;
+    }
+};
+
+struct Avx2Classifier {
+    __attribute__((target("avx2"))) static uint64_t mask(__m256i bytes) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(bytes));
+    }
+
+    __attribute__((target("avx2"))) static void classify(const unsigned char* in, BlockClasses& out) {
+        const __m256i spaceTable = _mm256_setr_epi8(' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100,
+                                                    '\r', 100, 100, ' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t',
+                                                    '\n', 112, 100, '\r', 100, 100);
+        const __m256i opTable = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0, 0, 0, 0, 0,
+                                                 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i curl = _mm256_set1_epi8(0x20);
+        const __m256i lastControl = _mm256_set1_epi8(0x1F);
+        BlockClasses c;
+        for (int i = 0; i < 2; ++i) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32 * i));
+            int shift = 32 * i;
+            c.quote |= mask(_mm256_cmpeq_epi8(x, quote)) << shift;
+            c.backslash |= mask(_mm256_cmpeq_epi8(x, backslash)) << shift;
+            c.space |= mask(_mm256_cmpeq_epi8(x, _mm256_shuffle_epi8(spaceTable, x))) << shift;
+            c.op |= mask(_mm256_cmpeq_epi8(_mm256_or_si256(x, curl), _mm256_shuffle_epi8(opTable, x))) << shift;
+            c.control |= mask(_mm256_cmpeq_epi8(_mm256_min_epu8(x, lastControl), x)) << shift;
+            c.high |= mask(x) << shift;
+        }
+        out = c;
+    }
+};
+
+#endif
+
+// Bit i set when an odd number of bits at or below i are set
+inline uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+// State carried from one block to the next
+class BlockScanner {
+private:
+    uint64_t inString = 0;    // all ones when the previous block ended inside a string
+    uint64_t inScalar = 0;    // 1 when it ended inside a number or literal
+    uint64_t escapeNext = 0;  // 1 when it ended with a backslash that escapes this block's first byte
+
+    // Bytes preceded by an escaping backslash. Backslashes are rare in API
+    // payloads, so they are resolved one at a time.
+    uint64_t escapedBytes(uint64_t backslash) {
+        uint64_t escaped = escapeNext;
+        backslash &= ~escapeNext;
+        escapeNext = 0;
+        while (backslash) {
+            int i = __builtin_ctzll(backslash);
+            if (i == 63) {
+                escapeNext = 1;
+                break;
+            }
+            escaped |= uint64_t(2) << i;
+            backslash &= ~(uint64_t(3) << i);
+        }
+        return escaped;
+    }
+
+public:
+    static constexpr std::size_t kNone = SIZE_MAX;
+
+    std::size_t controlAt = kNone;  // first raw control byte inside a string
+    uint64_t nonAscii = 0;
+
+    // Token starts in the block at offset base
+    uint64_t next(const BlockClasses& c, std::size_t base) {
+        uint64_t quotes = c.quote & ~escapedBytes(c.backslash);
+        // Opening quotes and string bodies; closing quotes fall outside
+        uint64_t string = prefixXor(quotes) ^ inString;
+        inString = static_cast<uint64_t>(static_cast<int64_t>(string) >> 63);
+
+        if (uint64_t control = c.control & string) {
+            if (controlAt == kNone) controlAt = base + static_cast<std::size_t>(__builtin_ctzll(control));
+        }
+        nonAscii |= c.high;
+
+        uint64_t outside = ~string;
+        uint64_t op = c.op & outside;
+        uint64_t scalar = outside & ~(op | c.space | c.quote);
+        uint64_t scalarStarts = scalar & ~(scalar << 1 | inScalar);
+        inScalar = scalar >> 63;
+        return op | (quotes & string) | scalarStarts;
+    }
+
+    bool endsInString() const { return inString != 0; }
+};
+
+// Strict UTF-8: no overlong forms, surrogates or code points past U+10FFFF
+inline bool validUtf8(const unsigned char* p, std::size_t size) {
+    const unsigned char* end = p + size;
+    while (p < end) {
+        unsigned char c = *p;
+        if (c < 0x80) {
+            ++p;
+            continue;
+        }
+        std::size_t length;
+        uint32_t code;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+            code = c & 0x1F;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            code = c & 0x0F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            code = c & 0x07;
+        } else {
+            return false;
+        }
+        if (static_cast<std::size_t>(end - p) < length) return false;
+        for (std::size_t i = 1; i < length; ++i) {
+            if ((p[i] & 0xC0) != 0x80) return false;
+            code = code << 6 | (p[i] & 0x3F);
+        }
+        if ((length == 3 && (code < 0x800 || (code >= 0xD800 && code <= 0xDFFF))) ||
+            (length == 4 && (code < 0x10000 || code > 0x10FFFF))) {
+            return false;
+        }
+        p += length;
+    }
+    return true;
+}
+
+}  // namespace simd
+
+class StructuralIndex {
+private:
+    // Offsets kept across documents on the thread (4 bytes per input byte at worst)
+    static constexpr std::size_t kMaxRetained = std::size_t(1) << 18;
+
+    const uint32_t* offsets = nullptr;
+    std::size_t tokens = 0;
+    const char* failure = nullptr;
+    std::size_t failedAt = 0;
+
+    static std::vector<uint32_t>& storage() {
+        thread_local std::vector<uint32_t> offsets;
+        return offsets;
+    }
+
+    template <typename Classifier>
+    static std::size_t scan(const unsigned char* text, std::size_t size, uint32_t* out, simd::BlockScanner& scanner) {
+        uint32_t* w = out;
+        auto emit = [&w](uint64_t starts, uint32_t base) {
+            while (starts) {
+                *w++ = base + static_cast<uint32_t>(__builtin_ctzll(starts));
+                starts &= starts - 1;
+            }
+        };
+        simd::BlockClasses classes;
+        std::size_t offset = 0;
+        for (; offset + 64 <= size; offset += 64) {
+            Classifier::classify(text + offset, classes);
+            emit(scanner.next(classes, offset), static_cast<uint32_t>(offset));
+        }
+        if (offset < size) {
+            // Pad the tail with whitespace, which never starts a token
+            unsigned char tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, text + offset, size - offset);
+            Classifier::classify(tail, classes);
+            emit(scanner.next(classes, offset), static_cast<uint32_t>(offset));
+        }
+        return static_cast<std::size_t>(w - out);
+    }
+
+#ifdef JSON_INDEX_X86
+    __attribute__((target("avx2"))) static std::size_t scanAvx2(const unsigned char* text, std::size_t size,
+                                                               uint32_t* out, simd::BlockScanner& scanner) {
+        return scan<simd::Avx2Classifier>(text, size, out, scanner);
+    }
+
+    __attribute__((target("sse4.2"))) static std::size_t scanSse42(const unsigned char* text, std::size_t size,
+                                                                        uint32_t* out, simd::BlockScanner& scanner) {
+        return scan<simd::Sse42Classifier>(text, size, out, scanner);
+    }
+#endif
+
+    bool fail(const char* message, std::size_t offset) {
+        failure = message;
+        failedAt = offset;
+        tokens = 0;
+        return false;
+    }
+
+public:
+    // Indexes text with the given instruction set (falling back to scalar
+    // if the CPU lacks it). The offsets live in per-thread storage and stay
+    // valid until the next build() on the same thread.
+    bool build(std::string_view text, simd::Isa isa = simd::bestIsa()) {
+        failure = nullptr;
+        failedAt = 0;
+        if (text.size() >= UINT32_MAX) return fail("document too large", 0);
+
+        std::vector<uint32_t>& buffer = storage();
+        std::size_t need = text.size() + 1;
+        if (buffer.size() > kMaxRetained && need <= kMaxRetained) std::vector<uint32_t>().swap(buffer);
+        if (buffer.size() < need) buffer.resize(need);
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+        simd::BlockScanner scanner;
+        if (!simd::supported(isa)) isa = simd::Isa::Scalar;
+#ifdef JSON_INDEX_X86
+        if (isa == simd::Isa::Avx2) {
+            tokens = scanAvx2(bytes, text.size(), buffer.data(), scanner);
+        } else if (isa == simd::Isa::Sse42) {
+            tokens = scanSse42(bytes, text.size(), buffer.data(), scanner);
+        } else
+#endif
+        {
+            tokens = scan<simd::ScalarClassifier>(bytes, text.size(), buffer.data(), scanner);
+        }
+        // Sentinel: the token after the last one starts at the end of input
+        buffer[tokens] = static_cast<uint32_t>(text.size());
+        offsets = buffer.data();
+
+        if (scanner.endsInString()) return fail("unterminated string", text.size());
+        if (scanner.controlAt != simd::BlockScanner::kNone) {
+            return fail("control character in string", scanner.controlAt);
+        }
+        if (scanner.nonAscii && !simd::validUtf8(bytes, text.size())) return fail("invalid UTF-8", 0);
+        return true;
+    }
+
+    std::size_t size() const { return tokens; }
+
+    // Offset of token i; offset(size()) is the input length
+    uint32_t offset(std::size_t i) const { return offsets[i]; }
+    const uint32_t* data() const { return offsets; }
+
+    const char* error() const { return failure ? failure : ""; }
+    std::size_t errorOffset() const { return failedAt; }
+};
+
+}  // namespace json
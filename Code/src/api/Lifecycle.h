@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// Tracks requests in flight so shutdown can drain them.
+//
+// Every request holds a Request from the moment the handler factory sees it,
+// through admission and any wait for a scheduler slot, until its handler is
+// destroyed; the factory moves it into the handler it returns. Once draining
+// starts, requests still arriving on kept-alive connections are served as
+// usual but answered with "Connection: close", so clients send their next
+// request to whichever process now owns the listening socket.
+class Lifecycle {
+private:
+    std::atomic<bool> draining{false};
+    std::atomic<int> inFlight{0};
+    std::mutex mutex;
+    std::condition_variable idle;
+
+    Lifecycle() {}
+
+    void finish() {
+        if (inFlight.fetch_sub(1, std::memory_order_acq_rel) == 1 && draining.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.notify_all();
+        }
+    }
+
+public:
+    class Request {
+    private:
+        bool held = true;
+
+    public:
+        Request() {
+            Lifecycle::instance().inFlight.fetch_add(1, std::memory_order_acq_rel);
+        }
+        Request(Request&& other) noexcept : held(other.held) {
+            other.held = false;
+        }
+        Request(const Request&) = delete;
+        Request& operator=(const Request&) = delete;
+        ~Request() {
+            if (held) Lifecycle::instance().finish();
+        }
+    };
+
+    static Lifecycle& instance() {
+        static Lifecycle lifecycle;
+        return lifecycle;
+    }
+
+    bool isDraining() const {
+        return draining.load(std::memory_order_acquire);
+    }
+
+    void beginDrain() {
+        draining.store(true, std::memory_order_release);
+    }
+
+    // Wait for in-flight requests to finish; false if the deadline passed first
+    bool waitIdle(std::chrono::steady_clock::duration deadline) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return idle.wait_for(lock, deadline, [this] {
+            return inFlight.load(std::memory_order_acquire) == 0;
+        });
+    }
+
+    int inFlightRequests() const {
+        return inFlight.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../logging/Logger.h"
+
+// Zero-downtime restarts by handing the listening socket to a new process.
+//
+// A running server listens on a Unix control socket. A new binary started
+// with the same server.handoffSocket connects to it first, receives the
+// listening socket's descriptor (SCM_RIGHTS), starts serving on it and then
+// confirms; only after the confirmation does the old process stop accepting
+// and drain. The listening socket is never closed, so no connection attempt
+// is refused during a deploy. If nobody is listening on the control socket
+// the new process simply binds the port itself.
+//
+// The control connection stays open while the old process drains. Once it
+// has written its sessions and buffered security events it sends FLUSHED,
+// and only then does the new process load that state (awaitFlushed()).
+class ListenerHandoff {
+public:
+    // What a new process got from its predecessor; invalid if there was none
+    struct Inherited {
+        int listenFd = -1;
+        int controlFd = -1;
+
+        bool valid() const { return listenFd >= 0; }
+    };
+
+private:
+    static constexpr const char* kReady = "READY";
+    static constexpr const char* kFlushed = "FLUSHED";
+
+    std::string path;
+    int listenFd;
+    std::function<void()> onHandedOff;
+    int serverFd = -1;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> handedOff{false};
+    std::atomic<int> successorFd{-1};  // control connection of the process we handed off to
+    std::thread acceptor;
+
+    static bool address(const std::string& path, sockaddr_un& addr) {
+        if (path.size() >= sizeof(addr.sun_path)) return false;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+    bool sendListener(int connection) {
+        char payload = 'L';
+        iovec io;
+        io.iov_base = &payload;
+        io.iov_len = 1;
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        std::memset(control, 0, sizeof(control));
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(header), &listenFd, sizeof(int));
+
+        return sendmsg(connection, &message, MSG_NOSIGNAL) == 1;
+    }
+
+    // Wait for the successor to confirm it is serving
+    static bool awaitReady(int connection) {
+        pollfd fd = {connection, POLLIN, 0};
+        if (poll(&fd, 1, 30000) <= 0) return false;
+        char buffer[8] = {};
+        ssize_t size = recv(connection, buffer, sizeof(buffer) - 1, 0);
+        return size > 0 && std::strncmp(buffer, kReady, std::strlen(kReady)) == 0;
+    }
+
+    void run() {
+        while (!stopping.load()) {
+            pollfd fd = {serverFd, POLLIN, 0};
+            if (poll(&fd, 1, 250) <= 0) continue;
+            int connection = accept(serverFd, nullptr, nullptr);
+            if (connection < 0) continue;
+
+            bool done = sendListener(connection) && awaitReady(connection);
+            if (done) {
+                successorFd.store(connection);
+                // The successor now owns the control socket path as well
+                handedOff.store(true);
+                LOG_INFO("Listening socket handed to the new process, draining");
+                onHandedOff();
+                return;
+            }
+            close(connection);
+            LOG_WARN("Listener handoff did not complete, still serving");
+        }
+    }
+
+public:
+    ListenerHandoff(const std::string& path, int listenFd, std::function<void()> onHandedOff)
+        : path(path), listenFd(listenFd), onHandedOff(std::move(onHandedOff)) {}
+
+    ~ListenerHandoff() {
+        stop();
+        // The successor takes a closed connection as "flushed as far as we got"
+        int connection = successorFd.exchange(-1);
+        if (connection >= 0) close(connection);
+    }
+
+    // Ask a running predecessor for its listening socket
+    static Inherited receive(const std::string& path) {
+        Inherited inherited;
+        sockaddr_un addr;
+        if (path.empty() || !address(path, addr)) return inherited;
+
+        int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (connection < 0) return inherited;
+        if (connect(connection, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(connection);
+            return inherited;
+        }
+
+        char payload = 0;
+        iovec io;
+        io.iov_base = &payload;
+        io.iov_len = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (recvmsg(connection, &message, MSG_CMSG_CLOEXEC) != 1) {
+            close(connection);
+            return inherited;
+        }
+        cmsghdr* header = CMSG_FIRSTHDR(&message);
+        if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            close(connection);
+            return inherited;
+        }
+        std::memcpy(&inherited.listenFd, CMSG_DATA(header), sizeof(int));
+        inherited.controlFd = connection;
+        return inherited;
+    }
+
+    // Tell the predecessor we are serving so it can drain
+    static void confirm(Inherited& inherited) {
+        if (inherited.controlFd < 0) return;
+        send(inherited.controlFd, kReady, std::strlen(kReady), MSG_NOSIGNAL);
+    }
+
+    // Wait for the predecessor to finish draining and flush its state; false
+    // if it closed the connection or the deadline passed without saying so
+    static bool awaitFlushed(Inherited& inherited, std::chrono::milliseconds deadline) {
+        if (inherited.controlFd < 0) return true;
+        pollfd fd = {inherited.controlFd, POLLIN, 0};
+        char buffer[16] = {};
+        ssize_t size = 0;
+        if (poll(&fd, 1, static_cast<int>(deadline.count())) > 0) {
+            size = recv(inherited.controlFd, buffer, sizeof(buffer) - 1, 0);
+        }
+        close(inherited.controlFd);
+        inherited.controlFd = -1;
+        return size > 0 && std::strncmp(buffer, kFlushed, std::strlen(kFlushed)) == 0;
+    }
+
+    // Tell the successor our state is written; call after the final flush
+    void flushed() {
+        int connection = successorFd.exchange(-1);
+        if (connection < 0) return;
+        send(connection, kFlushed, std::strlen(kFlushed), MSG_NOSIGNAL);
+        close(connection);
+    }
+
+    // Start offering our listening socket to a successor
+    bool start() {
+        sockaddr_un addr;
+        if (!address(path, addr)) {
+            LOG_ERROR("Handoff socket path too long: " << path);
+            return false;
+        }
+        serverFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (serverFd < 0) return false;
+        unlink(path.c_str());
+        if (bind(serverFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(serverFd, 1) != 0) {
+            LOG_ERROR("Error listening on handoff socket " << path << ": " << std::strerror(errno));
+            close(serverFd);
+            serverFd = -1;
+            return false;
+        }
+        acceptor = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (stopping.exchange(true)) return;
+        if (acceptor.joinable()) acceptor.join();
+        if (serverFd >= 0) {
+            close(serverFd);
+            serverFd = -1;
+            if (!handedOff.load()) unlink(path.c_str());
+        }
+    }
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include "../metrics/Metrics.h"
+
+// Queues a request can wait in, strict-priority ones first
+enum class SchedulingQueue {
+    Emergency = 0,      // /api/emergency/*, may use reserved slots
+    Auth,               // /api/auth/*, may use reserved slots
+    PeopleInCrisis,     // the rest are shared by weight, keyed by the caller's user type
+    GovernmentAgency,
+    ReliefProvider,
+    Volunteer,
+    Admin,
+    Anonymous,
+    Count
+};
+
+inline SchedulingQueue schedulingQueueFor(const std::string& uri, const std::string& userType) {
+    if (uri.compare(0, 15, "/api/emergency/") == 0 || uri == "/api/emergency") return SchedulingQueue::Emergency;
+    if (uri.compare(0, 10, "/api/auth/") == 0 || uri == "/api/auth") return SchedulingQueue::Auth;
+    if (userType == "people_in_crisis") return SchedulingQueue::PeopleInCrisis;
+    if (userType == "government_agency") return SchedulingQueue::GovernmentAgency;
+    if (userType == "relief_provider") return SchedulingQueue::ReliefProvider;
+    if (userType == "volunteer") return SchedulingQueue::Volunteer;
+    if (userType == "admin") return SchedulingQueue::Admin;
+    return SchedulingQueue::Anonymous;
+}
+
+// Priority-aware gate between parsed requests and the handlers.
+//
+// Poco's dispatcher hands connections to threads strictly in arrival order,
+// before a request line has been read, so it cannot tell an emergency
+// protocol trigger from a dashboard listing. The server therefore runs more
+// connection threads than execution slots and every request takes a slot
+// here before its handler runs. Waiting requests sit in per-queue FIFOs:
+// emergency and auth queues are served first and alone may use the reserved
+// slots; the others share the remaining slots by stride scheduling on their
+// weights, so one busy user type cannot starve the rest. A request that cannot
+// get a slot within the wait limit, or finds its queue full, is refused.
+class RequestScheduler {
+public:
+    static constexpr std::size_t kQueues = static_cast<std::size_t>(SchedulingQueue::Count);
+    static constexpr std::size_t kStrictQueues = 2;
+
+private:
+    static constexpr uint64_t kStrideScale = 1 << 20;
+
+    struct Waiter {
+        std::condition_variable ready;
+        bool granted = false;
+    };
+
+    struct Queue {
+        unsigned weight = 1;
+        uint64_t pass = 0;
+        std::size_t running = 0;
+        std::deque<Waiter*> waiting;
+        metrics::Histogram* wait = nullptr;
+        metrics::Histogram* service = nullptr;
+        metrics::Counter* rejectedFull = nullptr;
+        metrics::Counter* rejectedTimeout = nullptr;
+    };
+
+    std::mutex mutex;
+    std::array<Queue, kQueues> queues;
+    std::size_t slots = 16;
+    std::size_t reserved = 4;
+    std::size_t queueCapacity = 64;
+    std::chrono::milliseconds maxWait{5000};
+    std::size_t active = 0;
+    std::size_t activeShared = 0;
+    uint64_t globalPass = 0;
+
+    static const char* queueName(std::size_t index) {
+        static const char* names[kQueues] = {
+            "emergency", "auth", "people_in_crisis", "government_agency",
+            "relief_provider", "volunteer", "admin", "anonymous"};
+        return names[index];
+    }
+
+    RequestScheduler() {
+        static const unsigned weights[kQueues] = {1, 1, 4, 3, 2, 2, 2, 1};
+        metrics::Registry& registry = metrics::Registry::instance();
+        for (std::size_t i = 0; i < kQueues; ++i) {
+            Queue& queue = queues[i];
+            std::string label = metrics::labels({{"queue", queueName(i)}});
+            queue.weight = weights[i];
+            queue.wait = &registry.histogram("scheduler_wait_seconds",
+                "Time a request waited for an execution slot", label);
+            queue.service = &registry.histogram("scheduler_service_seconds",
+                "Time a request held an execution slot", label);
+            queue.rejectedFull = &registry.counter("scheduler_rejected_total",
+                "Requests refused by the scheduler",
+                metrics::labels({{"queue", queueName(i)}, {"reason", "full"}}));
+            queue.rejectedTimeout = &registry.counter("scheduler_rejected_total",
+                "Requests refused by the scheduler",
+                metrics::labels({{"queue", queueName(i)}, {"reason", "timeout"}}));
+            registry.gauge("scheduler_queue_depth", "Requests waiting for an execution slot",
+                [this, i]() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    return static_cast<double>(queues[i].waiting.size());
+                }, label);
+        }
+        registry.gauge("scheduler_active_slots", "Execution slots currently in use",
+            [this]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                return static_cast<double>(active);
+            });
+    }
+
+    static bool strict(std::size_t index) {
+        return index < kStrictQueues;
+    }
+
+    // Caller holds the lock
+    bool canRun(std::size_t index) const {
+        if (active >= slots) return false;
+        return strict(index) || activeShared + reserved < slots;
+    }
+
+    // Caller holds the lock
+    void start(std::size_t index) {
+        Queue& queue = queues[index];
+        ++active;
+        ++queue.running;
+        if (!strict(index)) {
+            ++activeShared;
+            globalPass = queue.pass;
+            queue.pass += kStrideScale / queue.weight;
+        }
+    }
+
+    // Hand free slots to waiters; caller holds the lock
+    void dispatch() {
+        while (active < slots) {
+            std::size_t next = kQueues;
+            for (std::size_t i = 0; i < kStrictQueues && next == kQueues; ++i) {
+                if (!queues[i].waiting.empty()) next = i;
+            }
+            if (next == kQueues && activeShared + reserved < slots) {
+                for (std::size_t i = kStrictQueues; i < kQueues; ++i) {
+                    if (queues[i].waiting.empty()) continue;
+                    if (next == kQueues || queues[i].pass < queues[next].pass) next = i;
+                }
+            }
+            if (next == kQueues) return;
+
+            Waiter* waiter = queues[next].waiting.front();
+            queues[next].waiting.pop_front();
+            start(next);
+            waiter->granted = true;
+            waiter->ready.notify_one();
+        }
+    }
+
+    void release(std::size_t index, std::chrono::steady_clock::duration held) {
+        queues[index].service->record(held);
+        std::lock_guard<std::mutex> lock(mutex);
+        --active;
+        --queues[index].running;
+        if (!strict(index)) --activeShared;
+        dispatch();
+    }
+
+public:
+    // An execution slot; released when destroyed
+    class Slot {
+    private:
+        RequestScheduler* owner = nullptr;
+        std::size_t index = 0;
+        std::chrono::steady_clock::time_point acquired;
+
+    public:
+        Slot() {}
+        Slot(RequestScheduler* owner, std::size_t index)
+            : owner(owner), index(index), acquired(std::chrono::steady_clock::now()) {}
+        Slot(const Slot&) = delete;
+        Slot& operator=(const Slot&) = delete;
+        Slot(Slot&& other) noexcept : owner(other.owner), index(other.index), acquired(other.acquired) {
+            other.owner = nullptr;
+        }
+        Slot& operator=(Slot&& other) noexcept {
+            if (this != &other) {
+                release();
+                owner = other.owner;
+                index = other.index;
+                acquired = other.acquired;
+                other.owner = nullptr;
+            }
+            return *this;
+        }
+        ~Slot() { release(); }
+
+        explicit operator bool() const { return owner != nullptr; }
+
+        void release() {
+            if (owner) owner->release(index, std::chrono::steady_clock::now() - acquired);
+            owner = nullptr;
+        }
+    };
+
+    static RequestScheduler& instance() {
+        static RequestScheduler scheduler;
+        return scheduler;
+    }
+
+    // slots: concurrent handlers; reserved: slots only emergency and auth may use
+    void configure(std::size_t slotCount, std::size_t reservedCount, std::size_t capacity,
+                   std::chrono::milliseconds waitLimit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots = std::max<std::size_t>(1, slotCount);
+        reserved = std::min(reservedCount, slots - 1);
+        queueCapacity = capacity;
+        maxWait = waitLimit;
+        dispatch();
+    }
+
+    // Requests one queue can hold at once: running in a slot or waiting
+    std::size_t capacity() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return slots + queueCapacity;
+    }
+
+    // Wait for an execution slot; an empty slot means the request was refused
+    Slot acquire(SchedulingQueue which) {
+        std::size_t index = static_cast<std::size_t>(which);
+        Queue& queue = queues[index];
+        auto arrived = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        bool ahead = false;
+        for (std::size_t i = 0; i < kQueues && !ahead; ++i) {
+            // Queues that would be served first must drain before this one runs directly
+            ahead = !queues[i].waiting.empty() && (i < kStrictQueues || !strict(index));
+        }
+        if (!ahead && canRun(index)) {
+            if (!strict(index) && queue.pass < globalPass) queue.pass = globalPass;
+            start(index);
+            lock.unlock();
+            queue.wait->record(std::chrono::steady_clock::now() - arrived);
+            return Slot(this, index);
+        }
+
+        if (queue.waiting.size() >= queueCapacity) {
+            lock.unlock();
+            queue.rejectedFull->inc();
+            return Slot();
+        }
+
+        // An idle queue rejoins at the current pass instead of cashing in saved credit
+        if (!strict(index) && queue.waiting.empty() && queue.pass < globalPass) queue.pass = globalPass;
+
+        Waiter waiter;
+        queue.waiting.push_back(&waiter);
+        bool granted = waiter.ready.wait_for(lock, maxWait, [&waiter] { return waiter.granted; });
+        if (!granted) {
+            for (auto it = queue.waiting.begin(); it != queue.waiting.end(); ++it) {
+                if (*it == &waiter) {
+                    queue.waiting.erase(it);
+                    break;
+                }
+            }
+            lock.unlock();
+            queue.rejectedTimeout->inc();
+            return Slot();
+        }
+        lock.unlock();
+        queue.wait->record(std::chrono::steady_clock::now() - arrived);
+        return Slot(this, index);
+    }
+
+    std::chrono::milliseconds waitLimit() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return maxWait;
+    }
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <Poco/Environment.h>
+#include <Poco/Path.h>
+#include <Poco/Util/AbstractConfiguration.h>
+#include <Poco/Util/LayeredConfiguration.h>
+#include <Poco/Util/MapConfiguration.h>
+
+// Server runtime settings.
+//
+// Values come from the application's layered configuration, highest
+// precedence first: command-line options, CMS_* environment variables, a
+// properties file (--config-file, or CrisisManagementSystem.properties next
+// to the binary), then the defaults below.
+//
+//   key                          environment              default
+//   server.port                  CMS_PORT                 8080
+//   server.workers               CMS_WORKERS              hardware concurrency
+//   server.reservedWorkers       CMS_RESERVED_WORKERS     workers / 4 (at least 1)
+//   server.connectionThreads     CMS_CONNECTION_THREADS   workers * 4
+//   server.queueDepth            CMS_QUEUE_DEPTH          100
+//   server.schedulerQueueDepth   CMS_SCHEDULER_QUEUE      64
+//   server.backlog               CMS_BACKLOG              256
+//   server.reusePort             CMS_REUSE_PORT           false
+//   server.keepAlive             CMS_KEEP_ALIVE           true
+//   server.keepAliveTimeout      CMS_KEEP_ALIVE_TIMEOUT   15 (seconds)
+//   server.maxKeepAliveRequests  CMS_MAX_KEEP_ALIVE       100
+//   server.ioTimeout             CMS_IO_TIMEOUT           (unset) default for the three timeouts below
+//   server.headerTimeout         CMS_HEADER_TIMEOUT       10 (seconds to receive the request line and headers)
+//   server.bodyTimeout           CMS_BODY_TIMEOUT         30 (seconds the body may stall between reads)
+//   server.handlerTimeout        CMS_HANDLER_TIMEOUT      30 (seconds of database work per request, except
+//                                                            import/export; also bounds each response write)
+//   server.schedulerWait         CMS_SCHEDULER_WAIT_MS    5000 (milliseconds)
+//   server.threadIdleTime        CMS_THREAD_IDLE_TIME     60 (seconds)
+//   server.processes             CMS_PROCESSES            1 (more forks a supervisor and workers)
+//   server.handoffSocket         CMS_HANDOFF_SOCKET       (disabled) Unix socket for hot restarts
+//   server.drainTimeout          CMS_DRAIN_TIMEOUT        30 (seconds)
+//   server.compressMinBytes      CMS_COMPRESS_MIN_BYTES   1024 (smaller responses go uncompressed)
+//   server.compressLevel         CMS_COMPRESS_LEVEL       6 (zlib, 1 fastest to 9 smallest)
+//   server.compressCacheMB       CMS_COMPRESS_CACHE_MB    16 (precompressed responses kept)
+//   profiler.slowQueryMs         CMS_SLOW_QUERY_MS        100 (statements at least this slow are logged)
+//   profiler.slowQueryLog        CMS_SLOW_QUERY_LOG       slow_queries.log (empty: none)
+//   profiler.slowestKept         CMS_PROFILER_SLOWEST     50 (slowest executions /api/admin/query-profile lists)
+//   audit.directory              CMS_AUDIT_DIR            audit (segment files; relative to the working directory at startup)
+//   hasher.threads               CMS_HASHER_THREADS       2 (password hashing threads)
+//   hasher.queueDepth            CMS_HASHER_QUEUE         4 (hashes waiting; more are refused as busy)
+//   hasher.iterations            CMS_HASHER_ITERATIONS    100000 (PBKDF2 rounds for new hashes)
+//   log.level                    CMS_LOG_LEVEL            info
+//   log.file                     CMS_LOG_FILE             (stderr)
+struct ServerConfig {
+    // Environment layer sits between command-line options (PRIO_APPLICATION) and files (PRIO_DEFAULT)
+    static constexpr int kEnvironmentPriority = -50;
+
+    int port = 8080;
+    int workers = 1;                 // concurrent request handlers (scheduler slots)
+    int reservedWorkers = 1;         // slots only emergency and auth requests may use
+    int connectionThreads = 4;       // Poco threads reading requests and waiting for a slot
+    int queueDepth = 100;            // accepted connections waiting for a connection thread
+    int schedulerQueueDepth = 64;    // parsed requests waiting per scheduler queue
+    int backlog = 256;               // kernel listen queue
+    bool reusePort = false;          // SO_REUSEPORT, for several processes on one port
+    bool keepAlive = true;
+    int keepAliveTimeout = 15;       // idle seconds before a persistent connection is closed
+    int maxKeepAliveRequests = 100;  // requests served on one connection before it is closed
+    int headerTimeout = 10;          // seconds to receive the request line and headers
+    int bodyTimeout = 30;            // seconds between reads of a request body
+    int handlerTimeout = 30;         // seconds of statements per request, and per response write
+    int schedulerWait = 5000;        // milliseconds a request may wait for a handler slot
+    int threadIdleTime = 60;         // seconds before an idle connection thread exits
+    int processes = 1;               // worker processes sharing the port; 1 serves in-process
+    int workerChannel = -1;          // set in worker processes: fd of the supervisor link
+    std::string handoffSocket;       // control socket passing the listener to a restarted process
+    int drainTimeout = 30;           // seconds shutdown waits for in-flight requests
+    int compressMinBytes = 1024;     // response size from which bodies are compressed
+    int compressLevel = 6;
+    int compressCacheMB = 16;
+    int slowQueryMs = 100;
+    std::string slowQueryLog = "slow_queries.log";
+    int slowestKept = 50;
+    std::string auditDirectory = "audit";
+    int hasherThreads = 2;
+    int hasherQueueDepth = 4;
+    int hasherIterations = 100000;
+    std::string logLevel = "info";
+    std::string logFile;
+
+    // Copy the CMS_* variables that are set into a configuration layer
+    static void addEnvironmentLayer(Poco::Util::LayeredConfiguration& config) {
+        static const char* mapping[][2] = {
+            {"server.port", "CMS_PORT"},
+            {"server.workers", "CMS_WORKERS"},
+            {"server.reservedWorkers", "CMS_RESERVED_WORKERS"},
+            {"server.connectionThreads", "CMS_CONNECTION_THREADS"},
+            {"server.queueDepth", "CMS_QUEUE_DEPTH"},
+            {"server.schedulerQueueDepth", "CMS_SCHEDULER_QUEUE"},
+            {"server.backlog", "CMS_BACKLOG"},
+            {"server.reusePort", "CMS_REUSE_PORT"},
+            {"server.keepAlive", "CMS_KEEP_ALIVE"},
+            {"server.keepAliveTimeout", "CMS_KEEP_ALIVE_TIMEOUT"},
+            {"server.maxKeepAliveRequests", "CMS_MAX_KEEP_ALIVE"},
+            {"server.ioTimeout", "CMS_IO_TIMEOUT"},
+            {"server.headerTimeout", "CMS_HEADER_TIMEOUT"},
+            {"server.bodyTimeout", "CMS_BODY_TIMEOUT"},
+            {"server.handlerTimeout", "CMS_HANDLER_TIMEOUT"},
+            {"server.schedulerWait", "CMS_SCHEDULER_WAIT_MS"},
+            {"server.threadIdleTime", "CMS_THREAD_IDLE_TIME"},
+            {"server.processes", "CMS_PROCESSES"},
+            {"server.handoffSocket", "CMS_HANDOFF_SOCKET"},
+            {"server.drainTimeout", "CMS_DRAIN_TIMEOUT"},
+            {"server.compressMinBytes", "CMS_COMPRESS_MIN_BYTES"},
+            {"server.compressLevel", "CMS_COMPRESS_LEVEL"},
+            {"server.compressCacheMB", "CMS_COMPRESS_CACHE_MB"},
+            {"profiler.slowQueryMs", "CMS_SLOW_QUERY_MS"},
+            {"profiler.slowQueryLog", "CMS_SLOW_QUERY_LOG"},
+            {"profiler.slowestKept", "CMS_PROFILER_SLOWEST"},
+            {"audit.directory", "CMS_AUDIT_DIR"},
+            {"hasher.threads", "CMS_HASHER_THREADS"},
+            {"hasher.queueDepth", "CMS_HASHER_QUEUE"},
+            {"hasher.iterations", "CMS_HASHER_ITERATIONS"},
+            {"log.level", "CMS_LOG_LEVEL"},
+            {"log.file", "CMS_LOG_FILE"},
+        };
+        Poco::Util::MapConfiguration::Ptr environment = new Poco::Util::MapConfiguration;
+        for (const auto& entry : mapping) {
+            if (Poco::Environment::has(entry[1])) {
+                environment->setString(entry[0], Poco::Environment::get(entry[1]));
+            }
+        }
+        config.add(environment, kEnvironmentPriority);
+    }
+
+    static ServerConfig load(const Poco::Util::AbstractConfiguration& config) {
+        ServerConfig result;
+        int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+        result.port = config.getInt("server.port", result.port);
+        result.workers = std::max(1, config.getInt("server.workers", cores));
+        result.reservedWorkers = config.getInt("server.reservedWorkers", std::max(1, result.workers / 4));
+        result.reservedWorkers = std::max(0, std::min(result.reservedWorkers, result.workers - 1));
+        result.connectionThreads = std::max(result.workers,
+            config.getInt("server.connectionThreads", result.workers * 4));
+        result.queueDepth = std::max(1, config.getInt("server.queueDepth", result.queueDepth));
+        result.schedulerQueueDepth = std::max(1, config.getInt("server.schedulerQueueDepth", result.schedulerQueueDepth));
+        result.backlog = std::max(1, config.getInt("server.backlog", result.backlog));
+        result.reusePort = config.getBool("server.reusePort", result.reusePort);
+        result.keepAlive = config.getBool("server.keepAlive", result.keepAlive);
+        result.keepAliveTimeout = std::max(1, config.getInt("server.keepAliveTimeout", result.keepAliveTimeout));
+        result.maxKeepAliveRequests = std::max(1, config.getInt("server.maxKeepAliveRequests", result.maxKeepAliveRequests));
+        if (config.has("server.ioTimeout")) {
+            result.headerTimeout = result.bodyTimeout = result.handlerTimeout = config.getInt("server.ioTimeout");
+        }
+        result.headerTimeout = std::max(1, config.getInt("server.headerTimeout", result.headerTimeout));
+        result.bodyTimeout = std::max(1, config.getInt("server.bodyTimeout", result.bodyTimeout));
+        result.handlerTimeout = std::max(1, config.getInt("server.handlerTimeout", result.handlerTimeout));
+        result.schedulerWait = std::max(1, config.getInt("server.schedulerWait", result.schedulerWait));
+        result.threadIdleTime = std::max(1, config.getInt("server.threadIdleTime", result.threadIdleTime));
+        result.processes = std::max(1, config.getInt("server.processes", result.processes));
+        result.workerChannel = config.getInt("server.workerChannel", result.workerChannel);
+        if (result.workerChannel >= 0) {
+            // Workers always share the supervisor's port
+            result.reusePort = true;
+        }
+        result.handoffSocket = config.getString("server.handoffSocket", result.handoffSocket);
+        result.drainTimeout = std::max(0, config.getInt("server.drainTimeout", result.drainTimeout));
+        result.compressMinBytes = std::max(0, config.getInt("server.compressMinBytes", result.compressMinBytes));
+        result.compressLevel = std::max(1, std::min(9, config.getInt("server.compressLevel", result.compressLevel)));
+        result.compressCacheMB = std::max(0, config.getInt("server.compressCacheMB", result.compressCacheMB));
+        result.slowQueryMs = std::max(0, config.getInt("profiler.slowQueryMs", result.slowQueryMs));
+        result.slowQueryLog = config.getString("profiler.slowQueryLog", result.slowQueryLog);
+        if (!result.slowQueryLog.empty()) {
+            result.slowQueryLog = Poco::Path(result.slowQueryLog).absolute().toString();
+        }
+        result.slowestKept = std::max(1, config.getInt("profiler.slowestKept", result.slowestKept));
+        result.auditDirectory = Poco::Path(config.getString("audit.directory", result.auditDirectory))
+            .absolute().toString();
+        result.hasherThreads = std::max(1, config.getInt("hasher.threads", result.hasherThreads));
+        result.hasherQueueDepth = std::max(1, config.getInt("hasher.queueDepth", result.hasherQueueDepth));
+        result.hasherIterations = std::max(1, config.getInt("hasher.iterations", result.hasherIterations));
+        result.logLevel = config.getString("log.level", result.logLevel);
+        result.logFile = config.getString("log.file", result.logFile);
+        return result;
+    }
+
+    // One-line summary for the startup log
+    std::string describe() const {
+        std::ostringstream out;
+        out << "port=" << port
+            << " processes=" << processes
+            << " workers=" << workers
+            << " reserved=" << reservedWorkers
+            << " connectionThreads=" << connectionThreads
+            << " queueDepth=" << queueDepth
+            << " backlog=" << backlog
+            << " reusePort=" << (reusePort ? "true" : "false")
+            << " keepAlive=" << (keepAlive ? "true" : "false")
+            << " keepAliveTimeout=" << keepAliveTimeout << "s"
+            << " maxKeepAliveRequests=" << maxKeepAliveRequests
+            << " headerTimeout=" << headerTimeout << "s"
+            << " bodyTimeout=" << bodyTimeout << "s"
+            << " handlerTimeout=" << handlerTimeout << "s"
+            << " schedulerWait=" << schedulerWait << "ms"
+            << " drainTimeout=" << drainTimeout << "s"
+            << " compressMinBytes=" << compressMinBytes
+            << " compressLevel=" << compressLevel;
+        out << " hasherThreads=" << hasherThreads << " hasherQueueDepth=" << hasherQueueDepth;
+        out << " slowQueryMs=" << slowQueryMs;
+        if (!slowQueryLog.empty()) out << " slowQueryLog=" << slowQueryLog;
+        out << " auditDirectory=" << auditDirectory;
+        if (!handoffSocket.empty()) out << " handoffSocket=" << handoffSocket;
+        return out.str();
+    }
+};
@@ -0,0 +1,116 @@
+// Login throughput benchmark for the password hashing pool.
+//
+// Closed-loop clients (standing in for HTTP worker threads) verify a password
+// against a stored PBKDF2 hash through PasswordHasher::verify, so the numbers
+// include queueing and fast rejection, not just raw hash cost. Reports
+// accepted logins/sec, rejections/sec and latency of the accepted logins.
+//
+// Usage:
+//   cms_hashbench [--iterations=100000] [--workers=2] [--queue=4]
+//                 [--clients=16] [--duration=10]
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../security/PasswordHasher.h"
+#include "LatencyHistogram.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    unsigned iterations = 100000;
+    std::size_t workers = 2;
+    std::size_t queue = 4;
+    int clients = 16;
+    double duration = 10;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find("--iterations=") == 0) options.iterations = static_cast<unsigned>(std::stoul(arg.substr(13)));
+        else if (arg.find("--workers=") == 0) options.workers = std::stoul(arg.substr(10));
+        else if (arg.find("--queue=") == 0) options.queue = std::stoul(arg.substr(8));
+        else if (arg.find("--clients=") == 0) options.clients = std::stoi(arg.substr(10));
+        else if (arg.find("--duration=") == 0) options.duration = std::stod(arg.substr(11));
+        else return false;
+    }
+    return options.clients > 0 && options.duration > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: cms_hashbench [--iterations=N] [--workers=N] [--queue=N] [--clients=N] [--duration=S]"
+                  << std::endl;
+        return 1;
+    }
+
+    PasswordHasher& hasher = PasswordHasher::instance();
+    hasher.configure(options.workers, options.queue, options.iterations);
+
+    const std::string password = "correct horse battery staple";
+    auto hashStart = Clock::now();
+    const std::string stored = hasher.hashNow(password);
+    double hashMillis = std::chrono::duration<double, std::milli>(Clock::now() - hashStart).count();
+
+    std::atomic<bool> running(true);
+    std::atomic<uint64_t> accepted(0);
+    std::atomic<uint64_t> rejected(0);
+    std::vector<LatencyHistogram> histograms(options.clients);
+    std::vector<std::thread> clients;
+
+    auto start = Clock::now();
+    for (int c = 0; c < options.clients; ++c) {
+        clients.emplace_back([&, c] {
+            while (running.load(std::memory_order_relaxed)) {
+                auto begin = Clock::now();
+                PasswordCheck check = hasher.verify(password, stored);
+                auto elapsed = Clock::now() - begin;
+                if (check.status == HashStatus::Busy) {
+                    rejected.fetch_add(1, std::memory_order_relaxed);
+                    // A rejected client backs off briefly, like a 503 with Retry-After would
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                accepted.fetch_add(1, std::memory_order_relaxed);
+                histograms[c].record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+    running.store(false);
+    for (auto& client : clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LatencyHistogram merged;
+    for (const auto& histogram : histograms) {
+        merged.merge(histogram);
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "iterations=" << options.iterations
+              << " workers=" << options.workers
+              << " queue=" << options.queue
+              << " clients=" << options.clients << "\n"
+              << "single hash:      " << hashMillis << " ms\n"
+              << "logins/sec:       " << accepted.load() / seconds << "\n"
+              << "rejections/sec:   " << rejected.load() / seconds << "\n"
+              << "latency p50:      " << merged.percentile(0.50) / 1000.0 << " ms\n"
+              << "latency p99:      " << merged.percentile(0.99) / 1000.0 << " ms\n"
+              << "latency max:      " << merged.max() / 1000.0 << " ms\n";
+    return 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+// Log-linear latency histogram (HDR-style): values below 2^SubBits are exact,
+// above that each power of two is split into 2^SubBits buckets, so recorded
+// values keep roughly 3% relative precision over the whole range.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kBucketCount = (64 - kSubBits + 1) * kSubBuckets;
+
+private:
+    std::array<uint64_t, kBucketCount> counts{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t maxValue = 0;
+
+public:
+    static int bucketFor(uint64_t value) {
+        if (value < static_cast<uint64_t>(kSubBuckets)) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - kSubBits;
+        return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+    }
+
+    // Highest value that falls into the given bucket
+    static uint64_t bucketUpperBound(int index) {
+        if (index < kSubBuckets) {
+            return static_cast<uint64_t>(index);
+        }
+        int shift = index / kSubBuckets - 1;
+        uint64_t sub = static_cast<uint64_t>(index % kSubBuckets + kSubBuckets);
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void record(uint64_t value) {
+        ++counts[bucketFor(value)];
+        ++total;
+        sum += value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < kBucketCount; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    // Value at the given quantile (0.0 - 1.0), reported as the bucket's upper bound
+    uint64_t percentile(double quantile) const {
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(quantile * total + 0.5);
+        if (rank == 0) rank = 1;
+        if (rank > total) rank = total;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t upper = bucketUpperBound(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    // Non-empty buckets as (upper bound, count) pairs
+    std::vector<std::pair<uint64_t, uint64_t>> buckets() const {
+        std::vector<std::pair<uint64_t, uint64_t>> result;
+        for (int i = 0; i < kBucketCount; ++i) {
+            if (counts[i] != 0) {
+                result.emplace_back(bucketUpperBound(i), counts[i]);
+            }
+        }
+        return result;
+    }
+};
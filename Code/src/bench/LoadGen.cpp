@@ -0,0 +1,454 @@
+// Open-loop load generator for the REST API.
+//
+// Drives the real ApiServer either in-process (bound to an ephemeral loopback
+// port) or over the network against a running server, with a configurable mix
+// of endpoints. Requests are scheduled at fixed intended start times derived
+// from the target arrival rate; latency is measured from the intended start so
+// queueing inside the server is not hidden (no coordinated omission).
+//
+// Usage:
+//   cms_loadgen [--host=127.0.0.1] [--port=8080] [--in-process]
+//               [--rate=200] [--duration=30] [--connections=32]
+//               [--arrival=uniform|poisson] [--seed-users=50]
+//               [--mix=signup:1,login:4,help_create:2,help_list:4,volunteer_list:3,emergency_level:2,emergency_protocol:1]
+//               [--out=results.json]
+
+#include <Poco/Net/HTTPClientSession.h>
+#include <Poco/Net/HTTPRequest.h>
+#include <Poco/Net/HTTPResponse.h>
+#include <Poco/Net/SocketAddress.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Array.h>
+#include <Poco/JSON/Parser.h>
+#include <Poco/JSON/Stringifier.h>
+#include <Poco/Process.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../api/ApiServer.h"
+#include "LatencyHistogram.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum class Operation {
+    Signup,
+    Login,
+    HelpCreate,
+    HelpList,
+    VolunteerList,
+    EmergencyLevel,
+    EmergencyProtocol
+};
+
+struct OperationInfo {
+    Operation op;
+    const char* name;
+};
+
+const OperationInfo kOperations[] = {
+    {Operation::Signup, "signup"},
+    {Operation::Login, "login"},
+    {Operation::HelpCreate, "help_create"},
+    {Operation::HelpList, "help_list"},
+    {Operation::VolunteerList, "volunteer_list"},
+    {Operation::EmergencyLevel, "emergency_level"},
+    {Operation::EmergencyProtocol, "emergency_protocol"},
+};
+constexpr int kOperationCount = sizeof(kOperations) / sizeof(kOperations[0]);
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    bool inProcess = false;
+    double rate = 200.0;
+    int duration = 30;
+    int connections = 32;
+    bool poisson = false;
+    int seedUsers = 50;
+    std::string mix = "signup:1,login:4,help_create:2,help_list:4,volunteer_list:3,emergency_level:2,emergency_protocol:1";
+    std::string out;
+};
+
+struct SeedUser {
+    std::string username;
+    std::string password;
+    int id = 0;
+};
+
+// Per-worker results; merged once the run finishes
+struct WorkerStats {
+    LatencyHistogram histograms[kOperationCount];
+    uint64_t errors[kOperationCount] = {};
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string key = arg;
+        std::string value;
+        std::size_t eq = arg.find('=');
+        if (eq != std::string::npos) {
+            key = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+        }
+
+        if (key == "--host") options.host = value;
+        else if (key == "--port") options.port = std::stoi(value);
+        else if (key == "--in-process") options.inProcess = true;
+        else if (key == "--rate") options.rate = std::stod(value);
+        else if (key == "--duration") options.duration = std::stoi(value);
+        else if (key == "--connections") options.connections = std::stoi(value);
+        else if (key == "--arrival") options.poisson = (value == "poisson");
+        else if (key == "--seed-users") options.seedUsers = std::stoi(value);
+        else if (key == "--mix") options.mix = value;
+        else if (key == "--out") options.out = value;
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return options.rate > 0 && options.duration > 0 && options.connections > 0;
+}
+
+// Parse "name:weight,name:weight" into per-operation weights
+bool parseMix(const std::string& mix, std::vector<double>& weights) {
+    weights.assign(kOperationCount, 0.0);
+    std::istringstream in(mix);
+    std::string entry;
+    while (std::getline(in, entry, ',')) {
+        std::size_t colon = entry.find(':');
+        std::string name = entry.substr(0, colon);
+        double weight = colon == std::string::npos ? 1.0 : std::stod(entry.substr(colon + 1));
+        bool found = false;
+        for (int i = 0; i < kOperationCount; ++i) {
+            if (name == kOperations[i].name) {
+                weights[i] = weight;
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "Unknown operation in mix: " << name << std::endl;
+            return false;
+        }
+    }
+    double total = 0;
+    for (double w : weights) total += w;
+    return total > 0;
+}
+
+// Send one request and return the HTTP status (0 on transport failure)
+int sendRequest(HTTPClientSession& session, const std::string& method, const std::string& uri,
+                const std::string& body, std::string* responseBody = nullptr) {
+    try {
+        HTTPRequest request(method, uri, HTTPMessage::HTTP_1_1);
+        request.setKeepAlive(true);
+        if (!body.empty()) {
+            request.setContentType("application/json");
+            request.setContentLength(static_cast<std::streamsize>(body.size()));
+        }
+        std::ostream& os = session.sendRequest(request);
+        os << body;
+
+        HTTPResponse response;
+        std::istream& is = session.receiveResponse(response);
+        std::string payload((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+        if (responseBody) {
+            *responseBody = payload;
+        }
+        return static_cast<int>(response.getStatus());
+    } catch (const std::exception& e) {
+        session.reset();
+        return 0;
+    }
+}
+
+std::string toJsonString(const Object& object) {
+    std::ostringstream oss;
+    Poco::JSON::Stringifier::stringify(object, oss);
+    return oss.str();
+}
+
+// Create the accounts used by login and help_create, and look up their ids
+std::vector<SeedUser> seedUsers(const Options& options, const std::string& runTag) {
+    std::vector<SeedUser> users;
+    HTTPClientSession session(options.host, static_cast<unsigned short>(options.port));
+    session.setKeepAlive(true);
+
+    for (int i = 0; i < options.seedUsers; ++i) {
+        SeedUser user;
+        user.username = "loadgen_seed_" + runTag + "_" + std::to_string(i);
+        user.password = "loadgen";
+
+        Object signup;
+        signup.set("name", "Load Seed " + std::to_string(i));
+        signup.set("location", "Zone " + std::to_string(i % 10));
+        signup.set("phoneNo", "555-0100");
+        signup.set("username", user.username);
+        signup.set("password", user.password);
+        sendRequest(session, HTTPRequest::HTTP_POST, "/api/people-in-crisis/signup", toJsonString(signup));
+
+        Object login;
+        login.set("username", user.username);
+        login.set("password", user.password);
+        login.set("userType", "people_in_crisis");
+        std::string body;
+        if (sendRequest(session, HTTPRequest::HTTP_POST, "/api/auth/login", toJsonString(login), &body) == 200) {
+            try {
+                Poco::JSON::Parser parser;
+                Object::Ptr result = parser.parse(body).extract<Object::Ptr>();
+                if (result->has("userId")) {
+                    user.id = result->getValue<int>("userId");
+                }
+            } catch (const std::exception&) {}
+        }
+        if (user.id != 0) {
+            users.push_back(user);
+        }
+    }
+    return users;
+}
+
+class Worker {
+private:
+    const Options& options;
+    const std::vector<double>& cumulativeWeights;
+    const std::vector<Clock::duration>& schedule;
+    const std::vector<SeedUser>& users;
+    std::atomic<std::size_t>& nextSlot;
+    Clock::time_point start;
+    std::string runTag;
+    int workerId;
+    WorkerStats& stats;
+
+    Operation pick(std::mt19937_64& rng) {
+        std::uniform_real_distribution<double> dist(0.0, cumulativeWeights.back());
+        double r = dist(rng);
+        for (int i = 0; i < kOperationCount; ++i) {
+            if (r < cumulativeWeights[i]) return kOperations[i].op;
+        }
+        return kOperations[kOperationCount - 1].op;
+    }
+
+    int execute(HTTPClientSession& session, Operation op, std::mt19937_64& rng, uint64_t sequence) {
+        const SeedUser* user = users.empty() ? nullptr : &users[rng() % users.size()];
+        switch (op) {
+            case Operation::Signup: {
+                Object signup;
+                std::string username = "loadgen_" + runTag + "_" + std::to_string(workerId) + "_" + std::to_string(sequence);
+                signup.set("name", "Load User");
+                signup.set("location", "Zone " + std::to_string(sequence % 10));
+                signup.set("phoneNo", "555-0199");
+                signup.set("username", username);
+                signup.set("password", "loadgen");
+                return sendRequest(session, HTTPRequest::HTTP_POST, "/api/people-in-crisis/signup", toJsonString(signup));
+            }
+            case Operation::Login: {
+                if (!user) return 0;
+                Object login;
+                login.set("username", user->username);
+                login.set("password", user->password);
+                login.set("userType", "people_in_crisis");
+                return sendRequest(session, HTTPRequest::HTTP_POST, "/api/auth/login", toJsonString(login));
+            }
+            case Operation::HelpCreate: {
+                if (!user) return 0;
+                Object help;
+                help.set("requesterId", user->id);
+                help.set("type", "Food");
+                help.set("description", "Load generated request");
+                help.set("location", "Zone " + std::to_string(sequence % 10));
+                help.set("urgency", static_cast<int>(sequence % 10) + 1);
+                return sendRequest(session, HTTPRequest::HTTP_POST, "/api/help-requests", toJsonString(help));
+            }
+            case Operation::HelpList:
+                return sendRequest(session, HTTPRequest::HTTP_GET, "/api/help-requests", "");
+            case Operation::VolunteerList:
+                return sendRequest(session, HTTPRequest::HTTP_GET, "/api/volunteers", "");
+            case Operation::EmergencyLevel:
+                return sendRequest(session, HTTPRequest::HTTP_GET, "/api/emergency/level", "");
+            case Operation::EmergencyProtocol: {
+                Object protocol;
+                protocol.set("level", "high");
+                protocol.set("description", "Load generated protocol");
+                return sendRequest(session, HTTPRequest::HTTP_POST, "/api/emergency/protocol", toJsonString(protocol));
+            }
+        }
+        return 0;
+    }
+
+public:
+    Worker(const Options& options, const std::vector<double>& cumulativeWeights,
+           const std::vector<Clock::duration>& schedule, const std::vector<SeedUser>& users,
+           std::atomic<std::size_t>& nextSlot, Clock::time_point start,
+           const std::string& runTag, int workerId, WorkerStats& stats)
+        : options(options), cumulativeWeights(cumulativeWeights), schedule(schedule), users(users),
+          nextSlot(nextSlot), start(start), runTag(runTag), workerId(workerId), stats(stats) {}
+
+    void operator()() {
+        HTTPClientSession session(options.host, static_cast<unsigned short>(options.port));
+        session.setKeepAlive(true);
+        std::mt19937_64 rng(0x9E3779B97F4A7C15ULL * (workerId + 1));
+
+        while (true) {
+            std::size_t slot = nextSlot.fetch_add(1);
+            if (slot >= schedule.size()) break;
+
+            Clock::time_point intended = start + schedule[slot];
+            std::this_thread::sleep_until(intended);
+
+            Operation op = pick(rng);
+            int status = execute(session, op, rng, slot);
+            auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - intended);
+
+            int index = static_cast<int>(op);
+            stats.histograms[index].record(static_cast<uint64_t>(latency.count()));
+            if (status < 200 || status >= 400) {
+                ++stats.errors[index];
+            }
+        }
+    }
+};
+
+Object::Ptr summarize(const LatencyHistogram& histogram, uint64_t errors, double elapsedSeconds) {
+    Object::Ptr summary = new Object();
+    summary->set("count", histogram.count());
+    summary->set("errors", errors);
+    summary->set("throughput_rps", elapsedSeconds > 0 ? histogram.count() / elapsedSeconds : 0.0);
+    summary->set("mean_us", histogram.mean());
+    summary->set("p50_us", histogram.percentile(0.50));
+    summary->set("p95_us", histogram.percentile(0.95));
+    summary->set("p99_us", histogram.percentile(0.99));
+    summary->set("p999_us", histogram.percentile(0.999));
+    summary->set("max_us", histogram.max());
+
+    Poco::JSON::Array::Ptr buckets = new Poco::JSON::Array();
+    for (const auto& bucket : histogram.buckets()) {
+        Poco::JSON::Array::Ptr pair = new Poco::JSON::Array();
+        pair->add(bucket.first);
+        pair->add(bucket.second);
+        buckets->add(pair);
+    }
+    summary->set("histogram_us", buckets);
+    return summary;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<double> weights;
+    if (!parseOptions(argc, argv, options) || !parseMix(options.mix, weights)) {
+        std::cerr << "Usage: cms_loadgen [--host=H] [--port=P] [--in-process] [--rate=R] [--duration=S] "
+                  << "[--connections=N] [--arrival=uniform|poisson] [--seed-users=N] [--mix=op:w,...] [--out=FILE]"
+                  << std::endl;
+        return 1;
+    }
+
+    // In-process mode: serve the real handler factory on an ephemeral loopback port
+    std::unique_ptr<HTTPServer> server;
+    if (options.inProcess) {
+        HTTPServerParams* params = new HTTPServerParams;
+        params->setMaxQueued(100);
+        params->setMaxThreads(16);
+        ServerSocket socket(SocketAddress("127.0.0.1", 0));
+        server.reset(new HTTPServer(new ApiRequestHandlerFactory(), socket, params));
+        server->start();
+        options.host = "127.0.0.1";
+        options.port = socket.address().port();
+    }
+
+    std::string runTag = std::to_string(Poco::Process::id()) + "_" +
+        std::to_string(std::chrono::system_clock::now().time_since_epoch().count() % 1000000);
+    std::vector<SeedUser> users = seedUsers(options, runTag);
+    if (users.empty() && (weights[1] > 0 || weights[2] > 0)) {
+        std::cerr << "Warning: no seed users available, login/help_create will be counted as errors" << std::endl;
+    }
+
+    std::vector<double> cumulativeWeights(kOperationCount);
+    double running = 0;
+    for (int i = 0; i < kOperationCount; ++i) {
+        running += weights[i];
+        cumulativeWeights[i] = running;
+    }
+
+    // Intended start offsets for every request in the run
+    std::size_t totalRequests = static_cast<std::size_t>(options.rate * options.duration);
+    std::vector<Clock::duration> schedule(totalRequests);
+    std::mt19937_64 scheduleRng(42);
+    std::exponential_distribution<double> gaps(options.rate);
+    double offset = 0;
+    for (std::size_t i = 0; i < totalRequests; ++i) {
+        schedule[i] = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(offset));
+        offset += options.poisson ? gaps(scheduleRng) : 1.0 / options.rate;
+    }
+
+    std::vector<WorkerStats> stats(options.connections);
+    std::atomic<std::size_t> nextSlot(0);
+    Clock::time_point start = Clock::now() + std::chrono::milliseconds(100);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back(Worker(options, cumulativeWeights, schedule, users, nextSlot, start, runTag, i, stats[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (server) {
+        server->stop();
+    }
+
+    // Merge per-worker results
+    LatencyHistogram overall;
+    uint64_t overallErrors = 0;
+    Object::Ptr endpoints = new Object();
+    for (int i = 0; i < kOperationCount; ++i) {
+        LatencyHistogram merged;
+        uint64_t errors = 0;
+        for (const auto& worker : stats) {
+            merged.merge(worker.histograms[i]);
+            errors += worker.errors[i];
+        }
+        if (merged.count() == 0) continue;
+        overall.merge(merged);
+        overallErrors += errors;
+        endpoints->set(kOperations[i].name, summarize(merged, errors, elapsed));
+    }
+
+    Object result;
+    Object::Ptr config = new Object();
+    config->set("target", options.host + ":" + std::to_string(options.port));
+    config->set("in_process", options.inProcess);
+    config->set("rate", options.rate);
+    config->set("duration_s", options.duration);
+    config->set("connections", options.connections);
+    config->set("arrival", options.poisson ? "poisson" : "uniform");
+    config->set("mix", options.mix);
+    result.set("config", config);
+    result.set("elapsed_s", elapsed);
+    result.set("scheduled", static_cast<uint64_t>(totalRequests));
+    result.set("overall", summarize(overall, overallErrors, elapsed));
+    result.set("endpoints", endpoints);
+
+    if (options.out.empty()) {
+        Poco::JSON::Stringifier::stringify(result, std::cout, 2);
+        std::cout << std::endl;
+    } else {
+        std::ofstream file(options.out);
+        Poco::JSON::Stringifier::stringify(result, file, 2);
+        file << std::endl;
+    }
+    return 0;
+}
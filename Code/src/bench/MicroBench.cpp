@@ -0,0 +1,569 @@
+// Microbenchmarks for model serialization and persistence paths.
+//
+// Runs against an in-memory SQLite database so save()/findById() measure the
+// model and Poco::Data overhead rather than disk I/O.
+//
+// Usage:
+//   cms_microbench [--filter=substring] [--min-time=0.2] [--json]
+
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "../api/ApiServer.h"
+#include "MicroBench.h"
+
+// Count every heap allocation made by the process
+void* operator new(std::size_t size) {
+    microbench::allocationCount().fetch_add(1, std::memory_order_relaxed);
+    microbench::allocatedBytes().fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+using microbench::State;
+using microbench::doNotOptimize;
+
+namespace {
+
+HelpRequest sampleHelpRequest(int requesterId) {
+    HelpRequest request;
+    request.setRequesterId(requesterId);
+    request.setType(HelpType::Medical);
+    request.setDescription("Need insulin and clean water for two adults, road access blocked");
+    request.setLocation("Sector 7, North Bank");
+    request.setUrgency(8);
+    request.setStatus(RequestStatus::Pending);
+    request.setTimestamp(1714558500000);  // 2024-05-01 10:15:00 UTC
+    return request;
+}
+
+Object::Ptr samplePersonJson(const std::string& username) {
+    Object::Ptr json = new Object();
+    json->set("name", "Asha Rao");
+    json->set("location", "Sector 7, North Bank");
+    json->set("phoneNo", "+91-9000000000");
+    json->set("description", "Family of four, ground floor flooded");
+    json->set("username", username);
+    json->set("password", "secret");
+    return json;
+}
+
+int seedPerson(const std::string& username) {
+    PeopleInCrisis person = PeopleInCrisis::fromJSON(samplePersonJson(username));
+    person.save();
+    return person.getId();
+}
+
+// Volunteer with the given number of rows in tasks assigned to it
+Volunteer seedVolunteer(const std::string& username, int taskCount) {
+    Volunteer volunteer;
+    volunteer.setName("Ravi Kumar");
+    volunteer.setLocation("Sector 7");
+    volunteer.setUsername(username);
+    volunteer.setPassword("secret");
+    volunteer.setOrgType(OrgType::NGO);
+    volunteer.save();
+
+    Session& session = DatabaseManager::getInstance()->getSession();
+    int volunteerId = volunteer.getUserID();
+    int urgency = enumCode(Urgency::High);
+    int assigned = enumCode(TaskStatus::Assigned);
+    session.begin();
+    for (int i = 0; i < taskCount; ++i) {
+        session << "INSERT INTO tasks (type, location, description, urgency, assigned_volunteer_id, status) "
+                << "VALUES ('Rescue', 'Sector 7', 'Benchmark task', ?, ?, ?)",
+            use(urgency), use(volunteerId), use(assigned), now;
+    }
+    session.commit();
+    volunteer.loadAssignedTasks();
+    return volunteer;
+}
+
+ReliefProvider seedProvider(const std::string& username, int resourceCount) {
+    ReliefProvider provider("Red Crescent", OrgType::NGO);
+    provider.setLocation("Sector 7");
+    provider.setUsername(username);
+    provider.setPassword("secret");
+    provider.save();
+    for (int i = 0; i < resourceCount; ++i) {
+        provider.addResource("resource_" + std::to_string(i), i + 1);
+    }
+    return provider;
+}
+
+void registerBenchmarks(microbench::Registry& registry) {
+    int requesterId = seedPerson("bench_requester");
+
+    // Serialization
+    registry.add("HelpRequest::toJSON", [=](State& state) {
+        HelpRequest request = sampleHelpRequest(requesterId);
+        while (state.keepRunning()) {
+            Object::Ptr json = request.toJSON();
+            doNotOptimize(json);
+        }
+    });
+
+    registry.add("HelpRequest::writeJSON", [=](State& state) {
+        HelpRequest request = sampleHelpRequest(requesterId);
+        while (state.keepRunning()) {
+            std::string& body = json::responseBuffer();
+            json::Writer writer(body);
+            request.writeJSON(writer);
+            doNotOptimize(body);
+        }
+    });
+
+    // A 50-row listing as the API sends it: Poco tree + stringify vs. json::Writer
+    std::vector<HelpRequest> listing(50, sampleHelpRequest(requesterId));
+    registry.add("Response/help_requests_50/poco", [=](State& state) {
+        while (state.keepRunning()) {
+            Poco::JSON::Array result;
+            for (const auto& req : listing) {
+                result.add(req.toJSON());
+            }
+            std::ostringstream out;
+            Poco::JSON::Stringifier::stringify(result, out);
+            doNotOptimize(out);
+        }
+    });
+
+    registry.add("Response/help_requests_50/writer", [=](State& state) {
+        while (state.keepRunning()) {
+            Arena::Scope arena;
+            std::string& body = json::responseBuffer();
+            json::Writer writer(body);
+            writer.beginArray();
+            for (const auto& req : listing) {
+                req.writeJSON(writer);
+            }
+            writer.endArray();
+            doNotOptimize(body);
+        }
+    });
+
+    // Compression cost against bytes saved, for server.compressMinBytes and
+    // server.compressLevel: one row (~250 bytes) and a 50-row listing
+    std::string oneRow;
+    {
+        json::Writer writer(oneRow);
+        sampleHelpRequest(requesterId).writeJSON(writer);
+    }
+    std::string fiftyRows;
+    {
+        json::Writer writer(fiftyRows);
+        writer.beginArray();
+        for (const auto& req : listing) req.writeJSON(writer);
+        writer.endArray();
+    }
+    for (const auto& body : {std::make_pair(std::string("help_requests_1"), oneRow),
+                             std::make_pair(std::string("help_requests_50"), fiftyRows)}) {
+        registry.add("Compression/identity/" + body.first, [=](State& state) {
+            state.setOutputBytes(body.second.size());
+            while (state.keepRunning()) doNotOptimize(body.second);
+        });
+        for (int level : {1, 6, 9}) {
+            registry.add("Compression/gzip" + std::to_string(level) + "/" + body.first, [=](State& state) {
+                ResponseCompression::instance().configure(0, level, 16 << 20);
+                while (state.keepRunning()) {
+                    std::string packed = ResponseCompression::instance().compress(body.second, ContentEncoding::Gzip);
+                    state.setOutputBytes(packed.size());
+                    doNotOptimize(packed);
+                }
+                ResponseCompression::instance().configure(1024, 6, 16 << 20);
+            });
+        }
+        // What sendJson() pays for an unchanged body: hashing it and a cache hit
+        registry.add("Compression/gzip6_cached/" + body.first, [=](State& state) {
+            while (state.keepRunning()) {
+                auto packed = ResponseCompression::instance().compressed(ResponseCompression::etag(body.second),
+                                                                         body.second, ContentEncoding::Gzip);
+                doNotOptimize(packed);
+            }
+        });
+    }
+
+    registry.add("formatTimestamp", [](State& state) {
+        // One row per second: every call misses the per-second cache
+        EpochMillis millis = 1714558500000;
+        char text[kTimestampLength];
+        while (state.keepRunning()) {
+            formatTimestamp(millis, text);
+            doNotOptimize(text);
+            millis += 1000;
+        }
+    });
+
+    registry.add("HelpRequest::fromJSON", [=](State& state) {
+        Object::Ptr json = sampleHelpRequest(requesterId).toJSON();
+        json->remove("id");
+        json->remove("timestamp");
+        while (state.keepRunning()) {
+            HelpRequest request = HelpRequest::fromJSON(json);
+            doNotOptimize(request);
+        }
+    });
+
+    registry.add("PeopleInCrisis::fromJSON", [](State& state) {
+        Object::Ptr json = samplePersonJson("bench_from_json");
+        while (state.keepRunning()) {
+            PeopleInCrisis person = PeopleInCrisis::fromJSON(json);
+            doNotOptimize(person);
+        }
+    });
+
+    Volunteer busyVolunteer = seedVolunteer("bench_busy_volunteer", 1000);
+    registry.add("Volunteer::toJSON/1000_tasks", [=](State& state) {
+        while (state.keepRunning()) {
+            Object::Ptr json = busyVolunteer.toJSON();
+            doNotOptimize(json);
+        }
+    });
+
+    ReliefProvider stockedProvider = seedProvider("bench_stocked_provider", 200);
+    registry.add("ReliefProvider::toJSON/200_resources", [=](State& state) {
+        while (state.keepRunning()) {
+            Object::Ptr json = stockedProvider.toJSON();
+            doNotOptimize(json);
+        }
+    });
+
+    // Request body parsing
+    std::ostringstream signupBody;
+    Poco::JSON::Stringifier::stringify(samplePersonJson("bench_parse"), signupBody);
+    std::string smallBody = signupBody.str();
+    registry.add("ApiRequestHandler::parseJsonBody/signup", [=](State& state) {
+        while (state.keepRunning()) {
+            std::istringstream body(smallBody);
+            Object::Ptr json = ApiRequestHandler::parseJsonStream(body);
+            doNotOptimize(json);
+        }
+    });
+
+    HelpRequest largeRequest = sampleHelpRequest(requesterId);
+    largeRequest.setDescription(std::string(4096, 'x'));
+    std::ostringstream helpBody;
+    Poco::JSON::Stringifier::stringify(largeRequest.toJSON(), helpBody);
+    std::string largeBody = helpBody.str();
+    registry.add("ApiRequestHandler::parseJsonBody/help_4k", [=](State& state) {
+        while (state.keepRunning()) {
+            std::istringstream body(largeBody);
+            Object::Ptr json = ApiRequestHandler::parseJsonStream(body);
+            doNotOptimize(json);
+        }
+    });
+
+    // The same bodies through the arena parser, one request scope per iteration
+    registry.add("ApiRequestHandler::parseArenaBody/signup", [=](State& state) {
+        while (state.keepRunning()) {
+            Arena::Scope arena;
+            std::istringstream body(smallBody);
+            std::string_view text = ApiRequestHandler::readBody(body, arena.get(), -1);
+            json::Parser parser(arena.get());
+            const json::Value* json = parser.parse(text);
+            doNotOptimize(json);
+        }
+    });
+
+    registry.add("ApiRequestHandler::parseArenaBody/help_4k", [=](State& state) {
+        while (state.keepRunning()) {
+            Arena::Scope arena;
+            std::istringstream body(largeBody);
+            std::string_view text = ApiRequestHandler::readBody(body, arena.get(), -1);
+            json::Parser parser(arena.get());
+            const json::Value* json = parser.parse(text);
+            doNotOptimize(json);
+        }
+    });
+
+    // Many short strings with escapes: each decoded copy must be sized by its
+    // own string, not by the rest of the body
+    std::string escapedBody = "[";
+    for (int i = 0; i < 10000; ++i) escapedBody += i ? ",\"\\n\"" : "\"\\n\"";
+    escapedBody += "]";
+    registry.add("ApiRequestHandler::parseArenaBody/escaped_strings_10k", [=](State& state) {
+        while (state.keepRunning()) {
+            Arena::Scope arena;
+            json::Parser parser(arena.get());
+            const json::Value* json = parser.parse(escapedBody);
+            doNotOptimize(json);
+            state.setOutputBytes(arena.get().used());
+        }
+    });
+
+    // Whole decode into the model: Poco tree plus fromJSON, against the
+    // structural-index decoder on each instruction set this CPU has
+    registry.add("Poco::JSON::Parser+fromJSON/signup", [=](State& state) {
+        while (state.keepRunning()) {
+            std::istringstream body(smallBody);
+            PeopleInCrisis person = PeopleInCrisis::fromJSON(ApiRequestHandler::parseJsonStream(body));
+            doNotOptimize(person);
+        }
+    });
+
+    registry.add("Poco::JSON::Parser+fromJSON/help_4k", [=](State& state) {
+        while (state.keepRunning()) {
+            std::istringstream body(largeBody);
+            HelpRequest request = HelpRequest::fromJSON(ApiRequestHandler::parseJsonStream(body));
+            doNotOptimize(request);
+        }
+    });
+
+    for (json::simd::Isa isa : {json::simd::Isa::Scalar, json::simd::Isa::Sse42, json::simd::Isa::Avx2}) {
+        if (!json::simd::supported(isa)) continue;
+        std::string suffix = json::simd::isaName(isa);
+        registry.add("json::Decoder/signup/" + suffix, [=](State& state) {
+            while (state.keepRunning()) {
+                Arena::Scope arena;
+                std::istringstream body(smallBody);
+                std::string_view text = ApiRequestHandler::readBody(body, arena.get(), -1);
+                json::Decoder decoder(arena.get(), isa);
+                PeopleInCrisis person;
+                bool ok = decoder.decode(text, person);
+                doNotOptimize(ok);
+                doNotOptimize(person);
+            }
+        });
+
+        registry.add("json::Decoder/help_4k/" + suffix, [=](State& state) {
+            while (state.keepRunning()) {
+                Arena::Scope arena;
+                std::istringstream body(largeBody);
+                std::string_view text = ApiRequestHandler::readBody(body, arena.get(), -1);
+                json::Decoder decoder(arena.get(), isa);
+                HelpRequest request;
+                bool ok = decoder.decode(text, request);
+                doNotOptimize(ok);
+                doNotOptimize(request);
+            }
+        });
+
+        registry.add("json::StructuralIndex/help_4k/" + suffix, [=](State& state) {
+            json::StructuralIndex index;
+            while (state.keepRunning()) {
+                bool ok = index.build(largeBody, isa);
+                doNotOptimize(ok);
+            }
+        });
+    }
+
+    // Persistence against the in-memory database
+    registry.add("HelpRequest::save/insert", [=](State& state) {
+        while (state.keepRunning()) {
+            HelpRequest request = sampleHelpRequest(requesterId);
+            request.save();
+        }
+    });
+
+    // 1000 rows per iteration; timestamps move on so no row repeats an earlier one
+    auto importBody = [requesterId](ImportController::Format format, EpochMillis first) {
+        std::string body = format == ImportController::Format::CSV
+                               ? "requesterId,type,description,location,urgency,timestamp\n"
+                               : "";
+        for (int i = 0; i < 1000; ++i) {
+            std::string timestamp = std::to_string(first + i);
+            if (format == ImportController::Format::CSV) {
+                body += std::to_string(requesterId) + ",Medical,\"Need insulin, clean water\",Sector 7,8," +
+                        timestamp + "\n";
+            } else {
+                body += "{\"requesterId\":" + std::to_string(requesterId) +
+                        ",\"type\":\"Medical\",\"description\":\"Need insulin, clean water\","
+                        "\"location\":\"Sector 7\",\"urgency\":8,\"timestamp\":" + timestamp + "}\n";
+            }
+        }
+        return body;
+    };
+    for (auto format : {ImportController::Format::CSV, ImportController::Format::NDJSON}) {
+        std::string suffix = format == ImportController::Format::CSV ? "csv" : "ndjson";
+        registry.add("ImportController::importRows/help_requests_1000/" + suffix, [=](State& state) {
+            static EpochMillis next = 1714558500000;
+            ImportController importer;
+            while (state.keepRunning()) {
+                std::istringstream body(importBody(format, next));
+                next += 1000;
+                ImportReport report = importer.importRows<HelpRequest>(body, format);
+                doNotOptimize(report);
+            }
+        });
+    }
+
+    // Whatever help_requests holds by then, the imports above included
+    for (auto format : {ExportController::Format::CSV, ExportController::Format::NDJSON}) {
+        std::string suffix = format == ExportController::Format::CSV ? "csv" : "ndjson";
+        registry.add("ExportController::exportTable/help_requests/" + suffix, [=](State& state) {
+            ExportController exporter;
+            while (state.keepRunning()) {
+                std::ostringstream out;
+                bool ok = exporter.exportTable("help_requests", format, out);
+                doNotOptimize(ok);
+            }
+        });
+    }
+
+    // Over the same rows: a common term, a prefix, and a filtered phrase
+    for (const auto& text : {std::string("insulin"), std::string("ins*"), std::string("\"clean water\"")}) {
+        registry.add("SearchController::search/" + text, [=](State& state) {
+            SearchController search;
+            SearchQuery query;
+            query.text = text;
+            query.location = text[0] == '"' ? "Sector 7" : "";
+            std::vector<SearchHit> hits;
+            while (state.keepRunning()) {
+                bool ok = search.search(query, hits);
+                doNotOptimize(ok);
+            }
+        });
+    }
+
+    HelpRequest stored = sampleHelpRequest(requesterId);
+    stored.save();
+    int storedRequestId = stored.getId();
+    registry.add("HelpRequest::findById", [=](State& state) {
+        while (state.keepRunning()) {
+            HelpRequest request = HelpRequest::findById(storedRequestId);
+            doNotOptimize(request);
+        }
+    });
+
+    registry.add("PeopleInCrisis::save/insert", [](State& state) {
+        static uint64_t sequence = 0;
+        while (state.keepRunning()) {
+            PeopleInCrisis person = PeopleInCrisis::fromJSON(samplePersonJson("bench_person_" + std::to_string(++sequence)));
+            person.save();
+        }
+    });
+
+    registry.add("PeopleInCrisis::findById", [=](State& state) {
+        while (state.keepRunning()) {
+            PeopleInCrisis person = PeopleInCrisis::findById(requesterId);
+            doNotOptimize(person);
+        }
+    });
+
+    registry.add("Volunteer::save/insert", [](State& state) {
+        static uint64_t sequence = 0;
+        while (state.keepRunning()) {
+            Volunteer volunteer;
+            volunteer.setName("Ravi Kumar");
+            volunteer.setLocation("Sector 7");
+            volunteer.setUsername("bench_volunteer_" + std::to_string(++sequence));
+            volunteer.setPassword("secret");
+            volunteer.setOrgType(OrgType::NGO);
+            volunteer.save();
+        }
+    });
+
+    int busyVolunteerId = busyVolunteer.getUserID();
+    registry.add("Volunteer::findById/1000_tasks", [=](State& state) {
+        while (state.keepRunning()) {
+            Volunteer volunteer = Volunteer::findById(busyVolunteerId);
+            doNotOptimize(volunteer);
+        }
+    });
+
+    registry.add("ReliefProvider::save/insert", [](State& state) {
+        static uint64_t sequence = 0;
+        while (state.keepRunning()) {
+            ReliefProvider provider("Red Crescent", OrgType::NGO);
+            provider.setLocation("Sector 7");
+            provider.setUsername("bench_provider_" + std::to_string(++sequence));
+            provider.setPassword("secret");
+            provider.save();
+        }
+    });
+
+    int stockedProviderId = stockedProvider.getId();
+    registry.add("ReliefProvider::findById/200_resources", [=](State& state) {
+        while (state.keepRunning()) {
+            ReliefProvider provider = ReliefProvider::findById(stockedProviderId);
+            doNotOptimize(provider);
+        }
+    });
+
+    registry.add("GovernmentAgency::save/insert", [](State& state) {
+        static uint64_t sequence = 0;
+        while (state.keepRunning()) {
+            GovernmentAgency agency;
+            agency.setAgencyName("Disaster Response Authority");
+            agency.setUsername("bench_agency_" + std::to_string(++sequence));
+            agency.setPassword("secret");
+            agency.save();
+        }
+    });
+
+    GovernmentAgency storedAgency;
+    storedAgency.setAgencyName("Disaster Response Authority");
+    storedAgency.setUsername("bench_agency_stored");
+    storedAgency.setPassword("secret");
+    storedAgency.save();
+    int storedAgencyId = storedAgency.getId();
+    registry.add("GovernmentAgency::findById", [=](State& state) {
+        while (state.keepRunning()) {
+            GovernmentAgency agency = GovernmentAgency::findById(storedAgencyId);
+            doNotOptimize(agency);
+        }
+    });
+
+    registry.add("Admin::save/insert", [](State& state) {
+        static uint64_t sequence = 0;
+        while (state.keepRunning()) {
+            Admin admin;
+            admin.setName("Operator");
+            admin.setUsername("bench_admin_" + std::to_string(++sequence));
+            admin.setPassword("secret");
+            admin.save();
+        }
+    });
+
+    Admin storedAdmin = Admin::findByUsername("admin");
+    int storedAdminId = storedAdmin.getId();
+    registry.add("Admin::findById", [=](State& state) {
+        while (state.keepRunning()) {
+            Admin admin = Admin::findById(storedAdminId);
+            doNotOptimize(admin);
+        }
+    });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    double minSeconds = 0.2;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find("--filter=") == 0) filter = arg.substr(9);
+        else if (arg.find("--min-time=") == 0) minSeconds = std::stod(arg.substr(11));
+        else if (arg == "--json") json = true;
+        else {
+            std::cerr << "Usage: cms_microbench [--filter=substring] [--min-time=seconds] [--json]" << std::endl;
+            return 1;
+        }
+    }
+
+    DatabaseManager::setDatabasePath(":memory:");
+    DatabaseManager::getInstance();
+
+    microbench::Registry registry;
+    registerBenchmarks(registry);
+    auto results = registry.run(filter, minSeconds);
+
+    if (json) {
+        microbench::printJson(results, std::cout);
+    } else {
+        microbench::printTable(results, std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal Google Benchmark-style harness: benchmarks are registered by name,
+// each one loops on state.keepRunning() and the harness grows the iteration
+// count until the run lasts at least the minimum time. Allocation counts come
+// from the global operator new hook defined in the benchmark binary.
+namespace microbench {
+
+// Incremented by the benchmark binary's operator new
+inline std::atomic<uint64_t>& allocationCount() {
+    static std::atomic<uint64_t> count(0);
+    return count;
+}
+
+inline std::atomic<uint64_t>& allocatedBytes() {
+    static std::atomic<uint64_t> bytes(0);
+    return bytes;
+}
+
+// Prevent the compiler from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class State {
+private:
+    uint64_t iterations;
+    uint64_t remaining;
+    uint64_t output = 0;
+
+public:
+    explicit State(uint64_t iterations) : iterations(iterations), remaining(iterations) {}
+
+    uint64_t maxIterations() const { return iterations; }
+
+    // Size of what one operation produces, e.g. a compressed body, for size-vs-time tradeoffs
+    void setOutputBytes(uint64_t bytes) { output = bytes; }
+    uint64_t outputBytes() const { return output; }
+
+    bool keepRunning() {
+        if (remaining == 0) return false;
+        --remaining;
+        return true;
+    }
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+    double bytesPerOp = 0;
+    uint64_t outputBytes = 0;
+};
+
+class Registry {
+private:
+    struct Entry {
+        std::string name;
+        std::function<void(State&)> fn;
+    };
+    std::vector<Entry> entries;
+
+public:
+    void add(const std::string& name, std::function<void(State&)> fn) {
+        entries.push_back({name, std::move(fn)});
+    }
+
+    std::vector<Result> run(const std::string& filter, double minSeconds) {
+        std::vector<Result> results;
+        for (const auto& entry : entries) {
+            if (!filter.empty() && entry.name.find(filter) == std::string::npos) continue;
+
+            uint64_t iterations = 1;
+            while (true) {
+                State state(iterations);
+                uint64_t allocsBefore = allocationCount().load(std::memory_order_relaxed);
+                uint64_t bytesBefore = allocatedBytes().load(std::memory_order_relaxed);
+                auto start = std::chrono::steady_clock::now();
+                entry.fn(state);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                uint64_t allocs = allocationCount().load(std::memory_order_relaxed) - allocsBefore;
+                uint64_t bytes = allocatedBytes().load(std::memory_order_relaxed) - bytesBefore;
+
+                double seconds = std::chrono::duration<double>(elapsed).count();
+                if (seconds >= minSeconds || iterations >= (1ULL << 30)) {
+                    Result result;
+                    result.name = entry.name;
+                    result.iterations = iterations;
+                    result.nsPerOp = seconds * 1e9 / iterations;
+                    result.allocsPerOp = static_cast<double>(allocs) / iterations;
+                    result.bytesPerOp = static_cast<double>(bytes) / iterations;
+                    result.outputBytes = state.outputBytes();
+                    results.push_back(result);
+                    break;
+                }
+
+                // Aim for the minimum time with some headroom, growing at most 10x per step
+                double scale = seconds > 0 ? (minSeconds * 1.4) / seconds : 10.0;
+                if (scale > 10.0) scale = 10.0;
+                if (scale < 2.0) scale = 2.0;
+                iterations = static_cast<uint64_t>(iterations * scale);
+            }
+        }
+        return results;
+    }
+};
+
+inline void printTable(const std::vector<Result>& results, std::ostream& out) {
+    out << std::left << std::setw(48) << "Benchmark"
+        << std::right << std::setw(14) << "ns/op"
+        << std::setw(14) << "allocs/op"
+        << std::setw(14) << "bytes/op"
+        << std::setw(14) << "iterations"
+        << std::setw(14) << "output" << "\n";
+    out << std::string(118, '-') << "\n";
+    for (const auto& r : results) {
+        out << std::left << std::setw(48) << r.name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(14) << r.nsPerOp
+            << std::setw(14) << r.allocsPerOp
+            << std::setw(14) << r.bytesPerOp
+            << std::setw(14) << r.iterations
+            << std::setw(14) << (r.outputBytes ? std::to_string(r.outputBytes) : "-") << "\n";
+    }
+}
+
+inline void printJson(const std::vector<Result>& results, std::ostream& out) {
+    out << "{\"benchmarks\":[";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        if (i) out << ",";
+        out << "{\"name\":\"" << r.name << "\""
+            << ",\"iterations\":" << r.iterations
+            << ",\"ns_per_op\":" << r.nsPerOp
+            << ",\"allocs_per_op\":" << r.allocsPerOp
+            << ",\"bytes_per_op\":" << r.bytesPerOp
+            << ",\"output_bytes\":" << r.outputBytes << "}";
+    }
+    out << "]}\n";
+}
+
+} // namespace microbench
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <Poco/Util/ServerApplication.h>
+#include "../logging/Logger.h"
+
+// Message link between a worker process and the supervisor.
+//
+// In multi-process mode every worker holds one end of a SOCK_SEQPACKET pair
+// whose other end is owned by the supervisor. A worker publishes a topic with
+// a list of string fields; the supervisor delivers it to its own subscribers
+// and, unless the topic starts with "writer.", relays it to every other
+// worker, where it reaches that worker's subscribers. Relayed messages are
+// delivered in order and not dropped, except on best-effort "metrics."
+// topics (see Supervisor). In a single-process server the channel is never
+// connected and publish() is a no-op.
+class ClusterChannel {
+public:
+    using Fields = std::vector<std::string>;
+    using Handler = std::function<void(const Fields&)>;
+
+    static constexpr std::size_t kMaxMessage = 64 * 1024;
+
+private:
+    int fd = -1;
+    std::mutex sendMutex;
+    std::mutex handlersMutex;
+    std::unordered_map<std::string, std::vector<Handler>> handlers;
+    std::atomic<bool> stopping{false};
+    std::thread receiver;
+
+    ClusterChannel() {
+        logging::Logger::instance();
+    }
+
+    ~ClusterChannel() {
+        disconnect();
+    }
+
+    static void putLength(std::string& out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void receive() {
+        std::vector<char> buffer(kMaxMessage);
+        while (!stopping.load()) {
+            ssize_t size = recv(fd, buffer.data(), buffer.size(), 0);
+            if (size < 0 && errno == EINTR) continue;
+            if (size <= 0) {
+                if (!stopping.load()) {
+                    // The supervisor is gone; nothing would replicate our writes, so shut down
+                    LOG_ERROR("Lost connection to supervisor, shutting down worker");
+                    Poco::Util::ServerApplication::terminate();
+                }
+                return;
+            }
+            std::string topic;
+            Fields fields;
+            if (decode(buffer.data(), static_cast<std::size_t>(size), topic, fields)) {
+                deliver(topic, fields);
+            }
+        }
+    }
+
+public:
+    static ClusterChannel& instance() {
+        static ClusterChannel channel;
+        return channel;
+    }
+
+    static std::string encode(const std::string& topic, const Fields& fields) {
+        std::string out;
+        putLength(out, static_cast<uint32_t>(topic.size()));
+        out += topic;
+        putLength(out, static_cast<uint32_t>(fields.size()));
+        for (const auto& field : fields) {
+            putLength(out, static_cast<uint32_t>(field.size()));
+            out += field;
+        }
+        return out;
+    }
+
+    static bool decode(const char* data, std::size_t size, std::string& topic, Fields& fields) {
+        std::size_t pos = 0;
+        auto take = [&](std::string& out) {
+            uint32_t length;
+            if (pos + sizeof(length) > size) return false;
+            std::memcpy(&length, data + pos, sizeof(length));
+            pos += sizeof(length);
+            if (pos + length > size) return false;
+            out.assign(data + pos, length);
+            pos += length;
+            return true;
+        };
+        if (!take(topic)) return false;
+        uint32_t count;
+        if (pos + sizeof(count) > size) return false;
+        std::memcpy(&count, data + pos, sizeof(count));
+        pos += sizeof(count);
+        fields.clear();
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string field;
+            if (!take(field)) return false;
+            fields.push_back(std::move(field));
+        }
+        return true;
+    }
+
+    // Called once in a worker process with its end of the supervisor link
+    void connect(int channelFd) {
+        fd = channelFd;
+        receiver = std::thread([this] { receive(); });
+    }
+
+    // Stop receiving; call before the subsystems the handlers touch are destroyed
+    void disconnect() {
+        stopping.store(true);
+        if (fd >= 0) shutdown(fd, SHUT_RDWR);
+        if (receiver.joinable()) receiver.join();
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+    bool isWorker() const {
+        return fd >= 0;
+    }
+
+    void subscribe(const std::string& topic, Handler handler) {
+        std::lock_guard<std::mutex> lock(handlersMutex);
+        handlers[topic].push_back(std::move(handler));
+    }
+
+    // Send to the supervisor; false when not running as a worker or the message was not sent
+    bool publish(const std::string& topic, const Fields& fields) {
+        if (fd < 0) return false;
+        std::string message = encode(topic, fields);
+        if (message.size() > kMaxMessage) {
+            LOG_WARN("Dropping oversized cluster message on " << topic);
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(sendMutex);
+        while (send(fd, message.data(), message.size(), MSG_NOSIGNAL) < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("Error publishing cluster message on " << topic << ": " << std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    // Run the local subscribers of a topic
+    void deliver(const std::string& topic, const Fields& fields) {
+        std::vector<Handler> targets;
+        {
+            std::lock_guard<std::mutex> lock(handlersMutex);
+            auto it = handlers.find(topic);
+            if (it == handlers.end()) return;
+            targets = it->second;
+        }
+        for (const auto& handler : targets) {
+            try {
+                handler(fields);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Error handling cluster message on " << topic << ": " << e.what());
+            }
+        }
+    }
+};
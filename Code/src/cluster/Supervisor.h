@@ -0,0 +1,274 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ClusterChannel.h"
+#include "../logging/Logger.h"
+#include "../metrics/Metrics.h"
+
+// Multi-process mode: forks and watches the worker processes.
+//
+// Each worker is this binary re-executed with --worker-channel=<fd>, so it
+// starts from a clean address space (no inherited SQLite handles or
+// threads), binds the shared port with SO_REUSEPORT and opens its own
+// database connection. The supervisor serves no HTTP traffic: it relays
+// cluster messages between workers and is the single writer for the
+// write-behind streams (session persistence, audit log) that workers hand it
+// over their channels. Workers that exit are restarted with a short backoff.
+//
+// Relayed messages are never dropped unless their topic is best-effort
+// ("metrics."): a worker that cannot take one now gets it queued and sent
+// when its channel drains. Losing a credentials.evict, session.revoke or
+// login.failure would leave a stale password, a logged-out token or a lockout
+// gap on that worker, so one that falls kMaxBacklog bytes behind is killed
+// and restarted, and rebuilds its state from the database.
+class Supervisor {
+private:
+    static constexpr std::size_t kMaxBacklog = 16 << 20;
+
+    struct Worker {
+        int index = 0;
+        pid_t pid = -1;
+        int fd = -1;
+        std::chrono::steady_clock::time_point startedAt;
+        std::deque<std::string> backlog;  // relayed messages not yet accepted, oldest first
+        std::size_t backlogBytes = 0;
+    };
+
+    std::vector<std::string> arguments;
+    std::vector<Worker> workers;
+    std::atomic<bool> stopping{false};
+    std::thread loop;
+
+    metrics::Counter& relayed = metrics::Registry::instance().counter(
+        "cluster_messages_relayed_total", "Cluster messages relayed to other workers");
+    metrics::Counter& dropped = metrics::Registry::instance().counter(
+        "cluster_messages_dropped_total", "Cluster messages a worker could not accept");
+    metrics::Counter& restarts = metrics::Registry::instance().counter(
+        "cluster_worker_restarts_total", "Worker processes restarted after exiting");
+    metrics::Counter& resyncs = metrics::Registry::instance().counter(
+        "cluster_worker_resyncs_total", "Workers restarted because they fell too far behind the relay");
+
+    bool spawn(Worker& worker) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, pair) != 0) {
+            LOG_ERROR("Error creating worker channel: " << std::strerror(errno));
+            return false;
+        }
+
+        std::vector<std::string> args = arguments;
+        args.push_back("--worker-channel=" + std::to_string(pair[1]));
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(&arg[0]);
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            LOG_ERROR("Error forking worker " << worker.index << ": " << std::strerror(errno));
+            close(pair[0]);
+            close(pair[1]);
+            return false;
+        }
+        if (pid == 0) {
+            // Child: keep only its end of the channel across exec and restore the signal mask
+            fcntl(pair[1], F_SETFD, 0);
+            sigset_t none;
+            sigemptyset(&none);
+            sigprocmask(SIG_SETMASK, &none, nullptr);
+            execv("/proc/self/exe", argv.data());
+            _exit(127);
+        }
+
+        close(pair[1]);
+        worker.pid = pid;
+        worker.fd = pair[0];
+        worker.startedAt = std::chrono::steady_clock::now();
+        LOG_INFO("Started worker " << worker.index << " (pid " << pid << ")");
+        return true;
+    }
+
+    static bool bestEffort(const std::string& topic) {
+        return topic.compare(0, 8, "metrics.") == 0;
+    }
+
+    // Closes a worker's channel; it is reaped and restarted like any exit
+    void disconnect(Worker& worker) {
+        close(worker.fd);
+        worker.fd = -1;
+        worker.backlog.clear();
+        worker.backlogBytes = 0;
+    }
+
+    // Sends as much of the backlog as the channel takes without blocking
+    void drain(Worker& worker) {
+        while (worker.fd >= 0 && !worker.backlog.empty()) {
+            const std::string& message = worker.backlog.front();
+            if (send(worker.fd, message.data(), message.size(), MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) disconnect(worker);
+                return;
+            }
+            relayed.inc();
+            worker.backlogBytes -= message.size();
+            worker.backlog.pop_front();
+        }
+    }
+
+    void relay(const Worker& from, const std::string& topic, const char* data, std::size_t size) {
+        bool droppable = bestEffort(topic);
+        for (auto& worker : workers) {
+            if (worker.index == from.index || worker.fd < 0) continue;
+            // Never block the relay on one slow worker; queue behind what it has not taken yet
+            if (worker.backlog.empty()) {
+                if (send(worker.fd, data, size, MSG_DONTWAIT | MSG_NOSIGNAL) >= 0) {
+                    relayed.inc();
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    disconnect(worker);
+                    continue;
+                }
+            }
+            if (droppable) {
+                dropped.inc();
+                continue;
+            }
+            worker.backlog.emplace_back(data, size);
+            worker.backlogBytes += size;
+            if (worker.backlogBytes > kMaxBacklog) {
+                LOG_ERROR("Worker " << worker.index << " (pid " << worker.pid << ") is " << worker.backlogBytes
+                          << " bytes behind the cluster relay; restarting it");
+                resyncs.inc();
+                if (worker.pid > 0) kill(worker.pid, SIGKILL);
+                disconnect(worker);
+            }
+        }
+    }
+
+    void readFrom(Worker& worker, std::vector<char>& buffer) {
+        while (true) {
+            ssize_t size = recv(worker.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (size < 0 && errno == EINTR) continue;
+            if (size <= 0) {
+                if (size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) disconnect(worker);
+                return;
+            }
+            std::string topic;
+            ClusterChannel::Fields fields;
+            if (!ClusterChannel::decode(buffer.data(), static_cast<std::size_t>(size), topic, fields)) continue;
+            ClusterChannel::instance().deliver(topic, fields);
+            if (topic.compare(0, 7, "writer.") != 0) {
+                relay(worker, topic, buffer.data(), static_cast<std::size_t>(size));
+            }
+        }
+    }
+
+    void reap() {
+        for (auto& worker : workers) {
+            int status = 0;
+            if (worker.pid <= 0 || waitpid(worker.pid, &status, WNOHANG) != worker.pid) continue;
+            LOG_WARN("Worker " << worker.index << " (pid " << worker.pid << ") exited with status " << status);
+            worker.pid = -1;
+            if (worker.fd >= 0) disconnect(worker);
+        }
+    }
+
+    void run() {
+        std::vector<char> buffer(ClusterChannel::kMaxMessage);
+        while (!stopping.load()) {
+            std::vector<pollfd> fds;
+            std::vector<std::size_t> owners;
+            for (std::size_t i = 0; i < workers.size(); ++i) {
+                if (workers[i].fd < 0) continue;
+                short events = POLLIN;
+                if (!workers[i].backlog.empty()) events |= POLLOUT;
+                fds.push_back({workers[i].fd, events, 0});
+                owners.push_back(i);
+            }
+            int ready = poll(fds.data(), fds.size(), 250);
+            if (ready > 0) {
+                for (std::size_t i = 0; i < fds.size(); ++i) {
+                    Worker& worker = workers[owners[i]];
+                    if (fds[i].revents & POLLOUT) drain(worker);
+                    if ((fds[i].revents & ~POLLOUT) != 0 && worker.fd >= 0) readFrom(worker, buffer);
+                }
+            }
+
+            reap();
+            auto now = std::chrono::steady_clock::now();
+            for (auto& worker : workers) {
+                // Back off so a worker that dies at startup does not spin
+                if (worker.pid < 0 && !stopping.load() && now - worker.startedAt >= std::chrono::seconds(1)) {
+                    if (spawn(worker)) restarts.inc();
+                }
+            }
+        }
+    }
+
+public:
+    // arguments: argv to re-execute, starting with the program name
+    Supervisor(int processes, const std::vector<std::string>& arguments) : arguments(arguments) {
+        for (int i = 0; i < processes; ++i) {
+            Worker worker;
+            worker.index = i;
+            workers.push_back(worker);
+        }
+    }
+
+    ~Supervisor() {
+        stop(std::chrono::seconds(0));
+    }
+
+    bool start() {
+        for (auto& worker : workers) {
+            if (!spawn(worker)) return false;
+        }
+        loop = std::thread([this] { run(); });
+        return true;
+    }
+
+    // Ask workers to shut down and wait up to the deadline before killing them
+    void stop(std::chrono::steady_clock::duration deadline) {
+        if (stopping.exchange(true)) return;
+        if (loop.joinable()) loop.join();
+
+        for (const auto& worker : workers) {
+            if (worker.pid > 0) kill(worker.pid, SIGTERM);
+        }
+        auto until = std::chrono::steady_clock::now() + deadline;
+        std::vector<char> buffer(ClusterChannel::kMaxMessage);
+        while (true) {
+            bool running = false;
+            for (auto& worker : workers) {
+                // Keep applying their final writes while they drain
+                if (worker.fd >= 0) readFrom(worker, buffer);
+                drain(worker);
+                running = running || worker.pid > 0;
+            }
+            reap();
+            if (!running || std::chrono::steady_clock::now() >= until) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        for (auto& worker : workers) {
+            if (worker.pid > 0) {
+                LOG_WARN("Killing worker " << worker.index << " (pid " << worker.pid << ") after shutdown deadline");
+                kill(worker.pid, SIGKILL);
+                waitpid(worker.pid, nullptr, 0);
+                worker.pid = -1;
+            }
+            if (worker.fd >= 0) disconnect(worker);
+        }
+    }
+};
@@ -5,7 +5,12 @@
 #include <Poco/JSON/Object.h>
 #include "../models/Admin.h"
 #include "../models/AlertSystem.h"
+#include "../models/Timestamp.h"
 #include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
+#include "../security/SessionStore.h"
+#include "../security/LoginThrottle.h"
+#include "../security/AuditLog.h"
 #include <Poco/JSON/Array.h>
 
 using namespace Poco::Data::Keywords;
@@ -56,7 +61,7 @@ public:
             
             return admin.save();
         } catch (const std::exception& e) {
-            std::cerr << "Error registering admin: " << e.what() << std::endl;
+            LOG_ERROR("Error registering admin: " << e.what());
             return false;
         }
     }
@@ -122,51 +127,35 @@ public:
         admin.setAlertThreshold(type, threshold);
     }
 
-    Poco::JSON::Object getSecurityLogs() {
-        auto session = dbManager->getSession();
+    // Latest security events from the audit log, newest first
+    Poco::JSON::Object getSecurityLogs(std::size_t limit = 100) {
         Poco::JSON::Object result;
-        
-        try {
-            Poco::Data::Statement select(session);
-            std::vector<std::string> logs;
-            select << "SELECT * FROM security_logs ORDER BY timestamp DESC LIMIT 100",
-                into(logs),
-                now;
-            
-            Poco::JSON::Array logsArray;
-            for (const auto& log : logs) {
-                Poco::JSON::Object logObj;
-                logObj.set("id", log);
-                logsArray.add(logObj);
-            }
-            result.set("logs", logsArray);
-        } catch (const std::exception& e) {
-            std::cerr << "Error getting security logs: " << e.what() << std::endl;
+        Poco::JSON::Array logsArray;
+        for (const auto& record : AuditLog::instance().latest(limit)) {
+            logsArray.add(auditRecordToJSON(record));
         }
-        
+        result.set("logs", logsArray);
         return result;
     }
 
+    static Poco::JSON::Object auditRecordToJSON(const AuditRecord& record) {
+        Poco::JSON::Object logObj;
+        logObj.set("id", record.sequence);
+        logObj.set("timestamp", record.timestampMs);
+        logObj.set("event_type", record.type);
+        logObj.set("subject", record.subject);
+        logObj.set("description", record.description);
+        return logObj;
+    }
+
     Poco::JSON::Object getSecurityStatus() {
         auto session = dbManager->getSession();
         Poco::JSON::Object result;
         
         try {
-            // Get active sessions
-            Poco::Data::Statement sessions(session);
-            int activeSessions;
-            sessions << "SELECT COUNT(*) FROM active_sessions",
-                into(activeSessions),
-                now;
-            result.set("active_sessions", activeSessions);
-            
-            // Get failed login attempts
-            Poco::Data::Statement failedLogins(session);
-            int failedLoginCount;
-            failedLogins << "SELECT COUNT(*) FROM security_logs WHERE event_type = 'failed_login' AND timestamp > DATE_SUB(NOW(), INTERVAL 1 HOUR)",
-                into(failedLoginCount),
-                now;
-            result.set("failed_logins_last_hour", failedLoginCount);
+            // Session and failed-login counts come from memory, not a table scan
+            result.set("active_sessions", static_cast<Poco::UInt64>(SessionStore::instance().activeSessions()));
+            result.set("failed_logins_last_hour", LoginThrottle::instance().failedLoginsLastHour());
             
             // Get security alerts
             Poco::Data::Statement alerts(session);
@@ -176,7 +165,7 @@ public:
                 now;
             result.set("active_alerts", activeAlerts);
         } catch (const std::exception& e) {
-            std::cerr << "Error getting security status: " << e.what() << std::endl;
+            LOG_ERROR("Error getting security status: " << e.what());
         }
         
         return result;
@@ -190,6 +179,7 @@ public:
             int maxLoginAttempts = json->getValue<int>("max_login_attempts");
             int sessionTimeout = json->getValue<int>("session_timeout");
             bool ipRestriction = json->getValue<bool>("ip_restriction");
+            Poco::Int64 updatedAt = nowMillis();
             
             Poco::Data::Statement update(session);
             update << "UPDATE security_settings SET "
@@ -197,16 +187,20 @@ public:
                    "max_login_attempts = ?, "
                    "session_timeout = ?, "
                    "ip_restriction = ?, "
-                   "updated_at = NOW()",
+                   "updated_at = ?",
                 use(twoFactorEnabled),
                 use(maxLoginAttempts),
                 use(sessionTimeout),
                 use(ipRestriction),
+                use(updatedAt),
                 now;
             
+            // New logins pick up the timeout and lockout limit straight away
+            SessionStore::instance().setTimeout(sessionTimeout);
+            LoginThrottle::instance().setMaxAttempts(maxLoginAttempts);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error updating security settings: " << e.what() << std::endl;
+            LOG_ERROR("Error updating security settings: " << e.what());
             return false;
         }
     }
@@ -230,7 +224,7 @@ public:
             }
             result.set("verifications", verificationsArray);
         } catch (const std::exception& e) {
-            std::cerr << "Error getting pending verifications: " << e.what() << std::endl;
+            LOG_ERROR("Error getting pending verifications: " << e.what());
         }
         
         return result;
@@ -243,13 +237,15 @@ public:
             Poco::Data::Statement update(session);
             std::string status = approved ? "approved" : "rejected";
             std::string notesCopy = notes;
+            Poco::Int64 verifiedAt = nowMillis();
             update << "UPDATE account_verifications SET "
                    "status = ?, "
                    "notes = ?, "
-                   "verified_at = NOW() "
+                   "verified_at = ? "
                    "WHERE id = ?",
                 use(status),
                 use(notesCopy),
+                use(verifiedAt),
                 use(verificationId),
                 now;
             
@@ -274,7 +270,7 @@ public:
             
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error verifying account: " << e.what() << std::endl;
+            LOG_ERROR("Error verifying account: " << e.what());
             return false;
         }
     }
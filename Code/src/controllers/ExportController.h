@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sqlite3.h>
+#include <Poco/Data/Session.h>
+#include <Poco/Data/SQLite/Utility.h>
+#include "../api/Json.h"
+#include "../database/DatabaseManager.h"
+#include "../models/Enums.h"
+#include "../models/Timestamp.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+
+// Streaming export of whole tables for reporting.
+//
+// Rows come off one SELECT stepped with the SQLite API, so a table is never
+// held in memory: each row is rendered into a 64 KiB buffer that is written
+// to the output whenever it fills. A SELECT is a single read transaction, so
+// in WAL mode the export sees the table as it was when it started while
+// writers carry on; checkpoints cannot pass that snapshot until it ends.
+// Exports run on a read-only connection of their own where there is one.
+//
+// Values are written as stored, except that enum codes are written by name
+// and epoch-millisecond columns as datetime text, as the API does.
+class ExportController {
+public:
+    enum class Format { NDJSON, CSV };
+
+private:
+    static constexpr std::size_t kFlushBytes = 64 * 1024;
+
+    // A column written other than as stored: by enum name, or as a time when label is null
+    struct ColumnFormat {
+        std::string_view column;
+        const char* (*label)(int code);
+    };
+
+    struct Table {
+        std::string_view name;
+        std::vector<ColumnFormat> columns;
+    };
+
+    template <typename E>
+    static const char* codeName(int code) {
+        return enumName(enumFromCode<E>(code));
+    }
+
+    static const std::vector<Table>& tables() {
+        static const std::vector<Table> exportable = {
+            {"help_requests", {{"type", codeName<HelpType>}, {"status", codeName<RequestStatus>}, {"timestamp", nullptr}}},
+            {"volunteer_assignments", {{"timestamp", nullptr}}},
+            {"donations", {{"timestamp", nullptr}}},
+            {"emergency_budgets", {{"status", codeName<OperationStatus>}, {"created_at", nullptr}, {"allocated_at", nullptr}}},
+        };
+        return exportable;
+    }
+
+    static const Table* find(std::string_view name) {
+        for (const auto& table : tables()) {
+            if (table.name == name) return &table;
+        }
+        return nullptr;
+    }
+
+    // Finalizes the statement however the export ends
+    struct Cursor {
+        sqlite3_stmt* statement = nullptr;
+        ~Cursor() { sqlite3_finalize(statement); }
+    };
+
+    static void appendCsv(std::string& out, std::string_view text) {
+        if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out.append(text.data(), text.size());
+            return;
+        }
+        out += '"';
+        for (char c : text) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        out += '"';
+    }
+
+    // Text for an INTEGER column under its format; empty for an unset time
+    static std::string_view formatted(const ColumnFormat& format, sqlite3_int64 value, char* scratch) {
+        if (format.label) return format.label(static_cast<int>(value));
+        return std::string_view(scratch, formatTimestamp(static_cast<EpochMillis>(value), scratch));
+    }
+
+    static void writeJsonValue(json::Writer& writer, sqlite3_stmt* row, int i, const ColumnFormat* format) {
+        char scratch[kTimestampLength];
+        switch (sqlite3_column_type(row, i)) {
+            case SQLITE_INTEGER: {
+                sqlite3_int64 value = sqlite3_column_int64(row, i);
+                if (!format) {
+                    writer.value(static_cast<long long>(value));
+                } else if (std::string_view text = formatted(*format, value, scratch); !text.empty()) {
+                    writer.value(text);
+                } else {
+                    writer.null();
+                }
+                break;
+            }
+            case SQLITE_FLOAT:
+                writer.value(sqlite3_column_double(row, i));
+                break;
+            case SQLITE_TEXT:
+                writer.value(std::string_view(reinterpret_cast<const char*>(sqlite3_column_text(row, i)),
+                                              static_cast<std::size_t>(sqlite3_column_bytes(row, i))));
+                break;
+            default:  // NULL; no exported table has BLOB columns
+                writer.null();
+        }
+    }
+
+    static void appendCsvValue(std::string& out, sqlite3_stmt* row, int i, const ColumnFormat* format) {
+        char scratch[kTimestampLength];
+        switch (sqlite3_column_type(row, i)) {
+            case SQLITE_INTEGER: {
+                sqlite3_int64 value = sqlite3_column_int64(row, i);
+                if (format) {
+                    appendCsv(out, formatted(*format, value, scratch));
+                } else {
+                    out += std::to_string(value);
+                }
+                break;
+            }
+            case SQLITE_FLOAT:
+                // Numbers as json::Writer writes them
+                json::Writer(out).value(sqlite3_column_double(row, i));
+                break;
+            case SQLITE_TEXT:
+                appendCsv(out, std::string_view(reinterpret_cast<const char*>(sqlite3_column_text(row, i)),
+                                                static_cast<std::size_t>(sqlite3_column_bytes(row, i))));
+                break;
+            default:
+                break;
+        }
+    }
+
+public:
+    static bool exportable(std::string_view table) { return find(table) != nullptr; }
+
+    // Writes every row of table to out, one JSON object per line or a CSV
+    // header and records. False if the table is not exportable or reading
+    // failed part way; what was written stays written.
+    bool exportTable(std::string_view name, Format format, std::ostream& out) {
+        const Table* table = find(name);
+        if (!table) return false;
+        static metrics::Counter& rows = metrics::Registry::instance().counter(
+            "export_rows_total", "Rows written by table exports");
+        metrics::ScopedTimer timer(metrics::dbStatement("export." + std::string(table->name)));
+
+        DatabaseManager* dbManager = DatabaseManager::getInstance();
+        try {
+            std::unique_ptr<Session> own = dbManager->openSession();
+            if (own) *own << "PRAGMA query_only = ON", now;
+            Session& session = own ? *own : dbManager->getSession();
+            sqlite3* db = Poco::Data::SQLite::Utility::dbHandle(session);
+
+            Cursor cursor;
+            std::string sql = "SELECT * FROM " + std::string(table->name) + " ORDER BY id";
+            if (sqlite3_prepare_v2(db, sql.c_str(), -1, &cursor.statement, nullptr) != SQLITE_OK) {
+                LOG_ERROR("Error exporting " << table->name << ": " << sqlite3_errmsg(db));
+                return false;
+            }
+
+            int count = sqlite3_column_count(cursor.statement);
+            std::vector<std::string> names(static_cast<std::size_t>(count));
+            std::vector<const ColumnFormat*> formats(static_cast<std::size_t>(count), nullptr);
+            for (int i = 0; i < count; ++i) {
+                names[i] = sqlite3_column_name(cursor.statement, i);
+                for (const auto& column : table->columns) {
+                    if (column.column == names[i]) formats[i] = &column;
+                }
+            }
+
+            std::string buffer;
+            buffer.reserve(kFlushBytes + 4096);
+            if (format == Format::CSV) {
+                for (int i = 0; i < count; ++i) {
+                    if (i > 0) buffer += ',';
+                    appendCsv(buffer, names[i]);
+                }
+                buffer += "\r\n";
+            }
+
+            int rc;
+            std::size_t written = 0;
+            while ((rc = sqlite3_step(cursor.statement)) == SQLITE_ROW) {
+                if (format == Format::NDJSON) {
+                    json::Writer writer(buffer);
+                    writer.beginObject();
+                    for (int i = 0; i < count; ++i) {
+                        writer.key(names[i]);
+                        writeJsonValue(writer, cursor.statement, i, formats[i]);
+                    }
+                    writer.endObject();
+                    buffer += '\n';
+                } else {
+                    for (int i = 0; i < count; ++i) {
+                        if (i > 0) buffer += ',';
+                        appendCsvValue(buffer, cursor.statement, i, formats[i]);
+                    }
+                    buffer += "\r\n";
+                }
+                ++written;
+                if (buffer.size() >= kFlushBytes) {
+                    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    buffer.clear();
+                    // The client went away; stop reading
+                    if (!out) break;
+                }
+            }
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            rows.inc(written);
+            if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+                LOG_ERROR("Error exporting " << table->name << ": " << sqlite3_errmsg(db));
+                return false;
+            }
+            return static_cast<bool>(out);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error exporting " << table->name << ": " << e.what());
+            return false;
+        }
+    }
+};
@@ -4,7 +4,9 @@
 #include <vector>
 #include <Poco/JSON/Object.h>
 #include "../models/GovernmentAgency.h"
+#include "../models/Timestamp.h"
 #include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
 #include <Poco/JSON/Array.h>
 
 using namespace Poco::Data::Keywords;
@@ -41,7 +43,7 @@ public:
             
             return agency.save();
         } catch (const std::exception& e) {
-            std::cerr << "Error registering government agency: " << e.what() << std::endl;
+            LOG_ERROR("Error registering government agency: " << e.what());
             return false;
         }
     }
@@ -127,7 +129,7 @@ public:
                 use(statusCopy), use(agencyId), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error updating agency status: " << e.what() << std::endl;
+            LOG_ERROR("Error updating agency status: " << e.what());
             return false;
         }
     }
@@ -136,18 +138,25 @@ public:
         auto session = dbManager->getSession();
         
         try {
-            std::string level = json->getValue<std::string>("level");
+            EmergencyLevel level;
+            if (!parseEnum(json->getValue<std::string>("level"), level)) {
+                return false;
+            }
+            int levelCode = enumCode(level);
             std::string description = json->getValue<std::string>("description");
             
+            Poco::Int64 triggeredAt = nowMillis();
+            
             Poco::Data::Statement insert(session);
-            insert << "INSERT INTO emergency_protocols (level, description, triggered_at) VALUES (?, ?, NOW())",
-                use(level),
+            insert << "INSERT INTO emergency_protocols (level, description, triggered_at) VALUES (?, ?, ?)",
+                use(levelCode),
                 use(description),
+                use(triggeredAt),
                 now;
             
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error triggering emergency protocol: " << e.what() << std::endl;
+            LOG_ERROR("Error triggering emergency protocol: " << e.what());
             return false;
         }
     }
@@ -160,8 +169,10 @@ public:
             // Get active operations
             Poco::Data::Statement select(session);
             std::vector<std::string> operations;
-            select << "SELECT name, location, status, resources_deployed, personnel_deployed FROM relief_operations WHERE status = 'active'",
+            int active = enumCode(OperationStatus::Active);
+            select << "SELECT name FROM relief_operations WHERE status = ?",
                 into(operations),
+                use(active),
                 now;
             
             Poco::JSON::Array operationsArray;
@@ -178,17 +189,18 @@ public:
             metrics << "SELECT COUNT(*) as active_ops, "
                    "COALESCE(SUM(resources_deployed), 0) as resources, "
                    "COALESCE(SUM(personnel_deployed), 0) as personnel "
-                   "FROM relief_operations WHERE status = 'active'",
+                   "FROM relief_operations WHERE status = ?",
                 into(activeOps),
                 into(resources),
                 into(personnel),
+                use(active),
                 now;
             
             result.set("active_operations", activeOps);
             result.set("resources_deployed", resources);
             result.set("personnel_deployed", personnel);
         } catch (const std::exception& e) {
-            std::cerr << "Error tracking relief effort: " << e.what() << std::endl;
+            LOG_ERROR("Error tracking relief effort: " << e.what());
         }
         
         return result;
@@ -206,19 +218,24 @@ public:
             // First, get the active relief operation for this location
             Poco::Data::Statement select(session);
             int operationId = 0;
-            select << "SELECT id FROM relief_operations WHERE location = ? AND status = 'active' LIMIT 1",
+            int active = enumCode(OperationStatus::Active);
+            select << "SELECT id FROM relief_operations WHERE location = ? AND status = ? LIMIT 1",
                 into(operationId),
                 use(location),
+                use(active),
                 now;
             
             if (operationId == 0) {
                 // Create a new relief operation if none exists
                 std::string operationName = type + " Operation";
+                Poco::Int64 startedAt = nowMillis();
                 Poco::Data::Statement insertOp(session);
                 insertOp << "INSERT INTO relief_operations (name, location, status, started_at) "
-                        "VALUES (?, ?, 'active', CURRENT_TIMESTAMP)",
+                        "VALUES (?, ?, ?, ?)",
                     use(operationName),
                     use(location),
+                    use(active),
+                    use(startedAt),
                     now;
                 
                 // Get the new operation ID
@@ -228,19 +245,23 @@ public:
             }
             
             // Now insert the personnel allocation
+            int pending = enumCode(OperationStatus::Pending);
+            Poco::Int64 allocatedAt = nowMillis();
             Poco::Data::Statement insert(session);
             insert << "INSERT INTO personnel_allocations (type, location, count, priority, operation_id, allocated_at, status) "
-                   "VALUES (?, ?, ?, ?, ?, CURRENT_TIMESTAMP, 'pending')",
+                   "VALUES (?, ?, ?, ?, ?, ?, ?)",
                 use(type),
                 use(location),
                 use(count),
                 use(priority),
                 use(operationId),
+                use(allocatedAt),
+                use(pending),
                 now;
             
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error allocating personnel: " << e.what() << std::endl;
+            LOG_ERROR("Error allocating personnel: " << e.what());
             return false;
         }
     }
@@ -254,7 +275,7 @@ public:
             select << "SELECT pa.type, pa.location, pa.count, pa.priority, pa.status, ro.name as operation_name "
                    "FROM personnel_allocations pa "
                    "LEFT JOIN relief_operations ro ON pa.operation_id = ro.id "
-                   "WHERE pa.status != 'completed'";
+                   "WHERE pa.status != " << enumCode(OperationStatus::Completed);
             
             select.execute();
             Poco::Data::RecordSet rs(select);
@@ -267,14 +288,14 @@ public:
                 allocation.set("location", rs[1].convert<std::string>());
                 allocation.set("count", rs[2].convert<int>());
                 allocation.set("priority", rs[3].convert<int>());
-                allocation.set("status", rs[4].convert<std::string>());
+                allocation.set("status", enumName(enumFromCode<OperationStatus>(rs[4].convert<int>())));
                 allocation.set("operation", rs[5].convert<std::string>());
                 allocationsArray.add(allocation);
                 more = rs.moveNext();
             }
             result.set("allocations", allocationsArray);
         } catch (const std::exception& e) {
-            std::cerr << "Error getting personnel status: " << e.what() << std::endl;
+            LOG_ERROR("Error getting personnel status: " << e.what());
         }
         
         return result;
@@ -292,18 +313,21 @@ public:
             // First, get the active relief operation for this location
             Poco::Data::Statement select(session);
             int operationId = 0;
-            select << "SELECT id FROM relief_operations WHERE location = ? AND status = 'active' LIMIT 1",
+            int active = enumCode(OperationStatus::Active);
+            select << "SELECT id FROM relief_operations WHERE location = ? AND status = ? LIMIT 1",
                 into(operationId),
                 use(location),
+                use(active),
                 now;
             
             if (operationId == 0) {
                 // Create a new relief operation if none exists
                 std::string operationName = category + " Operation";
                 Poco::Data::Statement insertOp(session);
-                insertOp << "INSERT INTO relief_operations (name, location, status) VALUES (?, ?, 'active')",
+                insertOp << "INSERT INTO relief_operations (name, location, status) VALUES (?, ?, ?)",
                     use(operationName),
                     use(location),
+                    use(active),
                     now;
                 
                 // Get the new operation ID
@@ -313,18 +337,22 @@ public:
             }
             
             // Now insert the emergency budget
+            int available = enumCode(OperationStatus::Available);
+            Poco::Int64 createdAt = nowMillis();
             Poco::Data::Statement insert(session);
             insert << "INSERT INTO emergency_budgets (category, amount, priority, operation_id, created_at, status) "
-                   "VALUES (?, ?, ?, ?, CURRENT_TIMESTAMP, 'available')",
+                   "VALUES (?, ?, ?, ?, ?, ?)",
                 use(category),
                 use(amount),
                 use(priority),
                 use(operationId),
+                use(createdAt),
+                use(available),
                 now;
             
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error creating emergency budget: " << e.what() << std::endl;
+            LOG_ERROR("Error creating emergency budget: " << e.what());
             return false;
         }
     }
@@ -338,7 +366,7 @@ public:
             select << "SELECT eb.category, eb.amount, eb.priority, eb.status, ro.location, ro.name as operation_name "
                    "FROM emergency_budgets eb "
                    "LEFT JOIN relief_operations ro ON eb.operation_id = ro.id "
-                   "WHERE eb.status != 'allocated'";
+                   "WHERE eb.status != " << enumCode(OperationStatus::Allocated);
             
             select.execute();
             Poco::Data::RecordSet rs(select);
@@ -350,7 +378,7 @@ public:
                 budget.set("category", rs[0].convert<std::string>());
                 budget.set("amount", rs[1].convert<double>());
                 budget.set("priority", rs[2].convert<int>());
-                budget.set("status", rs[3].convert<std::string>());
+                budget.set("status", enumName(enumFromCode<OperationStatus>(rs[3].convert<int>())));
                 budget.set("location", rs[4].convert<std::string>());
                 budget.set("operation", rs[5].convert<std::string>());
                 budgetsArray.add(budget);
@@ -358,7 +386,7 @@ public:
             }
             result.set("budgets", budgetsArray);
         } catch (const std::exception& e) {
-            std::cerr << "Error getting budget status: " << e.what() << std::endl;
+            LOG_ERROR("Error getting budget status: " << e.what());
         }
         
         return result;
@@ -376,18 +404,21 @@ public:
             // First, get the active relief operation for this location
             Poco::Data::Statement select(session);
             int operationId = 0;
-            select << "SELECT id FROM relief_operations WHERE location = ? AND status = 'active' LIMIT 1",
+            int active = enumCode(OperationStatus::Active);
+            select << "SELECT id FROM relief_operations WHERE location = ? AND status = ? LIMIT 1",
                 into(operationId),
                 use(location),
+                use(active),
                 now;
             
             if (operationId == 0) {
                 // Create a new relief operation if none exists
                 std::string operationName = type + " Operation";
                 Poco::Data::Statement insertOp(session);
-                insertOp << "INSERT INTO relief_operations (name, location, status) VALUES (?, ?, 'active')",
+                insertOp << "INSERT INTO relief_operations (name, location, status) VALUES (?, ?, ?)",
                     use(operationName),
                     use(location),
+                    use(active),
                     now;
                 
                 // Get the new operation ID
@@ -397,19 +428,21 @@ public:
             }
             
             // Now insert the military support request
+            Poco::Int64 requestedAt = nowMillis();
             Poco::Data::Statement insert(session);
             insert << "INSERT INTO military_support (type, location, priority, description, operation_id, requested_at) "
-                   "VALUES (?, ?, ?, ?, ?, NOW())",
+                   "VALUES (?, ?, ?, ?, ?, ?)",
                 use(type),
                 use(location),
                 use(priority),
                 use(description),
                 use(operationId),
+                use(requestedAt),
                 now;
             
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error calling military support: " << e.what() << std::endl;
+            LOG_ERROR("Error calling military support: " << e.what());
             return false;
         }
     }
@@ -421,8 +454,10 @@ public:
         try {
             Poco::Data::Statement select(session);
             std::vector<std::string> requests;
-            select << "SELECT type, location, priority, description, status FROM military_support WHERE status != 'completed'",
+            int completed = enumCode(OperationStatus::Completed);
+            select << "SELECT type FROM military_support WHERE status != ?",
                 into(requests),
+                use(completed),
                 now;
             
             Poco::JSON::Array requestsArray;
@@ -433,7 +468,7 @@ public:
             }
             result.set("requests", requestsArray);
         } catch (const std::exception& e) {
-            std::cerr << "Error getting military status: " << e.what() << std::endl;
+            LOG_ERROR("Error getting military status: " << e.what());
         }
         
         return result;
@@ -445,22 +480,23 @@ public:
         
         try {
             Poco::Data::Statement select(session);
-            std::string level;
+            int level = -1;
             std::string description;
+            int active = enumCode(OperationStatus::Active);
             
-            select << "SELECT level, description FROM emergency_protocols WHERE status = 'active' ORDER BY triggered_at DESC LIMIT 1",
-                into(level), into(description), now;
+            select << "SELECT level, description FROM emergency_protocols WHERE status = ? ORDER BY triggered_at DESC LIMIT 1",
+                into(level), into(description), use(active), now;
             
-            if (!level.empty()) {
-                result.set("level", level);
+            if (level >= 0) {
+                result.set("level", enumName(enumFromCode<EmergencyLevel>(level)));
                 result.set("description", description);
             } else {
-                result.set("level", "normal");
+                result.set("level", enumName(EmergencyLevel::Normal));
                 result.set("description", "No active emergency protocols");
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error getting emergency level: " << e.what() << std::endl;
-            result.set("level", "normal");
+            LOG_ERROR("Error getting emergency level: " << e.what());
+            result.set("level", enumName(EmergencyLevel::Normal));
             result.set("description", "Error retrieving emergency level");
         }
         
@@ -6,6 +6,7 @@
 #include "../models/HelpRequest.h"
 #include "../models/PeopleInCrisis.h"
 #include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
 
 // Controller for HelpRequest
 class HelpRequestController {
@@ -17,42 +18,36 @@ public:
     bool createRequest(const Poco::JSON::Object::Ptr& data) {
         try {
             int requesterId = data->getValue<int>("requesterId");
-            std::string type = data->getValue<std::string>("type");
+            HelpType type = parseEnumOr(data->getValue<std::string>("type"), HelpType::Other);
             std::string description = data->getValue<std::string>("description");
             std::string location = data->getValue<std::string>("location");
             int urgency = data->getValue<int>("urgency");
             
-            // Create new request
-            HelpRequest request;
-            request.setRequesterId(requesterId);
-            request.setType(type);
-            request.setDescription(description);
-            request.setLocation(location);
-            request.setUrgency(urgency);
-            request.setStatus("Pending");
-            
-            // Save the request
-            bool success = request.save();
-            
-            // Update the person's status
-            if (success) {
-                PeopleInCrisis person = PeopleInCrisis::findById(requesterId);
-                if (person.getId() != 0) {
-                    person.setHasActiveRequest(true);
-                    person.save();
-                }
-            }
-            
-            return success;
+            return create(requesterId, type, description, location, urgency);
         } catch (const std::exception& e) {
-            std::cerr << "Error creating help request: " << e.what() << std::endl;
+            LOG_ERROR("Error creating help request: " << e.what());
+            return false;
+        }
+    }
+
+    // Same, from a request decoded from the body (json::Decoder has checked the required fields)
+    bool createRequest(const HelpRequest& details) {
+        try {
+            return create(details.getRequesterId(), details.getType(), details.getDescription(),
+                          details.getLocation(), details.getUrgency());
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error creating help request: " << e.what());
             return false;
         }
     }
     
     // Update a help request status
-    bool updateStatus(int requestId, const std::string& status) {
+    bool updateStatus(int requestId, const std::string& statusName) {
         try {
+            RequestStatus status;
+            if (!parseEnum(statusName, status)) {
+                return false;
+            }
             HelpRequest request = HelpRequest::findById(requestId);
             if (request.getId() == 0) {
                 return false;
@@ -62,7 +57,7 @@ public:
             bool success = request.save();
             
             // If status is "Resolved" or "Cancelled", update the person's status
-            if (success && (status == "Resolved" || status == "Cancelled")) {
+            if (success && (status == RequestStatus::Resolved || status == RequestStatus::Cancelled)) {
                 PeopleInCrisis person = PeopleInCrisis::findById(request.getRequesterId());
                 if (person.getId() != 0) {
                     person.setHasActiveRequest(false);
@@ -72,7 +67,7 @@ public:
             
             return success;
         } catch (const std::exception& e) {
-            std::cerr << "Error updating help request status: " << e.what() << std::endl;
+            LOG_ERROR("Error updating help request status: " << e.what());
             return false;
         }
     }
@@ -82,6 +77,11 @@ public:
         return HelpRequest::findAll();
     }
     
+    // Get help requests created in [from, to), epoch milliseconds
+    std::vector<HelpRequest> getRequestsBetween(EpochMillis from, EpochMillis to) {
+        return HelpRequest::findBetween(from, to);
+    }
+    
     // Get help requests by requester ID
     std::vector<HelpRequest> getRequestsByRequesterId(int requesterId) {
         return HelpRequest::findByRequesterId(requesterId);
@@ -96,4 +96,31 @@ public:
     bool deleteRequest(int requestId) {
         return HelpRequest::remove(requestId);
     }
+
+private:
+    bool create(int requesterId, HelpType type, const std::string& description, const std::string& location,
+                int urgency) {
+        // Create new request
+        HelpRequest request;
+        request.setRequesterId(requesterId);
+        request.setType(type);
+        request.setDescription(description);
+        request.setLocation(location);
+        request.setUrgency(urgency);
+        request.setStatus(RequestStatus::Pending);
+        
+        // Save the request
+        bool success = request.save();
+        
+        // Update the person's status
+        if (success) {
+            PeopleInCrisis person = PeopleInCrisis::findById(requesterId);
+            if (person.getId() != 0) {
+                person.setHasActiveRequest(true);
+                person.save();
+            }
+        }
+        
+        return success;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <Poco/Data/Session.h>
+#include <Poco/Data/Statement.h>
+#include "../api/Arena.h"
+#include "../api/Csv.h"
+#include "../api/JsonDecode.h"
+#include "../database/DatabaseManager.h"
+#include "../models/FieldMapping.h"
+#include "../models/HelpRequest.h"
+#include "../models/PeopleInCrisis.h"
+#include "../metrics/Metrics.h"
+#include "../security/PasswordHasher.h"
+#include "../logging/Logger.h"
+
+// Outcome of one import: row counts, and the first errors by input line
+struct ImportReport {
+    static constexpr std::size_t kMaxErrors = 1000;
+
+    std::size_t rows = 0;
+    std::size_t inserted = 0;
+    std::size_t duplicates = 0;
+    std::size_t failed = 0;
+    std::vector<std::pair<std::size_t, std::string>> errors;
+    bool errorsTruncated = false;
+    std::string fatal;  // why the import stopped early, if it did
+
+    void error(std::size_t line, std::string message) {
+        ++failed;
+        if (errors.size() < kMaxErrors) {
+            errors.emplace_back(line, std::move(message));
+        } else {
+            errorsTruncated = true;
+        }
+    }
+};
+
+// What differs between importable entities. Each one names itself in the
+// URL, says which rows count as the same record, readies a decoded row for
+// insertion, and keeps a Store: statements prepared once per import that
+// look for rows already stored and write what an insert implies elsewhere.
+template <typename Model>
+struct ImportTraits;
+
+template <>
+struct ImportTraits<HelpRequest> {
+    static constexpr std::string_view entity = "help-requests";
+
+    // The same requester asking the same thing at the same time
+    static std::string key(const HelpRequest& request) {
+        return std::to_string(request.getRequesterId()) + '\x1f' + std::to_string(request.getTimestamp()) + '\x1f' +
+               std::to_string(enumCode(request.getType())) + '\x1f' + std::to_string(request.getUrgency()) + '\x1f' +
+               request.getLocation() + '\x1f' + request.getDescription();
+    }
+
+    static bool prepare(HelpRequest& request, std::string&) {
+        if (request.getTimestamp() == kNoTimestamp) request.setTimestamp(nowMillis());
+        return true;
+    }
+
+    static void hashPasswords(std::vector<std::pair<std::size_t, HelpRequest>>&) {}
+
+    class Store {
+    private:
+        Poco::Data::Statement existing;
+        Poco::Data::Statement markActive;
+        EpochMillis timestamp = 0;
+        int requesterId = 0;
+        std::string description;
+        Poco::Int64 count = 0;
+        int personId = 0;
+        std::set<int> requesters;
+
+    public:
+        explicit Store(Poco::Data::Session& session) : existing(session), markActive(session) {
+            existing << "SELECT COUNT(*) FROM help_requests WHERE timestamp = ? AND requester_id = ? AND description = ?",
+                use(timestamp), use(requesterId), use(description), into(count);
+            markActive << "UPDATE people_in_crisis SET has_active_request = 1 WHERE id = ?", use(personId);
+        }
+
+        // Only a row that carries its own timestamp can repeat an earlier import
+        bool exists(const HelpRequest& request) {
+            if (request.getTimestamp() == kNoTimestamp) return false;
+            timestamp = request.getTimestamp();
+            requesterId = request.getRequesterId();
+            description = request.getDescription();
+            count = 0;
+            existing.execute();
+            return count > 0;
+        }
+
+        void inserted(const HelpRequest& request) { requesters.insert(request.getRequesterId()); }
+
+        // Requesters now have an open request, as after HelpRequestController::create()
+        void flush() {
+            for (int id : requesters) {
+                personId = id;
+                markActive.execute();
+            }
+            requesters.clear();
+        }
+    };
+};
+
+template <>
+struct ImportTraits<PeopleInCrisis> {
+    static constexpr std::string_view entity = "people-in-crisis";
+
+    static std::string key(const PeopleInCrisis& person) { return person.getUsername(); }
+
+    static bool prepare(PeopleInCrisis& person, std::string& error) {
+        if (person.getPassword().empty()) {
+            error = "missing field 'password'";
+            return false;
+        }
+        return true;
+    }
+
+    // Passwords are only ever stored hashed; rows exported with their hashes
+    // keep them. A batch's plaintext passwords are hashed in parallel on the
+    // hashing pool, behind any waiting login, before its transaction opens.
+    static void hashPasswords(std::vector<std::pair<std::size_t, PeopleInCrisis>>& batch) {
+        std::vector<PeopleInCrisis*> people;
+        std::vector<std::string> passwords;
+        for (auto& entry : batch) {
+            if (PasswordHasher::isHashed(entry.second.getPassword())) continue;
+            people.push_back(&entry.second);
+            passwords.push_back(entry.second.getPassword());
+        }
+        PasswordHasher::instance().hashAll(passwords);
+        for (std::size_t i = 0; i < people.size(); ++i) people[i]->setPassword(passwords[i]);
+    }
+
+    class Store {
+    private:
+        Poco::Data::Statement existing;
+        Poco::Data::Statement verification;
+        std::string username;
+        Poco::Int64 count = 0;
+        std::string userType = "people_in_crisis";
+        int userId = 0;
+        Poco::Int64 createdAt = 0;
+
+    public:
+        explicit Store(Poco::Data::Session& session) : existing(session), verification(session) {
+            existing << "SELECT COUNT(*) FROM people_in_crisis WHERE username = ?", use(username), into(count);
+            verification << "INSERT INTO account_verifications (user_type, user_id, status, created_at) "
+                            "VALUES (?, ?, 'pending', ?)",
+                use(userType), use(userId), use(createdAt);
+        }
+
+        bool exists(const PeopleInCrisis& person) {
+            username = person.getUsername();
+            count = 0;
+            existing.execute();
+            return count > 0;
+        }
+
+        // Imported accounts start unverified, like sign-ups. The credential
+        // cache is left alone: it loads these accounts on first login.
+        void inserted(const PeopleInCrisis& person) {
+            userId = person.getId();
+            createdAt = nowMillis();
+            verification.execute();
+        }
+
+        void flush() {}
+    };
+};
+
+// Bulk import of NDJSON (one object per line) or CSV (a header row naming
+// fields by JSON or column name, then one record per row).
+//
+// Input is read in chunks and parsed a record at a time, so memory stays
+// bounded by the batch and kMaxSeen key hashes, not the upload. Rows are
+// decoded under the same rules as the single-record endpoints (CSV cells
+// through fields::setFromText), checked for duplicates within the upload and
+// against stored rows, prepared (passwords hashed on the hashing pool) a
+// batch at a time outside any transaction, and
+// then inserted through one prepared statement in a transaction per batch of
+// kBatchSize rows. Keys in the input are ignored. A bad row is reported with its line
+// and skipped; only unreadable CSV framing stops an import.
+class ImportController {
+public:
+    enum class Format { NDJSON, CSV };
+
+private:
+    static constexpr std::size_t kBatchSize = 5000;
+    static constexpr std::size_t kMaxRecord = 1 << 20;
+    // Duplicate keys remembered per upload; past this only stored rows are checked
+    static constexpr std::size_t kMaxSeen = 1 << 20;
+
+    DatabaseManager* dbManager;
+
+    static metrics::Counter& rowCounter(std::string_view entity, const char* result) {
+        return metrics::Registry::instance().counter("import_rows_total", "Imported rows by entity and result",
+                                                     metrics::labels({{"entity", std::string(entity)},
+                                                                      {"result", result}}));
+    }
+
+    // Position of each field's column in the CSV header, or -1; false with
+    // the reason when the header cannot describe a row
+    template <typename Model>
+    static bool mapHeader(const std::vector<std::string_view>& header, std::vector<int>& columns,
+                          std::string& error) {
+        columns.assign(fieldCount<Model>(), -1);
+        for (std::size_t i = 0; i < header.size(); ++i) {
+            forEachField<Model>([&](const auto& field, auto f) {
+                if (header[i] != field.name && header[i] != field.column) return;
+                if (columns[decltype(f)::value] >= 0) {
+                    error = "duplicate column '" + std::string(header[i]) + "'";
+                }
+                columns[decltype(f)::value] = static_cast<int>(i);
+            });
+        }
+        forEachField<Model>([&](const auto& field, auto f) {
+            if (error.empty() && field.has(fields::Required) && columns[decltype(f)::value] < 0) {
+                error = "missing column '" + std::string(field.name) + "'";
+            }
+        });
+        return error.empty();
+    }
+
+    // Empty cells count as absent
+    template <typename Model>
+    static bool decodeCells(const std::vector<std::string_view>& cells, const std::vector<int>& columns, Model& model,
+                            std::string& error) {
+        forEachField<Model>([&](const auto& field, auto f) {
+            if (!error.empty() || field.has(fields::Key)) return;
+            int column = columns[decltype(f)::value];
+            std::string_view cell = column >= 0 ? cells[static_cast<std::size_t>(column)] : std::string_view();
+            if (cell.empty()) {
+                if (field.has(fields::Required)) error = "missing field '" + std::string(field.name) + "'";
+                return;
+            }
+            if (!fields::setFromText(model, field, cell)) {
+                error = "invalid value for field '" + std::string(field.name) + "'";
+            }
+        });
+        return error.empty();
+    }
+
+public:
+    ImportController() { dbManager = DatabaseManager::getInstance(); }
+
+    template <typename Model>
+    ImportReport importRows(std::istream& input, Format format) {
+        using Traits = ImportTraits<Model>;
+        static metrics::Histogram& batchLatency =
+            metrics::dbStatement("import." + std::string(ModelFields<Model>::table) + ".batch");
+
+        ImportReport report;
+        // Its own connection when there is one, so the import's transactions
+        // do not hold the shared one. An in-memory database has only the
+        // shared connection, and a transaction there would take in whatever
+        // other requests run on it meanwhile; rows then go in one autocommit
+        // statement each, which costs no fsync in memory.
+        std::unique_ptr<Poco::Data::Session> own = dbManager->openSession();
+        Poco::Data::Session& session = own ? *own : dbManager->getSession();
+        const bool transactions = own != nullptr;
+
+        csv::RecordStream records(input, format == Format::CSV, kMaxRecord);
+        Arena arena(256 * 1024);
+        json::Decoder decoder(arena);
+        std::vector<std::string_view> cells;
+        std::vector<int> columns;
+        std::size_t headerSize = 0;
+        std::unordered_set<std::size_t> seen;  // hashes of the keys in the upload so far
+        // Rows decoded and prepared, with their input lines, waiting to be written
+        std::vector<std::pair<std::size_t, Model>> batch;
+        batch.reserve(kBatchSize);
+        std::size_t pending = 0;
+        bool inTransaction = false;
+
+        try {
+            typename Traits::Store store(session);
+            fields::Row<Model> row;
+            std::unique_ptr<Poco::Data::Statement> insert;
+            auto prepareInsert = [&] {
+                insert = std::make_unique<Poco::Data::Statement>(session);
+                *insert << fields::insertSql<Model>();
+                row.bind(*insert, false);
+            };
+            prepareInsert();
+            Poco::Data::Statement lastId(session);
+            Poco::Int64 id = 0;
+            lastId << "SELECT last_insert_rowid()", into(id);
+
+            // Everything slow about a row (decoding, password hashing) is done
+            // before the transaction opens, so the write lock is held only for
+            // the inserts
+            auto write = [&] {
+                Traits::hashPasswords(batch);
+                metrics::ScopedTimer timer(batchLatency);
+                if (transactions) {
+                    session.begin();
+                    inTransaction = true;
+                }
+                for (auto& entry : batch) {
+                    Model& model = entry.second;
+                    try {
+                        row.assign(model);
+                        insert->execute();
+                        lastId.execute();
+                        fields::setKey(model, id);
+                        store.inserted(model);
+                        ++report.inserted;
+                        ++pending;
+                    } catch (const Poco::Exception& e) {
+                        // e.g. a UNIQUE column other than the deduplication key. SQLite
+                        // undoes just this statement; prepare it afresh all the same.
+                        report.error(entry.first, e.displayText());
+                        prepareInsert();
+                    }
+                }
+                store.flush();
+                if (transactions) session.commit();
+                inTransaction = false;
+                pending = 0;
+                batch.clear();
+                arena.reset();
+            };
+
+            std::string_view record;
+            bool header = format == Format::CSV;
+            while (true) {
+                csv::RecordStream::Result result = records.next(record);
+                if (result == csv::RecordStream::End) break;
+                if (result == csv::RecordStream::Malformed) {
+                    report.fatal = "line " + std::to_string(records.recordLine()) +
+                                   ": unterminated quoted field or record longer than " +
+                                   std::to_string(kMaxRecord) + " bytes";
+                    break;
+                }
+                if (header) {
+                    std::string error;
+                    const char* splitError = csv::split(record, cells, arena);
+                    if (splitError) error = splitError;
+                    if (!error.empty() || !mapHeader<Model>(cells, columns, error)) {
+                        report.fatal = "header: " + error;
+                        break;
+                    }
+                    headerSize = cells.size();
+                    header = false;
+                    continue;
+                }
+
+                ++report.rows;
+                std::size_t line = records.recordLine();
+                if (result == csv::RecordStream::TooLong) {
+                    report.error(line, "record longer than " + std::to_string(kMaxRecord) + " bytes");
+                    continue;
+                }
+
+                Model model;
+                std::string error;
+                if (format == Format::NDJSON) {
+                    if (!decoder.decode(record, model)) {
+                        error = std::string(decoder.error()) + " at offset " + std::to_string(decoder.errorOffset());
+                    }
+                } else if (const char* splitError = csv::split(record, cells, arena)) {
+                    error = splitError;
+                } else if (cells.size() != headerSize) {
+                    error = "expected " + std::to_string(headerSize) + " fields, found " + std::to_string(cells.size());
+                } else {
+                    decodeCells(cells, columns, model, error);
+                }
+                if (!error.empty()) {
+                    report.error(line, error);
+                    continue;
+                }
+                fields::setKey(model, 0);
+
+                std::size_t keyHash = std::hash<std::string>()(Traits::key(model));
+                bool repeated = seen.size() < kMaxSeen ? !seen.insert(keyHash).second : seen.count(keyHash) > 0;
+                if (repeated || store.exists(model)) {
+                    ++report.duplicates;
+                    continue;
+                }
+                if (!Traits::prepare(model, error)) {
+                    report.error(line, error);
+                    continue;
+                }
+
+                batch.emplace_back(line, std::move(model));
+                if (batch.size() == kBatchSize) write();
+            }
+            if (!batch.empty()) write();
+        } catch (const std::exception& e) {
+            if (inTransaction) {
+                session.rollback();
+                report.inserted -= pending;
+            }
+            LOG_ERROR("Error importing " << Traits::entity << ": " << e.what());
+            report.fatal = "import stopped after " + std::to_string(report.inserted) + " rows: " + e.what();
+        }
+
+        rowCounter(Traits::entity, "inserted").inc(report.inserted);
+        rowCounter(Traits::entity, "duplicate").inc(report.duplicates);
+        rowCounter(Traits::entity, "failed").inc(report.failed);
+        return report;
+    }
+
+    // Imports into the entity named in the URL; false if there is no such entity
+    bool importEntity(std::string_view entity, std::istream& input, Format format, ImportReport& report) {
+        if (entity == ImportTraits<HelpRequest>::entity) {
+            report = importRows<HelpRequest>(input, format);
+        } else if (entity == ImportTraits<PeopleInCrisis>::entity) {
+            report = importRows<PeopleInCrisis>(input, format);
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
@@ -5,6 +5,7 @@
 #include <Poco/JSON/Object.h>
 #include "../models/PeopleInCrisis.h"
 #include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
 
 // Controller for PeopleInCrisis
 class PeopleInCrisisController {
@@ -20,16 +21,27 @@ public:
     // Methods from class diagram
     bool signUp(const Poco::JSON::Object::Ptr& data) {
         try {
-            std::string name = data->getValue<std::string>("name");
-            std::string location = data->getValue<std::string>("location");
-            std::string phoneNo = data->getValue<std::string>("phoneNo");
-            std::string username = data->getValue<std::string>("username");
-            std::string password = data->getValue<std::string>("password");
+            PeopleInCrisis details;
+            details.setName(data->getValue<std::string>("name"));
+            details.setLocation(data->getValue<std::string>("location"));
+            details.setPhoneNo(data->getValue<std::string>("phoneNo"));
+            details.setUsername(data->getValue<std::string>("username"));
+            details.setPassword(data->getValue<std::string>("password"));
             
+            return signUp(details);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error signing up: " << e.what());
+            return false;
+        }
+    }
+    
+    // Same, from a person decoded from the request body; only the sign-up fields are used
+    bool signUp(const PeopleInCrisis& details) {
+        try {
             // Check if username already exists
             Session& session = dbManager->getSession();
             Poco::Int64 count = 0;
-            std::string usernameCopy = username;  // Create non-const copy
+            std::string usernameCopy = details.getUsername();
             session << "SELECT COUNT(*) FROM people_in_crisis WHERE username = ?", 
                 into(count), use(usernameCopy), now;
             
@@ -39,17 +51,17 @@ public:
             
             // Create new person
             PeopleInCrisis person;
-            person.setName(name);
-            person.setLocation(location);
-            person.setPhoneNo(phoneNo);
-            person.setUsername(username);
-            person.setPassword(password);
-            person.setStatus("Pending");
+            person.setName(details.getName());
+            person.setLocation(details.getLocation());
+            person.setPhoneNo(details.getPhoneNo());
+            person.setUsername(details.getUsername());
+            person.setPassword(details.getPassword());
+            person.setStatus(RequestStatus::Pending);
             person.setHasActiveRequest(false);
             
             return person.save();
         } catch (const std::exception& e) {
-            std::cerr << "Error signing up: " << e.what() << std::endl;
+            LOG_ERROR("Error signing up: " << e.what());
             return false;
         }
     }
@@ -64,12 +76,12 @@ public:
             person.setDescription(description);
             person.setLocation(location);
             person.setHasActiveRequest(true);
-            person.setStatus("Pending");
+            person.setStatus(RequestStatus::Pending);
             
             // Save the updated person
             return person.save();
         } catch (const std::exception& e) {
-            std::cerr << "Error entering help request: " << e.what() << std::endl;
+            LOG_ERROR("Error entering help request: " << e.what());
             return false;
         }
     }
@@ -107,12 +119,16 @@ public:
     }
     
     bool updateStatus(int id, const std::string& status) {
+        RequestStatus newStatus;
+        if (!parseEnum(status, newStatus)) {
+            return false;
+        }
         PeopleInCrisis person = PeopleInCrisis::findById(id);
         if (person.getId() == 0) {
             return false;
         }
         
-        person.updateStatus(status);
+        person.updateStatus(newStatus);
         return true;
     }
     
@@ -135,7 +151,7 @@ public:
                 return person;
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error getting profile: " << e.what() << std::endl;
+            LOG_ERROR("Error getting profile: " << e.what());
         }
         
         return person;
@@ -159,7 +175,7 @@ public:
             
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error updating profile: " << e.what() << std::endl;
+            LOG_ERROR("Error updating profile: " << e.what());
             return false;
         }
     }
@@ -4,7 +4,9 @@
 #include <vector>
 #include <Poco/JSON/Object.h>
 #include "../models/ReliefProvider.h"
+#include "../models/Timestamp.h"
 #include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
@@ -19,7 +21,7 @@ public:
     bool signUp(const Poco::JSON::Object::Ptr& data) {
         try {
             std::string name = data->getValue<std::string>("name");
-            std::string orgType = data->getValue<std::string>("orgType");
+            OrgType orgType = parseEnumOr(data->getValue<std::string>("orgType"), OrgType::Other);
             std::string location = data->getValue<std::string>("location");
             std::string username = data->getValue<std::string>("username");
             std::string password = data->getValue<std::string>("password");
@@ -44,7 +46,7 @@ public:
             
             return provider.save();
         } catch (const std::exception& e) {
-            std::cerr << "Error signing up relief provider: " << e.what() << std::endl;
+            LOG_ERROR("Error signing up relief provider: " << e.what());
             return false;
         }
     }
@@ -56,11 +58,12 @@ public:
             
             // Create a manpower request
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO manpower_requests (provider_id, status, timestamp) VALUES (?, 'Pending', datetime('now'))",
-                use(providerId), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO manpower_requests (provider_id, status, timestamp) VALUES (?, 'Pending', ?)",
+                use(providerId), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting manpower: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting manpower: " << e.what());
             return false;
         }
     }
@@ -72,11 +75,12 @@ public:
             
             // Create a government aid request
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO gov_aid_requests (provider_id, status, timestamp) VALUES (?, 'Pending', datetime('now'))",
-                use(providerId), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO gov_aid_requests (provider_id, status, timestamp) VALUES (?, 'Pending', ?)",
+                use(providerId), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting government aid: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting government aid: " << e.what());
             return false;
         }
     }
@@ -88,11 +92,12 @@ public:
             
             // Create an additional aid request
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO additional_aid_requests (provider_id, status, timestamp) VALUES (?, 'Pending', datetime('now'))",
-                use(providerId), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO additional_aid_requests (provider_id, status, timestamp) VALUES (?, 'Pending', ?)",
+                use(providerId), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting additional aid: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting additional aid: " << e.what());
             return false;
         }
     }
@@ -104,11 +109,12 @@ public:
             
             // Create a monetary service request
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO monetary_requests (provider_id, status, timestamp) VALUES (?, 'Pending', datetime('now'))",
-                use(providerId), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO monetary_requests (provider_id, status, timestamp) VALUES (?, 'Pending', ?)",
+                use(providerId), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting monetary service: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting monetary service: " << e.what());
             return false;
         }
     }
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <Poco/Nullable.h>
+#include <Poco/Data/Statement.h>
+#include "../database/DatabaseManager.h"
+#include "../models/Enums.h"
+#include "../models/Timestamp.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+
+// One description that matched a search
+struct SearchHit {
+    std::string source;    // table the row is in
+    int id = 0;
+    double rank = 0;       // bm25 within its table; lower is a better match
+    double score = 0;      // rank over its table's best rank: 1 for the best, less for worse
+    std::string snippet;   // matched terms wrapped in [ ]
+    std::string location;
+    std::string status;
+    EpochMillis timestamp = kNoTimestamp;
+};
+
+struct SearchQuery {
+    std::string text;
+    std::vector<std::string> sources;  // empty: all of them
+    std::string location;              // exact, ignoring case; empty: anywhere
+    std::string status;                // by name; empty: any
+    int limit = 20;
+    int offset = 0;
+};
+
+// Full-text search over the descriptions of help requests, people in crisis
+// and incident reports, through the FTS5 indexes DatabaseManager keeps in
+// step with those tables.
+//
+// User text is never passed to MATCH as it is: it is rewritten into quoted
+// terms, so FTS5 operators and punctuation cannot make the query invalid.
+// Every term must match; a term ending in * matches as a prefix and text in
+// double quotes as a phrase. Each table is searched for its best offset +
+// limit matches by rank. bm25 depends on each table's own term statistics,
+// so ranks from different tables are not comparable: each hit is scored
+// against its table's best match before the tables are merged.
+class SearchController {
+public:
+    static constexpr int kMaxLimit = 100;
+    static constexpr int kMaxOffset = 1000;
+    static constexpr std::size_t kMaxTerms = 16;
+
+private:
+    struct Source {
+        const char* name;
+        const char* from;          // FROM and joins; the base table is t
+        const char* location;      // location column
+        const char* timestamp;     // time column, or nullptr where the table has none
+        bool codedStatus;          // status holds RequestStatus codes rather than text
+    };
+
+    static const std::vector<Source>& sources() {
+        static const std::vector<Source> all = {
+            {"help_requests", "help_requests_fts JOIN help_requests t ON t.id = help_requests_fts.rowid",
+             "t.location", "t.timestamp", true},
+            {"people_in_crisis", "people_in_crisis_fts JOIN people_in_crisis t ON t.id = people_in_crisis_fts.rowid",
+             "t.location", nullptr, true},
+            // Incidents have no location of their own; use the reporting provider's
+            {"incident_reports",
+             "incident_reports_fts JOIN incident_reports t ON t.id = incident_reports_fts.rowid "
+             "LEFT JOIN relief_providers p ON p.id = t.provider_id",
+             "p.location", "t.timestamp", false},
+        };
+        return all;
+    }
+
+    static bool isWordByte(unsigned char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+    }
+
+    // Appends words as one quoted FTS5 string; the tokenizer splits it again
+    static void appendQuoted(std::string& out, std::string_view words, bool prefix) {
+        if (!out.empty()) out += ' ';
+        out += '"';
+        for (char c : words) {
+            if (c != '"') out += c;
+        }
+        out += '"';
+        if (prefix) out += '*';
+    }
+
+    // Searches one table; false if the query failed
+    static bool searchSource(const Source& source, const std::string& match, const SearchQuery& query,
+                             std::vector<SearchHit>& hits) {
+        std::string status;
+        if (!query.status.empty()) {
+            if (source.codedStatus) {
+                RequestStatus code;
+                if (!parseEnum(query.status, code)) return true;  // no row here can have it
+                status = std::to_string(enumCode(code));
+            } else {
+                status = query.status;
+            }
+        }
+        std::string fts = std::string(source.name) + "_fts";
+        std::string sql = std::string("SELECT t.id, ") + fts + ".rank, snippet(" + fts +
+                          ", 0, '[', ']', '...', 16), COALESCE(" + source.location + ", ''), " +
+                          "CAST(t.status AS TEXT), " + (source.timestamp ? source.timestamp : "NULL") +
+                          " FROM " + source.from + " WHERE " + fts + " MATCH ?";
+        if (!query.location.empty()) sql += std::string(" AND ") + source.location + " = ? COLLATE NOCASE";
+        if (!status.empty()) sql += source.codedStatus ? " AND t.status = ?" : " AND t.status = ? COLLATE NOCASE";
+        sql += " ORDER BY " + fts + ".rank LIMIT ?";
+
+        std::string matchCopy = match;
+        std::string location = query.location;
+        int rows = query.offset + query.limit;
+        std::vector<int> ids;
+        std::vector<double> scores;
+        std::vector<std::string> snippets;
+        std::vector<std::string> locations;
+        std::vector<std::string> statuses;
+        std::vector<Poco::Nullable<Poco::Int64>> times;
+
+        metrics::ScopedTimer timer(metrics::dbStatement("search." + std::string(source.name)));
+        try {
+            Session& session = DatabaseManager::getInstance()->getSession();
+            Statement select(session);
+            select << sql, use(matchCopy);
+            if (!location.empty()) select, use(location);
+            if (!status.empty()) select, use(status);
+            select, use(rows), into(ids), into(scores), into(snippets), into(locations), into(statuses), into(times);
+            select.execute();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error searching " << source.name << ": " << e.what());
+            return false;
+        }
+
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            SearchHit hit;
+            hit.source = source.name;
+            hit.id = ids[i];
+            hit.rank = scores[i];
+            // bm25 is negative, so this is in (0, 1]; a best rank of 0 makes every hit a 1
+            hit.score = scores[0] < 0 ? scores[i] / scores[0] : 1.0;
+            hit.snippet = std::move(snippets[i]);
+            hit.location = std::move(locations[i]);
+            hit.status = source.codedStatus
+                             ? enumName(enumFromCode<RequestStatus>(std::atoi(statuses[i].c_str())))
+                             : std::move(statuses[i]);
+            if (!times[i].isNull()) hit.timestamp = times[i].value();
+            hits.push_back(std::move(hit));
+        }
+        return true;
+    }
+
+public:
+    static bool searchable(std::string_view source) {
+        for (const auto& known : sources()) {
+            if (source == known.name) return true;
+        }
+        return false;
+    }
+
+    // FTS5 query for what a user typed: every word quoted, "..." kept as a
+    // phrase, a trailing * kept as a prefix; empty if it has no words
+    static std::string matchExpression(std::string_view text) {
+        std::string out;
+        std::size_t terms = 0;
+        std::size_t i = 0;
+        while (i < text.size() && terms < kMaxTerms) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c == '"') {
+                std::size_t close = text.find('"', i + 1);
+                if (close == std::string_view::npos) close = text.size();
+                std::string_view phrase = text.substr(i + 1, close - i - 1);
+                i = close + 1;
+                bool prefix = i < text.size() && text[i] == '*';
+                if (std::any_of(phrase.begin(), phrase.end(),
+                                [](char p) { return isWordByte(static_cast<unsigned char>(p)); })) {
+                    appendQuoted(out, phrase, prefix);
+                    ++terms;
+                }
+            } else if (isWordByte(c)) {
+                std::size_t start = i;
+                while (i < text.size() && isWordByte(static_cast<unsigned char>(text[i]))) ++i;
+                appendQuoted(out, text.substr(start, i - start), i < text.size() && text[i] == '*');
+                ++terms;
+            } else {
+                ++i;
+            }
+        }
+        return out;
+    }
+
+    // Best matches across the requested tables, best first; false if the
+    // index is missing or a query failed
+    bool search(const SearchQuery& query, std::vector<SearchHit>& hits) {
+        hits.clear();
+        if (!DatabaseManager::getInstance()->hasSearch()) return false;
+        std::string match = matchExpression(query.text);
+        if (match.empty()) return true;
+
+        SearchQuery bounded = query;
+        bounded.limit = std::max(1, std::min(kMaxLimit, query.limit));
+        bounded.offset = std::max(0, std::min(kMaxOffset, query.offset));
+
+        static metrics::Counter& searches = metrics::Registry::instance().counter(
+            "search_queries_total", "Full-text searches run");
+        searches.inc();
+
+        for (const auto& source : sources()) {
+            if (!query.sources.empty() &&
+                std::find(query.sources.begin(), query.sources.end(), source.name) == query.sources.end()) {
+                continue;
+            }
+            if (!searchSource(source, match, bounded, hits)) return false;
+        }
+
+        std::stable_sort(hits.begin(), hits.end(),
+                         [](const SearchHit& a, const SearchHit& b) { return a.score > b.score; });
+        std::size_t from = std::min(hits.size(), static_cast<std::size_t>(bounded.offset));
+        std::size_t to = std::min(hits.size(), from + static_cast<std::size_t>(bounded.limit));
+        hits = std::vector<SearchHit>(std::make_move_iterator(hits.begin() + from),
+                                      std::make_move_iterator(hits.begin() + to));
+        return true;
+    }
+};
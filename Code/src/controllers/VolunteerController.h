@@ -4,7 +4,9 @@
 #include <vector>
 #include <Poco/JSON/Object.h>
 #include "../models/Volunteer.h"
+#include "../models/Timestamp.h"
 #include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
@@ -19,15 +21,27 @@ public:
     bool signUp(const Poco::JSON::Object::Ptr& json) {
         try {
             // Extract user data
-            std::string name = json->getValue<std::string>("name");
-            std::string location = json->getValue<std::string>("location");
-            std::string username = json->getValue<std::string>("username");
-            std::string password = json->getValue<std::string>("password");
-            std::string orgType = json->getValue<std::string>("orgType");
+            Volunteer details;
+            details.setName(json->getValue<std::string>("name"));
+            details.setLocation(json->getValue<std::string>("location"));
+            details.setUsername(json->getValue<std::string>("username"));
+            details.setPassword(json->getValue<std::string>("password"));
+            details.setOrgType(parseEnumOr(json->getValue<std::string>("orgType"), OrgType::Other));
             
+            return signUp(details);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error signing up volunteer: " << e.what());
+            return false;
+        }
+    }
+    
+    // Same, from a volunteer decoded from the request body; only the sign-up fields are used
+    bool signUp(const Volunteer& details) {
+        try {
             // Check if username already exists
             Session& session = DatabaseManager::getInstance()->getSession();
             Poco::Int64 count = 0;
+            std::string username = details.getUsername();
             session << "SELECT COUNT(*) FROM volunteers WHERE username = ?", 
                 into(count), use(username), now;
             
@@ -37,11 +51,11 @@ public:
             
             // Create new volunteer
             Volunteer volunteer;
-            volunteer.setName(name);
-            volunteer.setLocation(location);
+            volunteer.setName(details.getName());
+            volunteer.setLocation(details.getLocation());
             volunteer.setUsername(username);
-            volunteer.setPassword(password);
-            volunteer.setOrgType(orgType);
+            volunteer.setPassword(details.getPassword());
+            volunteer.setOrgType(details.getOrgType());
             volunteer.setAvailability(true);
             
             if (volunteer.save()) {
@@ -49,13 +63,14 @@ public:
                 std::string userType = "volunteer";
                 int userId = volunteer.getUserID();
                 Poco::Data::Statement verifyInsert(session);
-                verifyInsert << "INSERT INTO account_verifications (user_type, user_id, status, created_at) VALUES (?, ?, 'pending', datetime('now'))",
-                    use(userType), use(userId), now;
+                Poco::Int64 createdAt = nowMillis();
+                verifyInsert << "INSERT INTO account_verifications (user_type, user_id, status, created_at) VALUES (?, ?, 'pending', ?)",
+                    use(userType), use(userId), use(createdAt), now;
                 return true;
             }
             return false;
         } catch (const std::exception& e) {
-            std::cerr << "Error signing up volunteer: " << e.what() << std::endl;
+            LOG_ERROR("Error signing up volunteer: " << e.what());
             return false;
         }
     }
@@ -65,17 +80,18 @@ public:
             // First check if volunteer exists
             Volunteer volunteer = Volunteer::findById(volunteerId);
             if (volunteer.getUserID() == 0) {
-                std::cerr << "Volunteer not found with ID: " << volunteerId << std::endl;
+                LOG_WARN("Volunteer not found with ID: " << volunteerId);
                 return false;
             }
             
             // Process the donation
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO donations (volunteer_id, amount, timestamp) VALUES (?, ?, datetime('now'))",
-                use(volunteerId), use(amount), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO donations (volunteer_id, amount, timestamp) VALUES (?, ?, ?)",
+                use(volunteerId), use(amount), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error processing donation: " << e.what() << std::endl;
+            LOG_ERROR("Error processing donation: " << e.what());
             return false;
         }
     }
@@ -84,11 +100,12 @@ public:
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             std::string descCopy = description;  // Create non-const copy
-            session << "INSERT INTO volunteer_help_requests (volunteer_id, description, timestamp) VALUES (?, ?, datetime('now'))",
-                use(volunteerId), use(descCopy), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO volunteer_help_requests (volunteer_id, description, timestamp) VALUES (?, ?, ?)",
+                use(volunteerId), use(descCopy), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error registering help request: " << e.what() << std::endl;
+            LOG_ERROR("Error registering help request: " << e.what());
             return false;
         }
     }
@@ -96,11 +113,12 @@ public:
     bool acceptRequest(int volunteerId, int requestId) {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO volunteer_assignments (volunteer_id, request_id, timestamp) VALUES (?, ?, datetime('now'))",
-                use(volunteerId), use(requestId), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO volunteer_assignments (volunteer_id, request_id, timestamp) VALUES (?, ?, ?)",
+                use(volunteerId), use(requestId), use(timestamp), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error accepting request: " << e.what() << std::endl;
+            LOG_ERROR("Error accepting request: " << e.what());
             return false;
         }
     }
@@ -120,7 +138,7 @@ public:
                 history.push_back(requestId);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error getting volunteer history: " << e.what() << std::endl;
+            LOG_ERROR("Error getting volunteer history: " << e.what());
         }
         return history;
     }
@@ -143,13 +161,13 @@ public:
         try {
         Volunteer volunteer = Volunteer::findById(id);
         if (volunteer.getUserID() == 0) {
-                std::cerr << "Volunteer not found with ID: " << id << std::endl;
+                LOG_WARN("Volunteer not found with ID: " << id);
                 return false;
             }
             volunteer.setAvailability(available);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error updating volunteer availability: " << e.what() << std::endl;
+            LOG_ERROR("Error updating volunteer availability: " << e.what());
             return false;
         }
     }
@@ -6,7 +6,23 @@
 #include <Poco/Data/Statement.h>
 #include <Poco/Data/RecordSet.h>
 #include <Poco/JSON/Object.h>
+#include <algorithm>
 #include <memory>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <sqlite3.h>
+#include <Poco/Data/SQLite/Utility.h>
+#include "QueryProfiler.h"
+#include "StatementDeadline.h"
+#include "../logging/Logger.h"
+#include "../models/Enums.h"
+#include "../security/AuditLog.h"
+#include "../security/PasswordHash.h"
+#include "../security/TokenHash.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
@@ -16,7 +32,9 @@ using Poco::Data::Statement;
 class DatabaseManager {
 private:
     static DatabaseManager* instance;
+    static std::string databasePath;
     std::unique_ptr<Session> session;
+    bool searchAvailable = false;
     
     // Private constructor for singleton
     DatabaseManager(){
@@ -24,12 +42,27 @@ private:
         Poco::Data::SQLite::Connector::registerConnector();
         
         // Create session
-        session = std::make_unique<Session>("SQLite", "crisis_management.db");
+        session = std::make_unique<Session>("SQLite", databasePath);
+
+        // WAL lets readers in other processes proceed during a write; SQLite's
+        // write lock still admits one writer at a time, so wait for it instead of failing
+        *session << "PRAGMA journal_mode=WAL", now;
+        sqlite3_busy_timeout(Poco::Data::SQLite::Utility::dbHandle(*session), 5000);
+
+        // Time every statement executed on this connection, and stop those
+        // outliving their request's deadline
+        QueryProfiler::instance().attach(*session);
+        StatementDeadline::install(Poco::Data::SQLite::Utility::dbHandle(*session));
         
         // Initialize database
         initDatabase();
+        migrate();
+        createSearchIndexes();
     }
     
+    // Default for time columns: now, in epoch milliseconds (models/Timestamp.h)
+    static constexpr const char* kNowMillis = "(CAST(round((julianday('now') - 2440587.5) * 86400000) AS INTEGER))";
+
     // Initialize database tables
     void initDatabase() {
         // Create tables if they don't exist
@@ -42,7 +75,7 @@ private:
                 << "location TEXT, "
                 << "phone_no TEXT, "
                 << "description TEXT, "
-                << "status TEXT DEFAULT 'Pending', "
+                << "status INTEGER DEFAULT " << enumCode(RequestStatus::Pending) << ", "
                 << "has_active_request INTEGER DEFAULT 0, "
                 << "username TEXT UNIQUE, "
                 << "password TEXT, "
@@ -58,7 +91,7 @@ private:
                 << "available INTEGER DEFAULT 1, "
                 << "username TEXT UNIQUE, "
                 << "password TEXT, "
-                << "org_type TEXT, "
+                << "org_type INTEGER DEFAULT " << enumCode(OrgType::Other) << ", "
                 << "verified INTEGER DEFAULT 0"
                 << ")", now;
         
@@ -77,7 +110,7 @@ private:
         *session << "CREATE TABLE IF NOT EXISTS relief_providers ("
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "name TEXT NOT NULL, "
-                << "org_type TEXT, "
+                << "org_type INTEGER DEFAULT " << enumCode(OrgType::Other) << ", "
                 << "location TEXT, "
                 << "username TEXT UNIQUE, "
                 << "password TEXT, "
@@ -99,7 +132,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "provider_id INTEGER, "
                 << "description TEXT, "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "status TEXT DEFAULT 'active', "
                 << "FOREIGN KEY (provider_id) REFERENCES relief_providers (id)"
                 << ")", now;
@@ -109,7 +142,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "provider_id INTEGER, "
                 << "status TEXT DEFAULT 'Pending', "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "FOREIGN KEY (provider_id) REFERENCES relief_providers (id)"
                 << ")", now;
         
@@ -118,7 +151,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "provider_id INTEGER, "
                 << "status TEXT DEFAULT 'Pending', "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "FOREIGN KEY (provider_id) REFERENCES relief_providers (id)"
                 << ")", now;
         
@@ -127,7 +160,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "provider_id INTEGER, "
                 << "status TEXT DEFAULT 'Pending', "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "FOREIGN KEY (provider_id) REFERENCES relief_providers (id)"
                 << ")", now;
         
@@ -136,7 +169,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "provider_id INTEGER, "
                 << "status TEXT DEFAULT 'Pending', "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "FOREIGN KEY (provider_id) REFERENCES relief_providers (id)"
                 << ")", now;
         
@@ -163,12 +196,12 @@ private:
         *session << "CREATE TABLE IF NOT EXISTS help_requests ("
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "requester_id INTEGER, "
-                << "type TEXT, "
+                << "type INTEGER DEFAULT " << enumCode(HelpType::Other) << ", "
                 << "description TEXT, "
                 << "location TEXT, "
                 << "urgency INTEGER, "
-                << "status TEXT DEFAULT 'Pending', "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "status INTEGER DEFAULT " << enumCode(RequestStatus::Pending) << ", "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "FOREIGN KEY (requester_id) REFERENCES people_in_crisis (id)"
                 << ")", now;
         
@@ -178,10 +211,10 @@ private:
                 << "type TEXT, "
                 << "location TEXT, "
                 << "description TEXT, "
-                << "urgency TEXT, "
+                << "urgency INTEGER DEFAULT " << enumCode(Urgency::Medium) << ", "
                 << "time TEXT, "
                 << "assigned_volunteer_id INTEGER, "
-                << "status TEXT DEFAULT 'Available', "
+                << "status INTEGER DEFAULT " << enumCode(TaskStatus::Available) << ", "
                 << "FOREIGN KEY (assigned_volunteer_id) REFERENCES volunteers (id)"
                 << ")", now;
         
@@ -192,7 +225,7 @@ private:
                 << "username TEXT UNIQUE NOT NULL, "
                 << "password TEXT NOT NULL, "
                 << "is_active INTEGER DEFAULT 1, "
-                << "created_at TEXT DEFAULT CURRENT_TIMESTAMP"
+                << "created_at INTEGER DEFAULT " << kNowMillis << ""
                 << ")", now;
         
         // AlertSystem table
@@ -206,7 +239,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "volunteer_id INTEGER, "
                 << "amount REAL NOT NULL, "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "FOREIGN KEY (volunteer_id) REFERENCES volunteers (id)"
                 << ")", now;
         
@@ -215,7 +248,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "volunteer_id INTEGER, "
                 << "description TEXT, "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "status TEXT DEFAULT 'Pending', "
                 << "FOREIGN KEY (volunteer_id) REFERENCES volunteers (id)"
                 << ")", now;
@@ -225,7 +258,7 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "volunteer_id INTEGER, "
                 << "request_id INTEGER, "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "status TEXT DEFAULT 'Active', "
                 << "FOREIGN KEY (volunteer_id) REFERENCES volunteers (id), "
                 << "FOREIGN KEY (request_id) REFERENCES help_requests (id)"
@@ -236,18 +269,18 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "type TEXT, "
                 << "message TEXT, "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP, "
+                << "timestamp INTEGER DEFAULT " << kNowMillis << ", "
                 << "sender TEXT"
                 << ")", now;
         
         // Emergency Protocol Tables
         *session << "CREATE TABLE IF NOT EXISTS emergency_protocols ("
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                << "level TEXT NOT NULL, "
+                << "level INTEGER NOT NULL, "
                 << "description TEXT, "
-                << "triggered_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                << "triggered_at INTEGER DEFAULT " << kNowMillis << ", "
                 << "triggered_by INTEGER, "
-                << "status TEXT DEFAULT 'active', "
+                << "status INTEGER DEFAULT " << enumCode(OperationStatus::Active) << ", "
                 << "FOREIGN KEY (triggered_by) REFERENCES government_agencies(id)"
                 << ")", now;
         
@@ -255,11 +288,11 @@ private:
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "name TEXT NOT NULL, "
                 << "location TEXT NOT NULL, "
-                << "status TEXT DEFAULT 'active', "
+                << "status INTEGER DEFAULT " << enumCode(OperationStatus::Active) << ", "
                 << "resources_deployed INTEGER DEFAULT 0, "
                 << "personnel_deployed INTEGER DEFAULT 0, "
-                << "started_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                << "ended_at TIMESTAMP, "
+                << "started_at INTEGER DEFAULT " << kNowMillis << ", "
+                << "ended_at INTEGER, "
                 << "protocol_id INTEGER, "
                 << "FOREIGN KEY (protocol_id) REFERENCES emergency_protocols(id)"
                 << ")", now;
@@ -270,9 +303,9 @@ private:
                 << "location TEXT NOT NULL, "
                 << "count INTEGER NOT NULL, "
                 << "priority INTEGER DEFAULT 1, "
-                << "status TEXT DEFAULT 'pending', "
-                << "allocated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                << "completed_at TIMESTAMP, "
+                << "status INTEGER DEFAULT " << enumCode(OperationStatus::Pending) << ", "
+                << "allocated_at INTEGER DEFAULT " << kNowMillis << ", "
+                << "completed_at INTEGER, "
                 << "operation_id INTEGER, "
                 << "FOREIGN KEY (operation_id) REFERENCES relief_operations(id)"
                 << ")", now;
@@ -282,9 +315,9 @@ private:
                 << "category TEXT NOT NULL, "
                 << "amount REAL NOT NULL, "
                 << "priority INTEGER DEFAULT 1, "
-                << "status TEXT DEFAULT 'available', "
-                << "created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                << "allocated_at TIMESTAMP, "
+                << "status INTEGER DEFAULT " << enumCode(OperationStatus::Available) << ", "
+                << "created_at INTEGER DEFAULT " << kNowMillis << ", "
+                << "allocated_at INTEGER, "
                 << "operation_id INTEGER, "
                 << "FOREIGN KEY (operation_id) REFERENCES relief_operations(id)"
                 << ")", now;
@@ -295,28 +328,21 @@ private:
                 << "location TEXT NOT NULL, "
                 << "priority INTEGER DEFAULT 1, "
                 << "description TEXT, "
-                << "status TEXT DEFAULT 'pending', "
-                << "requested_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
-                << "responded_at TIMESTAMP, "
+                << "status INTEGER DEFAULT " << enumCode(OperationStatus::Pending) << ", "
+                << "requested_at INTEGER DEFAULT " << kNowMillis << ", "
+                << "responded_at INTEGER, "
                 << "operation_id INTEGER, "
                 << "FOREIGN KEY (operation_id) REFERENCES relief_operations(id)"
                 << ")", now;
         
-        // Security tables
-        *session << "CREATE TABLE IF NOT EXISTS security_logs ("
-                << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                << "event_type TEXT NOT NULL, "
-                << "description TEXT, "
-                << "timestamp TEXT DEFAULT CURRENT_TIMESTAMP"
-                << ")", now;
-        
+        // Security tables; events live in the audit log (security/AuditLog.h)
         *session << "CREATE TABLE IF NOT EXISTS active_sessions ("
                 << "id INTEGER PRIMARY KEY AUTOINCREMENT, "
                 << "user_id INTEGER NOT NULL, "
                 << "user_type TEXT NOT NULL, "
                 << "session_token TEXT UNIQUE, "
-                << "created_at TEXT DEFAULT CURRENT_TIMESTAMP, "
-                << "expires_at TEXT"
+                << "created_at INTEGER DEFAULT " << kNowMillis << ", "
+                << "expires_at INTEGER"
                 << ")", now;
         
         *session << "CREATE TABLE IF NOT EXISTS security_alerts ("
@@ -325,7 +351,7 @@ private:
                 << "description TEXT, "
                 << "severity TEXT, "
                 << "status TEXT DEFAULT 'active', "
-                << "created_at TEXT DEFAULT CURRENT_TIMESTAMP"
+                << "created_at INTEGER DEFAULT " << kNowMillis << ""
                 << ")", now;
         
         *session << "CREATE TABLE IF NOT EXISTS security_settings ("
@@ -334,7 +360,7 @@ private:
                 << "max_login_attempts INTEGER DEFAULT 3, "
                 << "session_timeout INTEGER DEFAULT 3600, "
                 << "ip_restriction INTEGER DEFAULT 0, "
-                << "updated_at TEXT DEFAULT CURRENT_TIMESTAMP"
+                << "updated_at INTEGER DEFAULT " << kNowMillis << ""
                 << ")", now;
         
         *session << "CREATE TABLE IF NOT EXISTS account_verifications ("
@@ -343,8 +369,8 @@ private:
                 << "user_id INTEGER NOT NULL, "
                 << "status TEXT DEFAULT 'pending', "
                 << "notes TEXT, "
-                << "created_at TEXT DEFAULT CURRENT_TIMESTAMP, "
-                << "verified_at TEXT"
+                << "created_at INTEGER DEFAULT " << kNowMillis << ", "
+                << "verified_at INTEGER"
                 << ")", now;
         
         // Insert default admin if not exists
@@ -352,11 +378,365 @@ private:
         *session << "SELECT COUNT(*) FROM admins WHERE username = 'admin'", into(adminCount), now;
         
         if (adminCount == 0) {
-            *session << "INSERT INTO admins (name, username, password, is_active) VALUES ('Administrator', 'admin', 'admin123', 1)", now;
+            std::string password = PasswordHash::make("admin123", PasswordHash::kDefaultIterations);
+            *session << "INSERT INTO admins (name, username, password, is_active) VALUES ('Administrator', 'admin', ?, 1)",
+                use(password), now;
+        }
+
+        // Insert default security settings if not exists
+        Poco::Int64 settingsCount = 0;
+        *session << "SELECT COUNT(*) FROM security_settings", into(settingsCount), now;
+
+        if (settingsCount == 0) {
+            *session << "INSERT INTO security_settings DEFAULT VALUES", now;
+        }
+
+        // Status filters scan these
+        *session << "CREATE INDEX IF NOT EXISTS idx_help_requests_status ON help_requests (status)", now;
+        *session << "CREATE INDEX IF NOT EXISTS idx_relief_operations_status ON relief_operations (status, location)", now;
+        *session << "CREATE INDEX IF NOT EXISTS idx_emergency_protocols_status ON emergency_protocols (status, triggered_at)", now;
+
+        // Time-range filters and newest-first listings scan these
+        *session << "CREATE INDEX IF NOT EXISTS idx_help_requests_timestamp ON help_requests (timestamp)", now;
+        *session << "CREATE INDEX IF NOT EXISTS idx_alerts_timestamp ON alerts (timestamp)", now;
+        *session << "CREATE INDEX IF NOT EXISTS idx_active_sessions_expires_at ON active_sessions (expires_at)", now;
+    }
+
+    // Schema revisions, tracked in PRAGMA user_version:
+    //   1  status/type/urgency/level columns hold enum codes (models/Enums.h) instead of text
+    //   2  time columns hold epoch milliseconds (models/Timestamp.h) instead of datetime text
+    //   3  active_sessions.session_token holds the token's SHA-256 (security/TokenHash.h)
+    //   4  security_logs is gone; its rows were moved into the audit log (security/AuditLog.h)
+    //   5  password columns hold hashes only (security/PasswordHash.h)
+    static constexpr int kSchemaVersion = 5;
+
+    // Column name -> SQL expression over the old table computing its new value
+    using Conversions = std::vector<std::pair<std::string, std::string>>;
+    using TableConversions = std::vector<std::pair<std::string, Conversions>>;
+
+    void migrate() {
+        int version = 0;
+        *session << "PRAGMA user_version", into(version), now;
+        if (version >= kSchemaVersion) return;
+
+        if (version < 1) {
+            LOG_INFO("Migrating database to schema version 1 (enum-coded columns)");
+            rebuildTables(enumColumns());
+        }
+        if (version < 2) {
+            LOG_INFO("Migrating database to schema version 2 (epoch millisecond timestamps)");
+            rebuildTables(timestampColumns());
+        }
+        if (version < 3) {
+            LOG_INFO("Migrating database to schema version 3 (hashed session tokens)");
+            hashSessionTokens();
+        }
+        if (version < 4) {
+            LOG_INFO("Migrating database to schema version 4 (security logs in the audit log)");
+            importSecurityLogs();
+        }
+        if (version < 5) {
+            LOG_INFO("Migrating database to schema version 5 (hashed passwords)");
+            hashPlaintextPasswords();
+        }
+        *session << "PRAGMA user_version = " << kSchemaVersion, now;
+    }
+
+    // Replace stored bearer tokens with their hashes; the sessions stay valid
+    void hashSessionTokens() {
+        std::vector<int> ids;
+        std::vector<std::string> tokens;
+        *session << "SELECT id, session_token FROM active_sessions WHERE session_token IS NOT NULL",
+            into(ids), into(tokens), now;
+        try {
+            session->begin();
+            int id = 0;
+            std::string key;
+            Statement update(*session);
+            update << "UPDATE active_sessions SET session_token = ? WHERE id = ?", use(key), use(id);
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                id = ids[i];
+                key = hashToken(tokens[i]);
+                update.execute();
+            }
+            session->commit();
+        } catch (const std::exception& e) {
+            session->rollback();
+            LOG_ERROR("Error migrating database: " << e.what());
+            throw;
+        }
+    }
+
+    // Hash every password still stored as plaintext. Each hash costs tens of
+    // milliseconds by design, so the rows are spread over all cores before
+    // the updates are written in one transaction.
+    void hashPlaintextPasswords() {
+        static const char* tables[] = {"people_in_crisis", "volunteers", "relief_providers", "government_agencies",
+                                       "admins"};
+        std::vector<std::string> names;
+        std::vector<int> ids;
+        std::vector<std::string> passwords;
+        for (const char* table : tables) {
+            std::vector<int> tableIds;
+            std::vector<std::string> tablePasswords;
+            *session << "SELECT id, password FROM " << table << " WHERE password IS NOT NULL AND password <> ''",
+                into(tableIds), into(tablePasswords), now;
+            for (std::size_t i = 0; i < tableIds.size(); ++i) {
+                if (PasswordHash::isHashed(tablePasswords[i])) continue;
+                names.push_back(table);
+                ids.push_back(tableIds[i]);
+                passwords.push_back(std::move(tablePasswords[i]));
+            }
         }
+        if (ids.empty()) return;
+
+        std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> hashers;
+        for (std::size_t t = 0; t < threads; ++t) {
+            hashers.emplace_back([&passwords, t, threads] {
+                for (std::size_t i = t; i < passwords.size(); i += threads) {
+                    passwords[i] = PasswordHash::make(passwords[i], PasswordHash::kDefaultIterations);
+                }
+            });
+        }
+        for (auto& hasher : hashers) hasher.join();
+
+        try {
+            session->begin();
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                *session << "UPDATE " << names[i] << " SET password = ? WHERE id = ?", use(passwords[i]), use(ids[i]), now;
+            }
+            session->commit();
+        } catch (const std::exception& e) {
+            session->rollback();
+            LOG_ERROR("Error migrating database: " << e.what());
+            throw;
+        }
+        LOG_INFO("Hashed " << ids.size() << " plaintext passwords");
+    }
+
+    // Move security_logs rows into the audit log, which has served
+    // /api/security/logs since it replaced the table, then drop the table.
+    // The table was never rebuilt by version 2, so its times may still be text.
+    void importSecurityLogs() {
+        if (columnsOf("security_logs").empty()) return;
+        std::vector<std::string> types;
+        std::vector<std::string> descriptions;
+        std::vector<Poco::Int64> times;
+        *session << "SELECT event_type, COALESCE(description, ''), COALESCE("
+                 << epochMillisExpression("timestamp") << ", 0) FROM security_logs ORDER BY id",
+            into(types), into(descriptions), into(times), now;
+
+        std::vector<AuditRecord> records(types.size());
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            records[i].timestampMs = times[i];
+            records[i].type = std::move(types[i]);
+            records[i].description = std::move(descriptions[i]);
+        }
+        if (!AuditLog::instance().importRecords(std::move(records))) {
+            LOG_ERROR("Error migrating database: security logs could not be written to the audit log");
+            throw std::runtime_error("security log import failed");
+        }
+        *session << "DROP TABLE security_logs", now;
+    }
+
+    // SQL mapping a legacy text column to enum codes; rows already holding codes are kept
+    template <typename E>
+    static std::string enumCodeExpression(const std::string& column) {
+        std::ostringstream sql;
+        sql << "CASE WHEN typeof(" << column << ") = 'integer' THEN " << column;
+        for (std::size_t i = 0; i < enumCount<E>(); ++i) {
+            std::string name = EnumTraits<E>::names[i];
+            for (char& c : name) c = asciiLower(c);
+            sql << " WHEN lower(" << column << ") = '" << name << "' THEN " << i;
+        }
+        sql << " ELSE " << enumCode(EnumTraits<E>::fallback) << " END";
+        return sql.str();
+    }
+
+    // SQL mapping datetime text ("YYYY-MM-DD HH:MM:SS") to epoch milliseconds;
+    // numbers are kept and unparseable text becomes NULL. The text is taken
+    // as UTC, which is what the old CURRENT_TIMESTAMP defaults wrote; a time a
+    // client supplied in local time without an offset comes out shifted by
+    // that offset, since nothing recorded which zone it meant.
+    static std::string epochMillisExpression(const std::string& column) {
+        std::ostringstream sql;
+        sql << "CASE WHEN typeof(" << column << ") IN ('integer', 'real') THEN CAST(" << column << " AS INTEGER)"
+            << " ELSE CAST(round((julianday(" << column << ") - 2440587.5) * 86400000) AS INTEGER) END";
+        return sql.str();
+    }
+
+    static TableConversions enumColumns() {
+        return {
+            {"people_in_crisis", {{"status", enumCodeExpression<RequestStatus>("status")}}},
+            {"volunteers", {{"org_type", enumCodeExpression<OrgType>("org_type")}}},
+            {"relief_providers", {{"org_type", enumCodeExpression<OrgType>("org_type")}}},
+            {"help_requests", {{"type", enumCodeExpression<HelpType>("type")},
+                               {"status", enumCodeExpression<RequestStatus>("status")}}},
+            {"tasks", {{"urgency", enumCodeExpression<Urgency>("urgency")},
+                       {"status", enumCodeExpression<TaskStatus>("status")}}},
+            {"emergency_protocols", {{"level", enumCodeExpression<EmergencyLevel>("level")},
+                                     {"status", enumCodeExpression<OperationStatus>("status")}}},
+            {"relief_operations", {{"status", enumCodeExpression<OperationStatus>("status")}}},
+            {"personnel_allocations", {{"status", enumCodeExpression<OperationStatus>("status")}}},
+            {"emergency_budgets", {{"status", enumCodeExpression<OperationStatus>("status")}}},
+            {"military_support", {{"status", enumCodeExpression<OperationStatus>("status")}}},
+        };
+    }
+
+    static TableConversions timestampColumns() {
+        const std::vector<std::pair<std::string, std::vector<std::string>>> columns = {
+            {"incident_reports", {"timestamp"}},
+            {"manpower_requests", {"timestamp"}},
+            {"gov_aid_requests", {"timestamp"}},
+            {"additional_aid_requests", {"timestamp"}},
+            {"monetary_requests", {"timestamp"}},
+            {"help_requests", {"timestamp"}},
+            {"admins", {"created_at"}},
+            {"donations", {"timestamp"}},
+            {"volunteer_help_requests", {"timestamp"}},
+            {"volunteer_assignments", {"timestamp"}},
+            {"alerts", {"timestamp"}},
+            {"emergency_protocols", {"triggered_at"}},
+            {"relief_operations", {"started_at", "ended_at"}},
+            {"personnel_allocations", {"allocated_at", "completed_at"}},
+            {"emergency_budgets", {"created_at", "allocated_at"}},
+            {"military_support", {"requested_at", "responded_at"}},
+            {"active_sessions", {"created_at", "expires_at"}},
+            {"security_alerts", {"created_at"}},
+            {"security_settings", {"updated_at"}},
+            {"account_verifications", {"created_at", "verified_at"}},
+        };
+        TableConversions tables;
+        for (const auto& table : columns) {
+            Conversions conversions;
+            for (const auto& column : table.second) {
+                conversions.emplace_back(column, epochMillisExpression(column));
+            }
+            tables.emplace_back(table.first, std::move(conversions));
+        }
+        return tables;
+    }
+
+    std::vector<std::string> columnsOf(const std::string& table) {
+        std::vector<std::string> columns;
+        Statement select(*session);
+        select << "PRAGMA table_info(" << table << ")";
+        select.execute();
+        Poco::Data::RecordSet rs(select);
+        for (bool more = rs.moveFirst(); more; more = rs.moveNext()) {
+            columns.push_back(rs["name"].convert<std::string>());
+        }
+        return columns;
+    }
+
+    // Indexes created by initDatabase() (not the implicit UNIQUE ones)
+    std::vector<std::string> indexesOf(const std::string& table) {
+        std::vector<std::string> indexes;
+        std::string tableCopy = table;
+        *session << "SELECT name FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND sql IS NOT NULL",
+            into(indexes), use(tableCopy), now;
+        return indexes;
+    }
+
+    // Tables whose description column is full-text indexed, as <table>_fts
+    static const std::vector<std::string>& searchableTables() {
+        static const std::vector<std::string> tables = {"help_requests", "people_in_crisis", "incident_reports"};
+        return tables;
+    }
+
+    // FTS5 indexes over the description columns. They are external-content
+    // tables: the text lives only in the base table, and triggers keep the
+    // index in step with every insert, update and delete. Run at each start
+    // rather than as a schema version because rebuildTables() drops triggers
+    // along with the renamed table; an index whose triggers had to be
+    // recreated is rebuilt from its table. Without FTS5 in the linked SQLite
+    // search is reported unavailable and everything else carries on.
+    void createSearchIndexes() {
+        try {
+            for (const auto& table : searchableTables()) {
+                std::string fts = table + "_fts";
+                int present = 0;
+                *session << "SELECT count(*) FROM sqlite_master WHERE type IN ('table', 'trigger') AND name IN ('"
+                         << fts << "', '" << fts << "_ai', '" << fts << "_ad', '" << fts << "_au')",
+                    into(present), now;
+                if (present == 4) continue;
+
+                session->begin();
+                // porter stems English words, so "trapped" finds "trap"; the
+                // prefix indexes serve 2 and 3 character prefix queries
+                *session << "CREATE VIRTUAL TABLE IF NOT EXISTS " << fts << " USING fts5(description, content='"
+                         << table << "', content_rowid='id', tokenize='porter unicode61', prefix='2 3')", now;
+                *session << "CREATE TRIGGER IF NOT EXISTS " << fts << "_ai AFTER INSERT ON " << table << " BEGIN "
+                         << "INSERT INTO " << fts << " (rowid, description) VALUES (new.id, new.description); END", now;
+                *session << "CREATE TRIGGER IF NOT EXISTS " << fts << "_ad AFTER DELETE ON " << table << " BEGIN "
+                         << "INSERT INTO " << fts << " (" << fts << ", rowid, description) "
+                         << "VALUES ('delete', old.id, old.description); END", now;
+                *session << "CREATE TRIGGER IF NOT EXISTS " << fts << "_au AFTER UPDATE OF description ON " << table
+                         << " BEGIN "
+                         << "INSERT INTO " << fts << " (" << fts << ", rowid, description) "
+                         << "VALUES ('delete', old.id, old.description); "
+                         << "INSERT INTO " << fts << " (rowid, description) VALUES (new.id, new.description); END", now;
+                *session << "INSERT INTO " << fts << " (" << fts << ") VALUES ('rebuild')", now;
+                session->commit();
+                LOG_INFO("Built full-text index " << fts);
+            }
+            searchAvailable = true;
+        } catch (const std::exception& e) {
+            if (session->isTransaction()) session->rollback();
+            LOG_WARN("Full-text search unavailable: " << e.what());
+        }
+    }
+
+    // SQLite cannot change a column's type in place, so each affected table is
+    // renamed aside, recreated by initDatabase() and refilled with mapped values
+    void rebuildTables(const TableConversions& tables) {
+        // Keep other tables' REFERENCES clauses pointing at the original names
+        *session << "PRAGMA legacy_alter_table = ON", now;
+        try {
+            session->begin();
+            for (const auto& table : tables) {
+                // Indexes follow a renamed table; drop them so initDatabase() recreates them on the new one
+                for (const auto& index : indexesOf(table.first)) {
+                    *session << "DROP INDEX IF EXISTS " << index, now;
+                }
+                *session << "ALTER TABLE " << table.first << " RENAME TO " << table.first << "_v0", now;
+            }
+            initDatabase();
+            for (const auto& table : tables) {
+                std::vector<std::string> created = columnsOf(table.first);
+                std::set<std::string> current(created.begin(), created.end());
+                std::ostringstream columns;
+                std::ostringstream values;
+                for (const auto& column : columnsOf(table.first + "_v0")) {
+                    if (!current.count(column)) continue;
+                    std::string value = column;
+                    for (const auto& conversion : table.second) {
+                        if (conversion.first == column) value = conversion.second;
+                    }
+                    columns << (columns.tellp() > 0 ? ", " : "") << column;
+                    values << (values.tellp() > 0 ? ", " : "") << value;
+                }
+                *session << "INSERT INTO " << table.first << " (" << columns.str() << ") SELECT "
+                         << values.str() << " FROM " << table.first << "_v0", now;
+                *session << "DROP TABLE " << table.first << "_v0", now;
+            }
+            session->commit();
+        } catch (const std::exception& e) {
+            session->rollback();
+            *session << "PRAGMA legacy_alter_table = OFF", now;
+            LOG_ERROR("Error migrating database: " << e.what());
+            throw;
+        }
+        *session << "PRAGMA legacy_alter_table = OFF", now;
     }
     
 public:
+    // Override the database file (e.g. ":memory:"); must be called before the first getInstance()
+    static void setDatabasePath(const std::string& path) {
+        databasePath = path;
+    }
+
     // Get singleton instance
     static DatabaseManager* getInstance() {
         if (!instance) {
@@ -369,6 +749,37 @@ public:
     Session& getSession() {
         return *session;
     }
+
+    // Whether the full-text indexes over descriptions exist (SQLite built with FTS5)
+    bool hasSearch() const {
+        return searchAvailable;
+    }
+
+    // ":memory:": everything lives in the shared connection
+    bool inMemory() const {
+        return databasePath == ":memory:";
+    }
+
+    // A connection of its own to the same database, for long jobs that should
+    // not hold the shared one; nullptr for ":memory:", whose data lives only
+    // in the shared connection
+    std::unique_ptr<Session> openSession() {
+        if (databasePath == ":memory:") return nullptr;
+        auto own = std::make_unique<Session>("SQLite", databasePath);
+        sqlite3_busy_timeout(Poco::Data::SQLite::Utility::dbHandle(*own), 5000);
+        QueryProfiler::instance().attach(*own);
+        StatementDeadline::install(Poco::Data::SQLite::Utility::dbHandle(*own));
+        return own;
+    }
+
+    // Fold the WAL back into the database file, e.g. before shutting down
+    void checkpoint() {
+        try {
+            *session << "PRAGMA wal_checkpoint(TRUNCATE)", now;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error checkpointing database: " << e.what());
+        }
+    }
     
     // Destructor
     ~DatabaseManager() {
@@ -376,5 +787,6 @@ public:
     }
 };
 
-// Initialize static member
-DatabaseManager* DatabaseManager::instance = nullptr;
\ No newline at end of file
+// Initialize static members
+DatabaseManager* DatabaseManager::instance = nullptr;
+std::string DatabaseManager::databasePath = "crisis_management.db";
\ No newline at end of file
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sqlite3.h>
+#include <Poco/Data/Session.h>
+#include <Poco/Data/SQLite/Utility.h>
+#include <Poco/JSON/Object.h>
+#include <Poco/JSON/Array.h>
+#include "../logging/Logger.h"
+
+// Per-statement profiler for the SQLite connection.
+//
+// Hooks sqlite3_trace_v2(SQLITE_TRACE_PROFILE) so every statement executed
+// through the Poco session is timed without touching the call sites. Timings
+// are counted per prepared statement in shards chosen by the statement's
+// address, so DB threads seldom share a lock and nothing is hashed or
+// normalized on the hot path; report() merges the shards by normalized SQL
+// (literals replaced with '?'). The slowest executions are kept with the
+// shapes of their bound parameters (types and lengths only, never values),
+// and executions above the threshold are appended to a slow query log. That
+// log is a Logger channel, so the line is written by the logging flusher
+// rather than on the thread running the query; like any log line it is rate
+// limited per second and cut at logging::kMaxMessage bytes, SQL last.
+class QueryProfiler {
+public:
+    struct StatementStats {
+        std::string sql;
+        uint64_t count = 0;
+        uint64_t totalNanos = 0;
+        uint64_t maxNanos = 0;
+        uint64_t minNanos = UINT64_MAX;
+
+        void add(uint64_t nanos) {
+            ++count;
+            totalNanos += nanos;
+            maxNanos = std::max(maxNanos, nanos);
+            minNanos = std::min(minNanos, nanos);
+        }
+
+        void merge(const StatementStats& other) {
+            count += other.count;
+            totalNanos += other.totalNanos;
+            maxNanos = std::max(maxNanos, other.maxNanos);
+            minNanos = std::min(minNanos, other.minNanos);
+        }
+    };
+
+    struct Execution {
+        std::string sql;
+        std::string parameterShape;
+        uint64_t nanos = 0;
+        std::time_t at = 0;
+    };
+
+private:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxEntriesPerShard = 4096;
+
+    // Statement handles are reused once finalized, so each live entry keeps
+    // the raw SQL it counts; a handle seen with other SQL moves its counts
+    // to retired first. Past kMaxEntriesPerShard entries, retired is folded
+    // into normalized so SQL with varying literals cannot grow it for ever.
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<const sqlite3_stmt*, StatementStats> live;    // sql: raw SQL
+        std::unordered_map<std::string, StatementStats> retired;         // by raw SQL
+        std::unordered_map<std::string, StatementStats> normalized;      // by normalized SQL
+
+        void retire(StatementStats& stats) {
+            if (stats.count == 0) return;
+            retired[stats.sql].merge(stats);
+            if (retired.size() > kMaxEntriesPerShard) {
+                for (const auto& entry : retired) normalized[normalize(entry.first)].merge(entry.second);
+                retired.clear();
+            }
+        }
+    };
+
+    std::array<Shard, kShards> shards;
+
+    // Slowest and slow executions; only taken for the few that qualify
+    std::mutex slowMutex;
+    std::vector<Execution> slowest;   // min-heap on nanos, at most topN entries
+    std::deque<Execution> recentSlow; // ring buffer of executions above the threshold
+    std::atomic<uint64_t> keepAbove{0};  // nanos to beat to enter a full slowest; 0 while it has room
+
+    std::size_t topN = 50;
+    std::size_t recentCapacity = 256;
+    std::atomic<uint64_t> slowThresholdNanos{100ULL * 1000 * 1000};
+    std::string slowLogPath = "slow_queries.log";
+    uint8_t slowLogChannel = 0;  // opened on the first slow query
+
+    QueryProfiler() {}
+
+    static bool heapOrder(const Execution& a, const Execution& b) {
+        return a.nanos > b.nanos;
+    }
+
+    static int traceCallback(unsigned type, void* context, void* statement, void* elapsed) {
+        if (type == SQLITE_TRACE_PROFILE) {
+            static_cast<QueryProfiler*>(context)->record(
+                static_cast<sqlite3_stmt*>(statement),
+                static_cast<uint64_t>(*static_cast<sqlite3_int64*>(elapsed)));
+        }
+        return 0;
+    }
+
+    void record(sqlite3_stmt* statement, uint64_t nanos) {
+        const char* raw = sqlite3_sql(statement);
+        if (!raw) return;
+
+        Shard& shard = shards[std::hash<const void*>()(statement) % kShards];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.live.find(statement);
+            if (it == shard.live.end()) {
+                if (shard.live.size() >= kMaxEntriesPerShard) {
+                    for (auto& entry : shard.live) shard.retire(entry.second);
+                    shard.live.clear();
+                }
+                it = shard.live.emplace(statement, StatementStats()).first;
+                it->second.sql = raw;
+            } else if (it->second.sql != raw) {
+                shard.retire(it->second);
+                it->second = StatementStats();
+                it->second.sql = raw;
+            }
+            it->second.add(nanos);
+        }
+
+        bool entersTopN = nanos > keepAbove.load(std::memory_order_relaxed);
+        bool aboveThreshold = nanos >= slowThresholdNanos.load(std::memory_order_relaxed);
+        if (!entersTopN && !aboveThreshold) return;
+
+        std::lock_guard<std::mutex> lock(slowMutex);
+        entersTopN = slowest.size() < topN || nanos > slowest.front().nanos;
+        if (!entersTopN && !aboveThreshold) return;
+
+        // SQL is normalized and parameter shapes derived only for executions we keep
+        Execution execution;
+        execution.sql = normalize(raw);
+        execution.nanos = nanos;
+        execution.at = std::time(nullptr);
+        char* expanded = sqlite3_expanded_sql(statement);
+        if (expanded) {
+            execution.parameterShape = parameterShape(raw, expanded);
+            sqlite3_free(expanded);
+        }
+
+        if (entersTopN) {
+            if (slowest.size() >= topN) {
+                std::pop_heap(slowest.begin(), slowest.end(), heapOrder);
+                slowest.pop_back();
+            }
+            slowest.push_back(execution);
+            std::push_heap(slowest.begin(), slowest.end(), heapOrder);
+            updateKeepAbove();
+        }
+
+        if (aboveThreshold) {
+            recentSlow.push_back(execution);
+            if (recentSlow.size() > recentCapacity) recentSlow.pop_front();
+            writeSlowLog(execution);
+        }
+    }
+
+    // Caller holds slowMutex
+    void updateKeepAbove() {
+        keepAbove.store(slowest.size() >= topN ? slowest.front().nanos : 0, std::memory_order_relaxed);
+    }
+
+    // Caller holds slowMutex
+    void writeSlowLog(const Execution& execution) {
+        if (slowLogPath.empty()) return;
+        if (slowLogChannel == 0) {
+            slowLogChannel = logging::Logger::instance().openChannel(slowLogPath);
+            if (slowLogChannel == 0) return;
+        }
+        char duration[32];
+        std::snprintf(duration, sizeof(duration), "%.3f", execution.nanos / 1e6);
+        LOG_TO(slowLogChannel, "duration_ms=" << duration << " params=" << execution.parameterShape
+               << " sql=" << execution.sql);
+    }
+
+    static Poco::JSON::Object::Ptr toJSON(const Execution& execution) {
+        Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
+        json->set("sql", execution.sql);
+        json->set("parameters", execution.parameterShape);
+        json->set("duration_ms", execution.nanos / 1e6);
+        json->set("at", static_cast<Poco::Int64>(execution.at));
+        return json;
+    }
+
+public:
+    static QueryProfiler& instance() {
+        static QueryProfiler profiler;
+        return profiler;
+    }
+
+    // Install the trace hook on the session's SQLite handle
+    void attach(Poco::Data::Session& session) {
+        sqlite3* db = Poco::Data::SQLite::Utility::dbHandle(session);
+        sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE, &QueryProfiler::traceCallback, this);
+    }
+
+    // Slow query threshold and log file (empty: no file); from ServerConfig at startup
+    void configure(uint64_t thresholdMillis, const std::string& logPath, std::size_t slowestToKeep) {
+        std::lock_guard<std::mutex> lock(slowMutex);
+        slowThresholdNanos.store(thresholdMillis * 1000 * 1000, std::memory_order_relaxed);
+        if (logPath != slowLogPath) slowLogChannel = 0;
+        slowLogPath = logPath;
+        topN = slowestToKeep > 0 ? slowestToKeep : 1;
+        while (slowest.size() > topN) {
+            std::pop_heap(slowest.begin(), slowest.end(), heapOrder);
+            slowest.pop_back();
+        }
+        updateKeepAbove();
+    }
+
+    void reset() {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.live.clear();
+            shard.retired.clear();
+            shard.normalized.clear();
+        }
+        std::lock_guard<std::mutex> lock(slowMutex);
+        slowest.clear();
+        recentSlow.clear();
+        updateKeepAbove();
+    }
+
+    // Replace string and numeric literals with '?' and collapse whitespace
+    static std::string normalize(const std::string& sql) {
+        std::string out;
+        out.reserve(sql.size());
+        bool pendingSpace = false;
+        for (std::size_t i = 0; i < sql.size(); ++i) {
+            char c = sql[i];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                pendingSpace = !out.empty();
+                continue;
+            }
+            if (pendingSpace) {
+                out += ' ';
+                pendingSpace = false;
+            }
+            if (c == '\'') {
+                // Skip the quoted literal, honouring '' escapes
+                ++i;
+                while (i < sql.size()) {
+                    if (sql[i] == '\'' && i + 1 < sql.size() && sql[i + 1] == '\'') {
+                        i += 2;
+                    } else if (sql[i] == '\'') {
+                        break;
+                    } else {
+                        ++i;
+                    }
+                }
+                out += '?';
+            } else if (std::isdigit(static_cast<unsigned char>(c)) &&
+                       (out.empty() || !(std::isalnum(static_cast<unsigned char>(out.back())) || out.back() == '_'))) {
+                while (i + 1 < sql.size() && (std::isdigit(static_cast<unsigned char>(sql[i + 1])) || sql[i + 1] == '.')) {
+                    ++i;
+                }
+                out += '?';
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    // Describe the values bound to each '?' as types and lengths, e.g. "(int, text[8], null)"
+    static std::string parameterShape(const std::string& sql, const std::string& expanded) {
+        std::vector<std::string> shapes;
+        std::size_t i = 0, j = 0;
+        while (i < sql.size() && j < expanded.size()) {
+            char c = sql[i];
+            if (c == '\'') {
+                // Literal written into the SQL text appears verbatim in both strings
+                std::size_t start = i;
+                ++i;
+                while (i < sql.size() && !(sql[i] == '\'' && (i + 1 >= sql.size() || sql[i + 1] != '\''))) {
+                    i += (sql[i] == '\'') ? 2 : 1;
+                }
+                ++i;
+                j += i - start;
+            } else if (c == '?') {
+                ++i;
+                if (expanded.compare(j, 4, "NULL") == 0) {
+                    shapes.push_back("null");
+                    j += 4;
+                } else if (expanded[j] == '\'') {
+                    std::size_t length = 0;
+                    ++j;
+                    while (j < expanded.size()) {
+                        if (expanded[j] == '\'' && j + 1 < expanded.size() && expanded[j + 1] == '\'') {
+                            j += 2;
+                        } else if (expanded[j] == '\'') {
+                            ++j;
+                            break;
+                        } else {
+                            ++j;
+                        }
+                        ++length;
+                    }
+                    shapes.push_back("text[" + std::to_string(length) + "]");
+                } else if ((expanded[j] == 'x' || expanded[j] == 'X') && j + 1 < expanded.size() && expanded[j + 1] == '\'') {
+                    std::size_t start = j + 2;
+                    j = expanded.find('\'', start);
+                    if (j == std::string::npos) j = expanded.size();
+                    shapes.push_back("blob[" + std::to_string((j - start) / 2) + "]");
+                    ++j;
+                } else {
+                    bool real = false;
+                    while (j < expanded.size() && (std::isdigit(static_cast<unsigned char>(expanded[j])) ||
+                           expanded[j] == '-' || expanded[j] == '+' || expanded[j] == '.' ||
+                           expanded[j] == 'e' || expanded[j] == 'E')) {
+                        if (expanded[j] == '.' || expanded[j] == 'e' || expanded[j] == 'E') real = true;
+                        ++j;
+                    }
+                    shapes.push_back(real ? "real" : "int");
+                }
+            } else {
+                ++i;
+                ++j;
+            }
+        }
+
+        std::string shape = "(";
+        for (std::size_t k = 0; k < shapes.size(); ++k) {
+            if (k) shape += ", ";
+            shape += shapes[k];
+        }
+        return shape + ")";
+    }
+
+    // Aggregates ordered by total time, plus the slowest and most recent slow executions
+    Poco::JSON::Object::Ptr report(std::size_t limit = 50) {
+        // Merge the shards by normalized SQL, one shard lock at a time
+        std::unordered_map<std::string, StatementStats> byNormalizedSql;
+        std::unordered_map<std::string, std::string> normalizedCache;  // raw SQL -> normalized SQL
+        auto add = [&](const std::string& sql, const StatementStats& stats) {
+            StatementStats& total = byNormalizedSql[sql];
+            if (total.count == 0) total.sql = sql;
+            total.merge(stats);
+        };
+        auto addRaw = [&](const std::string& raw, const StatementStats& stats) {
+            auto cached = normalizedCache.find(raw);
+            if (cached == normalizedCache.end()) cached = normalizedCache.emplace(raw, normalize(raw)).first;
+            add(cached->second, stats);
+        };
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& entry : shard.live) {
+                if (entry.second.count > 0) addRaw(entry.second.sql, entry.second);
+            }
+            for (const auto& entry : shard.retired) addRaw(entry.first, entry.second);
+            for (const auto& entry : shard.normalized) add(entry.first, entry.second);
+        }
+
+        std::vector<const StatementStats*> ordered;
+        for (const auto& entry : byNormalizedSql) {
+            ordered.push_back(&entry.second);
+        }
+        std::sort(ordered.begin(), ordered.end(), [](const StatementStats* a, const StatementStats* b) {
+            return a->totalNanos > b->totalNanos;
+        });
+
+        Poco::JSON::Array::Ptr statements = new Poco::JSON::Array();
+        for (std::size_t i = 0; i < ordered.size() && i < limit; ++i) {
+            const StatementStats& stats = *ordered[i];
+            Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
+            json->set("sql", stats.sql);
+            json->set("count", stats.count);
+            json->set("total_ms", stats.totalNanos / 1e6);
+            json->set("mean_ms", stats.totalNanos / 1e6 / stats.count);
+            json->set("min_ms", stats.minNanos / 1e6);
+            json->set("max_ms", stats.maxNanos / 1e6);
+            statements->add(json);
+        }
+
+        std::lock_guard<std::mutex> lock(slowMutex);
+        std::vector<Execution> sortedSlowest(slowest);
+        std::sort(sortedSlowest.begin(), sortedSlowest.end(), heapOrder);
+        Poco::JSON::Array::Ptr slowestArray = new Poco::JSON::Array();
+        for (const auto& execution : sortedSlowest) {
+            slowestArray->add(toJSON(execution));
+        }
+
+        Poco::JSON::Array::Ptr recentArray = new Poco::JSON::Array();
+        for (auto it = recentSlow.rbegin(); it != recentSlow.rend(); ++it) {
+            recentArray->add(toJSON(*it));
+        }
+
+        Poco::JSON::Object::Ptr result = new Poco::JSON::Object();
+        result->set("slow_threshold_ms", slowThresholdNanos / 1e6);
+        result->set("statements", statements);
+        result->set("slowest", slowestArray);
+        result->set("recent_slow", recentArray);
+        return result;
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <sqlite3.h>
+#include "../metrics/Metrics.h"
+
+// Per-thread deadline for SQLite statements.
+//
+// A request handler opens a Scope for its time budget (server.handlerTimeout);
+// every connection DatabaseManager opens gets a progress handler that
+// interrupts a statement still running on that thread after the deadline, so
+// a handler stuck behind a slow query fails with an error instead of holding
+// its scheduler slot. Threads without a Scope (background writers, imports
+// and exports) are never interrupted.
+class StatementDeadline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // SQLite virtual machine steps between checks
+    static constexpr int kCheckInterval = 1000;
+
+    class Scope {
+    private:
+        Clock::time_point previous;
+
+    public:
+        // A zero budget sets no deadline
+        explicit Scope(Clock::duration budget) : previous(current()) {
+            current() = budget > Clock::duration::zero() ? Clock::now() + budget : Clock::time_point::max();
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() {
+            current() = previous;
+        }
+    };
+
+    static void install(sqlite3* db) {
+        sqlite3_progress_handler(db, kCheckInterval, &StatementDeadline::check, nullptr);
+    }
+
+    static bool expired() {
+        Clock::time_point deadline = current();
+        return deadline != Clock::time_point::max() && Clock::now() >= deadline;
+    }
+
+private:
+    static Clock::time_point& current() {
+        thread_local Clock::time_point deadline = Clock::time_point::max();
+        return deadline;
+    }
+
+    static int check(void*) {
+        if (!expired()) return 0;
+        static metrics::Counter& interrupted = metrics::Registry::instance().counter(
+            "db_statements_interrupted_total", "Statements stopped because their request ran past server.handlerTimeout");
+        interrupted.inc();
+        return 1;
+    }
+};
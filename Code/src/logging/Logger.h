@@ -0,0 +1,502 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Asynchronous structured logging.
+//
+// Request threads format a message into a fixed-size record and push it onto
+// their own single-producer ring; a background flusher drains every ring,
+// orders the batch by timestamp and writes it as JSON lines with a single
+// write per batch. Nothing on the request path takes a lock or blocks: when a
+// ring is full the record is dropped and counted. Each call site is rate
+// limited, so an error storm from one statement turns into a few lines plus a
+// "suppressed" count instead of thousands of identical lines.
+//
+// Besides the main log, a subsystem can open a channel: a file of its own
+// that takes plain "<timestamp> <message>" lines through the same rings and
+// flusher, whatever the log level (LOG_TO).
+//
+//   LOG_ERROR("Error saving admin: " << e.what());
+namespace logging {
+
+enum class Level : int { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+inline const char* levelName(Level level) {
+    switch (level) {
+        case Level::Debug: return "debug";
+        case Level::Info: return "info";
+        case Level::Warn: return "warn";
+        case Level::Error: return "error";
+        default: return "off";
+    }
+}
+
+inline Level parseLevel(const std::string& name, Level fallback = Level::Info) {
+    if (name == "debug") return Level::Debug;
+    if (name == "info") return Level::Info;
+    if (name == "warn") return Level::Warn;
+    if (name == "error") return Level::Error;
+    if (name == "off") return Level::Off;
+    return fallback;
+}
+
+inline std::atomic<int>& minimumLevel() {
+    static std::atomic<int> level(static_cast<int>(Level::Info));
+    return level;
+}
+
+inline bool enabled(Level level) {
+    return static_cast<int>(level) >= minimumLevel().load(std::memory_order_relaxed);
+}
+
+inline int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+struct Admission {
+    bool admitted;
+    int64_t nanos;
+    uint32_t suppressed;  // records dropped at this call site since the last admitted one
+};
+
+// Per call site rate limit: at most kBurst records per second, the rest are
+// counted and the count is attached to the next record that gets through.
+// Checked before the message is formatted so suppressed records cost little.
+struct CallSite {
+    static constexpr uint32_t kBurst = 10;
+
+    const char* file;
+    int line;
+    std::atomic<int64_t> windowSecond{0};
+    std::atomic<uint32_t> inWindow{0};
+    std::atomic<uint32_t> suppressed{0};
+
+    CallSite(const char* file, int line) : file(file), line(line) {}
+
+    Admission admit() {
+        int64_t nanos = nowNanos();
+        int64_t second = nanos / 1000000000;
+        int64_t current = windowSecond.load(std::memory_order_relaxed);
+        if (current != second &&
+            windowSecond.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+            inWindow.store(0, std::memory_order_relaxed);
+        }
+        if (inWindow.load(std::memory_order_relaxed) >= kBurst ||
+            inWindow.fetch_add(1, std::memory_order_relaxed) >= kBurst) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return {false, nanos, 0};
+        }
+        return {true, nanos, suppressed.exchange(0, std::memory_order_relaxed)};
+    }
+};
+
+constexpr std::size_t kMaxMessage = 240;
+
+struct Record {
+    int64_t nanos;
+    const CallSite* site;
+    uint32_t thread;
+    uint32_t suppressed;
+    Level level;
+    uint8_t channel;  // 0: the main log
+    uint16_t length;
+    char message[kMaxMessage];
+};
+
+// Allocation-free message builder; output past kMaxMessage is truncated
+class Line {
+private:
+    char buffer[kMaxMessage];
+    std::size_t length = 0;
+
+    void append(const char* data, std::size_t size) {
+        std::size_t n = std::min(size, kMaxMessage - length);
+        std::memcpy(buffer + length, data, n);
+        length += n;
+    }
+
+public:
+    Line& operator<<(std::string_view text) {
+        append(text.data(), text.size());
+        return *this;
+    }
+
+    Line& operator<<(const char* text) {
+        return *this << std::string_view(text ? text : "(null)");
+    }
+
+    Line& operator<<(const std::string& text) {
+        return *this << std::string_view(text);
+    }
+
+    Line& operator<<(char c) {
+        append(&c, 1);
+        return *this;
+    }
+
+    Line& operator<<(bool value) {
+        return *this << (value ? "true" : "false");
+    }
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    Line& operator<<(T value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        append(digits, static_cast<std::size_t>(result.ptr - digits));
+        return *this;
+    }
+
+    Line& operator<<(double value) {
+        char digits[32];
+        int n = std::snprintf(digits, sizeof(digits), "%g", value);
+        append(digits, n > 0 ? static_cast<std::size_t>(n) : 0);
+        return *this;
+    }
+
+    const char* data() const { return buffer; }
+    std::size_t size() const { return length; }
+};
+
+// Single-producer single-consumer ring owned by one thread
+class Ring {
+public:
+    static constexpr std::size_t kCapacity = 512;
+
+private:
+    std::array<Record, kCapacity> slots;
+    std::atomic<uint64_t> head{0};  // next slot the flusher reads
+    std::atomic<uint64_t> tail{0};  // next slot the owning thread writes
+
+public:
+    const uint32_t thread;
+    std::atomic<bool> retired{false};
+
+    explicit Ring(uint32_t thread) : thread(thread) {}
+
+    bool push(const Record& record) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == kCapacity) return false;
+        slots[t % kCapacity] = record;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename F>
+    std::size_t drain(F&& consume) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t t = tail.load(std::memory_order_acquire);
+        for (uint64_t i = h; i < t; ++i) {
+            consume(slots[i % kCapacity]);
+        }
+        head.store(t, std::memory_order_release);
+        return static_cast<std::size_t>(t - h);
+    }
+};
+
+class Logger {
+private:
+    std::mutex ringsMutex;  // only taken when a thread logs for the first time and by the flusher
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::atomic<uint32_t> nextThread{1};
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex flushMutex;  // serializes flushes and guards the sinks and formatting buffers
+    std::FILE* sink = stderr;
+    bool ownsSink = false;
+
+    struct Channel {
+        std::string path;
+        std::FILE* file;
+        std::string output;
+    };
+    std::vector<Channel> channels;  // channel n is channels[n - 1]
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::chrono::milliseconds flushInterval{50};
+    std::thread flusher;
+
+    std::vector<Record> batch;
+    std::string output;
+    int64_t cachedSecond = -1;
+    char cachedTime[24];
+
+    Logger() {
+        flusher = std::thread([this] { run(); });
+    }
+
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (flusher.joinable()) flusher.join();
+        if (ownsSink) std::fclose(sink);
+        for (auto& channel : channels) std::fclose(channel.file);
+    }
+
+    // Keeps the thread's ring alive until the thread exits, then hands it back for a final drain
+    struct ThreadRing {
+        std::shared_ptr<Ring> ring;
+        ~ThreadRing() {
+            if (ring) ring->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    Ring& localRing() {
+        thread_local ThreadRing local;
+        if (!local.ring) {
+            local.ring = std::make_shared<Ring>(nextThread.fetch_add(1, std::memory_order_relaxed));
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            rings.push_back(local.ring);
+        }
+        return *local.ring;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (!stopping) {
+            wake.wait_for(lock, flushInterval);
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+        lock.unlock();
+        flush();
+    }
+
+    static const char* shortFile(const char* path) {
+        // Keep "dir/File.h" so call sites stay readable without the build prefix
+        const char* last = std::strrchr(path, '/');
+        if (!last) return path;
+        const char* p = last;
+        while (p > path && *(p - 1) != '/') --p;
+        return p;
+    }
+
+    void appendEscaped(const char* text, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            switch (c) {
+                case '"': output += "\\\""; break;
+                case '\\': output += "\\\\"; break;
+                case '\n': output += "\\n"; break;
+                case '\r': output += "\\r"; break;
+                case '\t': output += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        output += escaped;
+                    } else {
+                        output += static_cast<char>(c);
+                    }
+            }
+        }
+    }
+
+    void appendTimestamp(int64_t nanos) {
+        int64_t second = nanos / 1000000000;
+        if (second != cachedSecond) {
+            std::time_t t = static_cast<std::time_t>(second);
+            std::tm tm{};
+            gmtime_r(&t, &tm);
+            std::strftime(cachedTime, sizeof(cachedTime), "%Y-%m-%dT%H:%M:%S", &tm);
+            cachedSecond = second;
+        }
+        char millis[8];
+        std::snprintf(millis, sizeof(millis), ".%03dZ", static_cast<int>((nanos / 1000000) % 1000));
+        output += cachedTime;
+        output += millis;
+    }
+
+    void format(const Record& record) {
+        output += "{\"ts\":\"";
+        appendTimestamp(record.nanos);
+        output += "\",\"level\":\"";
+        output += levelName(record.level);
+        output += "\",\"thread\":";
+        output += std::to_string(record.thread);
+        output += ",\"src\":\"";
+        const char* file = shortFile(record.site->file);
+        appendEscaped(file, std::strlen(file));
+        output += ':';
+        output += std::to_string(record.site->line);
+        output += "\",\"msg\":\"";
+        appendEscaped(record.message, record.length);
+        output += '"';
+        if (record.suppressed) {
+            output += ",\"suppressed\":";
+            output += std::to_string(record.suppressed);
+        }
+        output += "}\n";
+    }
+
+    // Drain every ring, order the batch by time and write it out
+    void flush() {
+        std::lock_guard<std::mutex> flushLock(flushMutex);
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (auto it = rings.begin(); it != rings.end();) {
+                Ring& ring = **it;
+                bool retired = ring.retired.load(std::memory_order_acquire);
+                ring.drain([this](const Record& record) { batch.push_back(record); });
+                it = retired ? rings.erase(it) : it + 1;
+            }
+        }
+
+        uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (batch.empty() && lost == 0) return;
+
+        std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+            return a.nanos < b.nanos;
+        });
+
+        output.clear();
+        for (const auto& record : batch) {
+            if (record.channel == 0 || record.channel > channels.size()) {
+                format(record);
+                continue;
+            }
+            // Channel lines share the timestamp cache, so build them in output and move them over
+            std::size_t start = output.size();
+            appendTimestamp(record.nanos);
+            output += ' ';
+            output.append(record.message, record.length);
+            if (record.suppressed) {
+                output += " suppressed=";
+                output += std::to_string(record.suppressed);
+            }
+            output += '\n';
+            channels[record.channel - 1].output.append(output, start, std::string::npos);
+            output.resize(start);
+        }
+        for (auto& channel : channels) {
+            if (channel.output.empty()) continue;
+            std::fwrite(channel.output.data(), 1, channel.output.size(), channel.file);
+            std::fflush(channel.file);
+            channel.output.clear();
+        }
+        if (lost) {
+            output += "{\"ts\":\"";
+            appendTimestamp(nowNanos());
+            output += "\",\"level\":\"warn\",\"src\":\"logging\",\"msg\":\"log rings full, records dropped\",\"dropped\":";
+            output += std::to_string(lost);
+            output += "}\n";
+        }
+
+        std::fwrite(output.data(), 1, output.size(), sink);
+        std::fflush(sink);
+    }
+
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    // Called by the LOG_* macros once the level and rate limit checks have passed
+    void submit(Level level, const CallSite& site, const Admission& admission, const Line& line,
+                uint8_t channel = 0) {
+        Ring& ring = localRing();
+        Record record;
+        record.nanos = admission.nanos;
+        record.site = &site;
+        record.thread = ring.thread;
+        record.suppressed = admission.suppressed;
+        record.level = level;
+        record.channel = channel;
+        record.length = static_cast<uint16_t>(line.size());
+        std::memcpy(record.message, line.data(), line.size());
+        if (!ring.push(record)) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void setLevel(Level level) {
+        minimumLevel().store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    // Write to the given file (appending) instead of stderr; returns false if it can't be opened
+    bool setOutputFile(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "a");
+        if (!file) return false;
+        std::lock_guard<std::mutex> lock(flushMutex);
+        if (ownsSink) std::fclose(sink);
+        sink = file;
+        ownsSink = true;
+        return true;
+    }
+
+    // Channel appending to path for LOG_TO, reusing one already open on it;
+    // 0 if the file can't be opened
+    uint8_t openChannel(const std::string& path) {
+        std::lock_guard<std::mutex> lock(flushMutex);
+        for (std::size_t i = 0; i < channels.size(); ++i) {
+            if (channels[i].path == path) return static_cast<uint8_t>(i + 1);
+        }
+        if (channels.size() == UINT8_MAX) return 0;
+        std::FILE* file = std::fopen(path.c_str(), "a");
+        if (!file) return 0;
+        channels.push_back({path, file, std::string()});
+        return static_cast<uint8_t>(channels.size());
+    }
+
+    // Write everything logged so far before returning
+    void sync() {
+        flush();
+    }
+};
+
+} // namespace logging
+
+#define CMS_LOG(level, expr)                                                           \
+    do {                                                                               \
+        if (::logging::enabled(level)) {                                               \
+            static ::logging::CallSite logCallSite_(__FILE__, __LINE__);               \
+            ::logging::Admission logAdmission_ = logCallSite_.admit();                 \
+            if (logAdmission_.admitted) {                                              \
+                ::logging::Line logLine_;                                              \
+                logLine_ << expr;                                                      \
+                ::logging::Logger::instance().submit(level, logCallSite_, logAdmission_, logLine_); \
+            }                                                                          \
+        }                                                                              \
+    } while (0)
+
+// Plain line to a channel from Logger::openChannel(); rate limited, not level filtered
+#define LOG_TO(channel, expr)                                                          \
+    do {                                                                               \
+        static ::logging::CallSite logCallSite_(__FILE__, __LINE__);                   \
+        ::logging::Admission logAdmission_ = logCallSite_.admit();                     \
+        if (logAdmission_.admitted) {                                                  \
+            ::logging::Line logLine_;                                                  \
+            logLine_ << expr;                                                          \
+            ::logging::Logger::instance().submit(::logging::Level::Info, logCallSite_, logAdmission_, \
+                                                 logLine_, channel);                   \
+        }                                                                              \
+    } while (0)
+
+#define LOG_DEBUG(expr) CMS_LOG(::logging::Level::Debug, expr)
+#define LOG_INFO(expr) CMS_LOG(::logging::Level::Info, expr)
+#define LOG_WARN(expr) CMS_LOG(::logging::Level::Warn, expr)
+#define LOG_ERROR(expr) CMS_LOG(::logging::Level::Error, expr)
@@ -0,0 +1,477 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Process-wide metrics with Prometheus text exposition.
+//
+// Counters and histograms keep one slot per writing thread. A thread only
+// ever updates its own slot with relaxed load/store pairs (no locked
+// read-modify-write), and slots are summed when /metrics is scraped, so
+// recording costs a few nanoseconds and never takes a lock. Metric handles
+// are resolved once (static locals or a RouteSet slot) and then used
+// directly on the hot path.
+namespace metrics {
+
+inline std::size_t nextMetricId() {
+    static std::atomic<std::size_t> nextId(0);
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Owns the per-thread slots of one metric. A thread's slot is folded into
+// the retired total when the thread exits, so pools that replace idle
+// threads do not leave a slot behind for each one.
+template <typename Slot>
+class PerThreadSlots {
+private:
+    // The slots a thread has attached to, released when it exits
+    struct ThreadSlots {
+        std::vector<Slot*> cache;  // by metric id
+        std::vector<std::pair<PerThreadSlots*, Slot*>> attached;
+
+        ~ThreadSlots() {
+            for (const auto& entry : attached) entry.first->retire(entry.second);
+        }
+    };
+
+    std::size_t id = nextMetricId();
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+    Slot retired;  // totals of threads that have exited
+
+    Slot& attach(ThreadSlots& thread) {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots.emplace_back(new Slot());
+        Slot* slot = slots.back().get();
+        if (thread.cache.size() <= id) thread.cache.resize(id + 1, nullptr);
+        thread.cache[id] = slot;
+        thread.attached.emplace_back(this, slot);
+        return *slot;
+    }
+
+    void retire(Slot* slot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired.absorb(*slot);
+        for (auto it = slots.begin(); it != slots.end(); ++it) {
+            if (it->get() == slot) {
+                slots.erase(it);
+                break;
+            }
+        }
+    }
+
+public:
+    Slot& local() {
+        thread_local ThreadSlots thread;
+        if (id < thread.cache.size() && thread.cache[id]) {
+            return *thread.cache[id];
+        }
+        return attach(thread);
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fn(retired);
+        for (const auto& slot : slots) {
+            fn(*slot);
+        }
+    }
+};
+
+// Single-writer increment: only the owning thread writes a slot
+inline void bump(std::atomic<uint64_t>& cell, uint64_t amount) {
+    cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+class Counter {
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+
+        void absorb(const Slot& other) { bump(value, other.value.load(std::memory_order_relaxed)); }
+    };
+    PerThreadSlots<Slot> slots;
+
+public:
+    void inc(uint64_t amount = 1) {
+        bump(slots.local().value, amount);
+    }
+
+    uint64_t value() {
+        uint64_t total = 0;
+        slots.forEach([&total](const Slot& slot) {
+            total += slot.value.load(std::memory_order_relaxed);
+        });
+        return total;
+    }
+};
+
+// Log-linear (HDR-style) histogram of nanosecond durations: four sub-buckets
+// per power of two, exported at power-of-two boundaries.
+class Histogram {
+public:
+    static constexpr int kSubBits = 2;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kMaxExponent = 40;  // ~18 minutes; larger values are clamped
+    static constexpr int kBucketCount = (kMaxExponent - kSubBits + 1) * kSubBuckets;
+
+    // Power-of-two exposition boundaries: 2^10 ns (~1us) .. 2^35 ns (~34s)
+    static constexpr int kFirstBoundary = 10;
+    static constexpr int kLastBoundary = 35;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> buckets[kBucketCount];
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+
+        Slot() {
+            for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        }
+
+        void absorb(const Slot& other) {
+            for (int i = 0; i < kBucketCount; ++i) bump(buckets[i], other.buckets[i].load(std::memory_order_relaxed));
+            bump(count, other.count.load(std::memory_order_relaxed));
+            bump(sum, other.sum.load(std::memory_order_relaxed));
+        }
+    };
+    PerThreadSlots<Slot> slots;
+
+public:
+    static int bucketFor(uint64_t value) {
+        if (value < static_cast<uint64_t>(kSubBuckets)) {
+            return static_cast<int>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        if (msb >= kMaxExponent) {
+            return kBucketCount - 1;
+        }
+        int shift = msb - kSubBits;
+        return (shift + 1) * kSubBuckets + static_cast<int>((value >> shift) - kSubBuckets);
+    }
+
+    void record(uint64_t nanos) {
+        Slot& slot = slots.local();
+        bump(slot.buckets[bucketFor(nanos)], 1);
+        bump(slot.count, 1);
+        bump(slot.sum, nanos);
+    }
+
+    void record(std::chrono::steady_clock::duration elapsed) {
+        record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    // Merged bucket counts across threads
+    std::vector<uint64_t> snapshot(uint64_t& count, uint64_t& sum) {
+        std::vector<uint64_t> merged(kBucketCount, 0);
+        count = 0;
+        sum = 0;
+        slots.forEach([&](const Slot& slot) {
+            for (int i = 0; i < kBucketCount; ++i) {
+                merged[i] += slot.buckets[i].load(std::memory_order_relaxed);
+            }
+            count += slot.count.load(std::memory_order_relaxed);
+            sum += slot.sum.load(std::memory_order_relaxed);
+        });
+        return merged;
+    }
+};
+
+// Records the lifetime of the scope into a histogram
+class ScopedTimer {
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        histogram.record(std::chrono::steady_clock::now() - start);
+    }
+};
+
+// Render a label set such as {route="GET /api/x",code="200"}
+inline std::string labels(const std::vector<std::pair<std::string, std::string>>& pairs) {
+    std::string out;
+    for (const auto& pair : pairs) {
+        if (!out.empty()) out += ",";
+        out += pair.first + "=\"";
+        for (char c : pair.second) {
+            if (c == '\\' || c == '"') out += '\\';
+            if (c == '\n') { out += "\\n"; continue; }
+            out += c;
+        }
+        out += "\"";
+    }
+    return out;
+}
+
+class Registry {
+private:
+    struct Family {
+        std::string help;
+        std::string type;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        std::map<std::string, std::function<double()>> gauges;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Family> families;
+
+    Family& family(const std::string& name, const std::string& help, const std::string& type) {
+        Family& f = families[name];
+        if (f.type.empty()) {
+            f.help = help;
+            f.type = type;
+        }
+        return f;
+    }
+
+    static void writeSeries(std::ostream& out, const std::string& name, const std::string& labelSet,
+                            const std::string& extraLabel = "") {
+        out << name;
+        if (!labelSet.empty() || !extraLabel.empty()) {
+            out << "{" << labelSet;
+            if (!labelSet.empty() && !extraLabel.empty()) out << ",";
+            out << extraLabel << "}";
+        }
+        out << " ";
+    }
+
+public:
+    // Never destroyed: threads still exiting during shutdown fold their slots into its metrics
+    static Registry& instance() {
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labelSet = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& slot = family(name, help, "counter").counters[labelSet];
+        if (!slot) slot.reset(new Counter());
+        return *slot;
+    }
+
+    Histogram& histogram(const std::string& name, const std::string& help, const std::string& labelSet = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& slot = family(name, help, "histogram").histograms[labelSet];
+        if (!slot) slot.reset(new Histogram());
+        return *slot;
+    }
+
+    // Gauges are sampled from a callback at scrape time
+    void gauge(const std::string& name, const std::string& help, std::function<double()> sample,
+               const std::string& labelSet = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        family(name, help, "gauge").gauges[labelSet] = std::move(sample);
+    }
+
+    void removeGauge(const std::string& name, const std::string& labelSet = "") {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = families.find(name);
+        if (it != families.end()) {
+            it->second.gauges.erase(labelSet);
+        }
+    }
+
+    // Prometheus text exposition format (version 0.0.4)
+    std::string exposition() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream out;
+        out.precision(9);
+        for (const auto& entry : families) {
+            const std::string& name = entry.first;
+            const Family& f = entry.second;
+            out << "# HELP " << name << " " << f.help << "\n";
+            out << "# TYPE " << name << " " << f.type << "\n";
+
+            for (const auto& series : f.counters) {
+                writeSeries(out, name, series.first);
+                out << series.second->value() << "\n";
+            }
+            for (const auto& series : f.gauges) {
+                writeSeries(out, name, series.first);
+                out << series.second() << "\n";
+            }
+            for (const auto& series : f.histograms) {
+                uint64_t count = 0, sum = 0;
+                std::vector<uint64_t> buckets = series.second->snapshot(count, sum);
+                uint64_t cumulative = 0;
+                int bucket = 0;
+                for (int exponent = Histogram::kFirstBoundary; exponent <= Histogram::kLastBoundary; ++exponent) {
+                    int limit = Histogram::bucketFor(1ULL << exponent);
+                    for (; bucket < limit; ++bucket) {
+                        cumulative += buckets[bucket];
+                    }
+                    std::ostringstream le;
+                    le.precision(6);
+                    le << "le=\"" << static_cast<double>(1ULL << exponent) / 1e9 << "\"";
+                    writeSeries(out, name + "_bucket", series.first, le.str());
+                    out << cumulative << "\n";
+                }
+                writeSeries(out, name + "_bucket", series.first, "le=\"+Inf\"");
+                out << count << "\n";
+                writeSeries(out, name + "_sum", series.first);
+                out << static_cast<double>(sum) / 1e9 << "\n";
+                writeSeries(out, name + "_count", series.first);
+                out << count << "\n";
+            }
+        }
+        return out.str();
+    }
+};
+
+// Hit/miss counters for an in-memory cache
+struct CacheStats {
+    Counter& hits;
+    Counter& misses;
+
+    void record(bool hit) {
+        (hit ? hits : misses).inc();
+    }
+};
+
+inline CacheStats cache(const std::string& cacheName) {
+    Registry& registry = Registry::instance();
+    return CacheStats{
+        registry.counter("cache_requests_total", "Cache lookups by cache and result",
+                         labels({{"cache", cacheName}, {"result", "hit"}})),
+        registry.counter("cache_requests_total", "Cache lookups by cache and result",
+                         labels({{"cache", cacheName}, {"result", "miss"}}))
+    };
+}
+
+// Latency of a database statement, identified by a stable statement ID
+inline Histogram& dbStatement(const std::string& statementId) {
+    return Registry::instance().histogram("db_statement_duration_seconds",
+        "Database statement latency by statement ID", labels({{"statement", statementId}}));
+}
+
+inline Histogram& alertFanout() {
+    static Histogram& histogram = Registry::instance().histogram("alert_fanout_duration_seconds",
+        "Time to record and fan out an alert broadcast to all subscribers");
+    return histogram;
+}
+
+// Per-route request latency and status code counters
+class RouteMetrics {
+private:
+    static constexpr int kCodeCount = 16;
+
+    Histogram* latency = nullptr;
+    Counter* codes[kCodeCount] = {};
+
+    // Codes the server sends get their own series; anything else counts
+    // under its class (2xx to 5xx)
+    static int codeIndex(int status) {
+        switch (status) {
+            case 200: return 0;
+            case 201: return 1;
+            case 304: return 2;
+            case 400: return 3;
+            case 401: return 4;
+            case 403: return 5;
+            case 404: return 6;
+            case 405: return 7;
+            case 429: return 8;
+            case 500: return 9;
+            case 503: return 10;
+            default:
+                if (status >= 200 && status < 600) return 11 + (status / 100 - 2);
+                return 15;
+        }
+    }
+
+    static const char* codeLabel(int index) {
+        static const char* names[kCodeCount] = {"200", "201", "304", "400", "401", "403", "404", "405", "429",
+                                                "500", "503", "2xx", "3xx", "4xx", "5xx", "other"};
+        return names[index];
+    }
+
+public:
+    explicit RouteMetrics(const std::string& route) {
+        Registry& registry = Registry::instance();
+        latency = &registry.histogram("http_request_duration_seconds",
+            "HTTP request latency by route", labels({{"route", route}}));
+        for (int i = 0; i < kCodeCount; ++i) {
+            codes[i] = &registry.counter("http_requests_total",
+                "HTTP requests by route and status code", labels({{"route", route}, {"code", codeLabel(i)}}));
+        }
+    }
+
+    void record(int status, std::chrono::steady_clock::duration elapsed) {
+        latency->record(elapsed);
+        codes[codeIndex(status)]->inc();
+    }
+};
+
+// Request metrics for a router's fixed list of routes. Labels come only from
+// that list, so whatever paths clients send, the series stay bounded;
+// requests no route matched share the "unmatched" series. Recording is an
+// array lookup by route and method; each handle is created on first use.
+class RouteSet {
+public:
+    static constexpr std::size_t kMethods = 7;
+
+private:
+    std::vector<std::string> routes;
+    std::unique_ptr<std::atomic<RouteMetrics*>[]> handles;  // [route][method], unmatched last
+    std::mutex mutex;
+    std::vector<std::unique_ptr<RouteMetrics>> owned;
+
+    static std::size_t methodIndex(const std::string& method) {
+        static const char* names[kMethods - 1] = {"GET", "POST", "PUT", "DELETE", "PATCH", "HEAD"};
+        for (std::size_t i = 0; i < kMethods - 1; ++i) {
+            if (method == names[i]) return i;
+        }
+        return kMethods - 1;
+    }
+
+    static const char* methodName(std::size_t index) {
+        static const char* names[kMethods] = {"GET", "POST", "PUT", "DELETE", "PATCH", "HEAD", "OTHER"};
+        return names[index];
+    }
+
+public:
+    explicit RouteSet(std::vector<std::string> prefixes)
+        : routes(std::move(prefixes)), handles(new std::atomic<RouteMetrics*>[(routes.size() + 1) * kMethods]) {
+        for (std::size_t i = 0; i < (routes.size() + 1) * kMethods; ++i) handles[i].store(nullptr);
+    }
+
+    // route is an index into the list, or its size for a request no route matched
+    void record(std::size_t route, const std::string& method, int status,
+                std::chrono::steady_clock::duration elapsed) {
+        if (route > routes.size()) route = routes.size();
+        std::size_t methodAt = route < routes.size() ? methodIndex(method) : 0;
+        std::atomic<RouteMetrics*>& handle = handles[route * kMethods + methodAt];
+        RouteMetrics* metrics = handle.load(std::memory_order_acquire);
+        if (!metrics) {
+            std::lock_guard<std::mutex> lock(mutex);
+            metrics = handle.load(std::memory_order_relaxed);
+            if (!metrics) {
+                std::string label = route < routes.size()
+                                        ? std::string(methodName(methodAt)) + " " + routes[route]
+                                        : std::string("unmatched");
+                owned.emplace_back(new RouteMetrics(label));
+                metrics = owned.back().get();
+                handle.store(metrics, std::memory_order_release);
+            }
+        }
+        metrics->record(status, elapsed);
+    }
+};
+
+} // namespace metrics
@@ -6,11 +6,23 @@
 #include <Poco/Data/Session.h>
 #include <Poco/Data/Statement.h>
 #include "../database/DatabaseManager.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+#include "../security/PasswordHasher.h"
+#include "../security/CredentialIndex.h"
+#include "../security/AuditLog.h"
 #include "AlertSystem.h"
+#include "FieldMapping.h"
+#include "Timestamp.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
 
+class Admin;
+// Defined after the class; declared first so its members can use the mapping
+template <>
+struct ModelFields<Admin>;
+
 // Model class for admin
 class Admin {
 private:
@@ -40,107 +52,84 @@ public:
 
     // Database operations
     bool save() {
+        static metrics::Histogram& latency = metrics::dbStatement("admins.save");
+        // Passwords are only ever stored hashed
+        if (!PasswordHasher::instance().ensureHashed(password)) {
+            LOG_WARN("Password hashing pool saturated, not saving admin");
+            return false;
+        }
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            std::string nameCopy = name;
-            std::string usernameCopy = username;
-            std::string passwordCopy = password;
-
             if (id == 0) {
-                // Insert new record
-                session << "INSERT INTO admins (name, username, password) VALUES (?, ?, ?)",
-                    use(nameCopy), use(usernameCopy), use(passwordCopy), now;
-                
-                // Get the inserted ID
-                session << "SELECT last_insert_rowid()", into(id), now;
+                fields::insert(session, *this);
             } else {
-                // Update existing record
-                session << "UPDATE admins SET name = ?, username = ?, password = ? WHERE id = ?",
-                    use(nameCopy), use(usernameCopy), use(passwordCopy), use(id), now;
+                fields::update(session, *this);
             }
+            CredentialIndex::instance().put("admin", username, id, password);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error saving admin: " << e.what() << std::endl;
+            LOG_ERROR("Error saving admin: " << e.what());
             return false;
         }
     }
 
     static Admin findById(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("admins.find_by_id");
+        metrics::ScopedTimer timer(latency);
         Admin admin;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "SELECT id, name, username, password FROM admins WHERE id = ?",
-                into(admin.id), into(admin.name), into(admin.username), into(admin.password),
-                use(id), now;
+            Statement select(session);
+            select << fields::selectSql<Admin>() << " WHERE id = ?", use(id);
+            admin = fields::fetchOne<Admin>(select);
         } catch (const std::exception& e) {
-            std::cerr << "Error finding admin: " << e.what() << std::endl;
+            LOG_ERROR("Error finding admin: " << e.what());
         }
         return admin;
     }
 
     static Admin findByUsername(const std::string& username) {
+        static metrics::Histogram& latency = metrics::dbStatement("admins.find_by_username");
+        metrics::ScopedTimer timer(latency);
         Admin admin;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             std::string usernameCopy = username;  // Create non-const copy
-            
-            // First check if the admin exists
-            Poco::Int64 count = 0;
-            session << "SELECT COUNT(*) FROM admins WHERE username = ?",
-                into(count),
-                use(usernameCopy),
-                now;
-            
-            if (count > 0) {
-                // If exists, get the admin details
-                session << "SELECT id, name, username, password FROM admins WHERE username = ?",
-                    into(admin.id),
-                    into(admin.name),
-                    into(admin.username),
-                    into(admin.password),
-                    use(usernameCopy),
-                    now;
-            }
+            Statement select(session);
+            select << fields::selectSql<Admin>() << " WHERE username = ?", use(usernameCopy);
+            admin = fields::fetchOne<Admin>(select);
         } catch (const std::exception& e) {
-            std::cerr << "Error finding admin by username: " << e.what() << std::endl;
+            LOG_ERROR("Error finding admin by username: " << e.what());
         }
         return admin;
     }
 
     static std::vector<Admin> findAll() {
+        static metrics::Histogram& latency = metrics::dbStatement("admins.find_all");
+        metrics::ScopedTimer timer(latency);
         std::vector<Admin> admins;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
-            int id;
-            std::string name, username, password;
-
-            select << "SELECT id, name, username, password FROM admins",
-                into(id), into(name), into(username), into(password),
-                range(0, 1);
-
-            while (!select.done()) {
-                select.execute();
-                Admin admin;
-                admin.id = id;
-                admin.name = name;
-                admin.username = username;
-                admin.password = password;
-                admins.push_back(admin);
-            }
+            select << fields::selectSql<Admin>();
+            admins = fields::fetch<Admin>(select);
         } catch (const std::exception& e) {
-            std::cerr << "Error finding all admins: " << e.what() << std::endl;
+            LOG_ERROR("Error finding all admins: " << e.what());
         }
         return admins;
     }
 
     static bool remove(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("admins.remove");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "DELETE FROM admins WHERE id = ?", use(id), now;
+            session << fields::deleteSql<Admin>(), use(id), now;
+            CredentialIndex::instance().erase("admin", id);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error removing admin: " << e.what() << std::endl;
+            LOG_ERROR("Error removing admin: " << e.what());
             return false;
         }
     }
@@ -148,10 +137,9 @@ public:
     // Authentication
     bool verifyPassword(const std::string& inputPassword) const {
         try {
-            // For now, just do a direct comparison since we're not hashing passwords yet
-            return password == inputPassword;
+            return PasswordHasher::instance().verify(inputPassword, password).status == HashStatus::Match;
         } catch (const std::exception& e) {
-            std::cerr << "Error verifying password: " << e.what() << std::endl;
+            LOG_ERROR("Error verifying password: " << e.what());
             return false;
         }
     }
@@ -176,7 +164,7 @@ public:
             session << "UPDATE help_requests SET verified = 1, verified_by = ? WHERE id = ?",
                 use(id), use(requestId), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error verifying help request: " << e.what() << std::endl;
+            LOG_ERROR("Error verifying help request: " << e.what());
         }
     }
 
@@ -184,39 +172,39 @@ public:
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             // Implementation for account management
-            session << "UPDATE user_accounts SET last_managed = datetime('now') WHERE managed_by = ?",
-                use(id), now;
+            Poco::Int64 lastManaged = nowMillis();
+            session << "UPDATE user_accounts SET last_managed = ? WHERE managed_by = ?",
+                use(lastManaged), use(id), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error managing accounts: " << e.what() << std::endl;
+            LOG_ERROR("Error managing accounts: " << e.what());
         }
     }
 
     void secureSystem() {
-        try {
-            Session& session = DatabaseManager::getInstance()->getSession();
-            // Implementation for system security
-            session << "INSERT INTO security_logs (admin_id, action, timestamp) VALUES (?, 'Security Check', datetime('now'))",
-                use(id), now;
-        } catch (const std::exception& e) {
-            std::cerr << "Error securing system: " << e.what() << std::endl;
+        if (!AuditLog::instance().append("security_check", "admin:" + std::to_string(id), "Security check by " + username)) {
+            LOG_ERROR("Error securing system: audit log unavailable");
         }
     }
 
     // Convert to JSON for API responses
     Poco::JSON::Object::Ptr toJSON() const {
-        Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
-        json->set("id", id);
-        json->set("name", name);
-        json->set("username", username);
-        return json;
+        return fields::toJSON(*this);
     }
 
     // Create from JSON for API requests
     static Admin fromJSON(const Poco::JSON::Object::Ptr& json) {
         Admin admin;
-        admin.setName(json->getValue<std::string>("name"));
-        admin.setUsername(json->getValue<std::string>("username"));
-        admin.setPassword(json->getValue<std::string>("password"));
+        fields::fromJSON(json, admin);
         return admin;
     }
-};
\ No newline at end of file
+};
+
+template <>
+struct ModelFields<Admin> {
+    static constexpr std::string_view table = "admins";
+    static constexpr auto all = std::make_tuple(
+        fields::field("id", "id", &Admin::getId, &Admin::setId, fields::Key),
+        fields::field("name", "name", &Admin::getName, &Admin::setName, fields::Required),
+        fields::field("username", "username", &Admin::getUsername, &Admin::setUsername, fields::Required),
+        fields::field("password", "password", &Admin::getPassword, &Admin::setPassword, fields::Required | fields::Secret));
+};
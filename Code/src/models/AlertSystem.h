@@ -2,11 +2,15 @@
 
 #include <string>
 #include <list>
+#include <Poco/Nullable.h>
 #include <Poco/JSON/Object.h>
 #include <Poco/JSON/Array.h>
 #include <Poco/Data/Session.h>
 #include <Poco/Data/Statement.h>
 #include "../database/DatabaseManager.h"
+#include "Timestamp.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
@@ -18,7 +22,7 @@ private:
     std::list<std::string> subscribers;
     int urgencyThreshold = 8;
     bool autoAssign = false;
-    std::string lastAlertTime;
+    EpochMillis lastAlertTime = kNoTimestamp;
     std::string lastAlertType;
     std::string lastAlertMessage;
 
@@ -31,7 +35,7 @@ public:
     const std::list<std::string>& getSubscribers() const { return subscribers; }
     int getUrgencyThreshold() const { return urgencyThreshold; }
     bool getAutoAssign() const { return autoAssign; }
-    std::string getLastAlertTime() const { return lastAlertTime; }
+    EpochMillis getLastAlertTime() const { return lastAlertTime; }
     std::string getLastAlertType() const { return lastAlertType; }
     std::string getLastAlertMessage() const { return lastAlertMessage; }
 
@@ -39,7 +43,7 @@ public:
     void setId(int id) { this->id = id; }
     void setUrgencyThreshold(int threshold) { urgencyThreshold = threshold; }
     void setAutoAssign(bool value) { autoAssign = value; }
-    void setLastAlertTime(const std::string& time) { lastAlertTime = time; }
+    void setLastAlertTime(EpochMillis time) { lastAlertTime = time; }
     void setLastAlertType(const std::string& type) { lastAlertType = type; }
     void setLastAlertMessage(const std::string& message) { lastAlertMessage = message; }
 
@@ -62,7 +66,7 @@ public:
             }
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error saving alert system: " << e.what() << std::endl;
+            LOG_ERROR("Error saving alert system: " << e.what());
             return false;
         }
     }
@@ -72,12 +76,14 @@ public:
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             int autoAssignInt;
+            Poco::Nullable<Poco::Int64> lastAlertTime;
             session << "SELECT id, urgency_threshold, auto_assign, last_alert_time, last_alert_type, last_alert_message "
                    << "FROM alert_system WHERE id = ?",
                 into(system.id), into(system.urgencyThreshold), into(autoAssignInt),
-                into(system.lastAlertTime), into(system.lastAlertType), into(system.lastAlertMessage),
+                into(lastAlertTime), into(system.lastAlertType), into(system.lastAlertMessage),
                 use(id), now;
             system.autoAssign = (autoAssignInt == 1);
+            system.lastAlertTime = lastAlertTime.isNull() ? kNoTimestamp : lastAlertTime.value();
         } catch (...) {}
         return system;
     }
@@ -87,17 +93,20 @@ public:
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             int autoAssignInt;
+            Poco::Nullable<Poco::Int64> lastAlertTime;
             session << "SELECT id, urgency_threshold, auto_assign, last_alert_time, last_alert_type, last_alert_message "
                    << "FROM alert_system LIMIT 1",
                 into(system.id), into(system.urgencyThreshold), into(autoAssignInt),
-                into(system.lastAlertTime), into(system.lastAlertType), into(system.lastAlertMessage), now;
+                into(lastAlertTime), into(system.lastAlertType), into(system.lastAlertMessage), now;
             system.autoAssign = (autoAssignInt == 1);
+            system.lastAlertTime = lastAlertTime.isNull() ? kNoTimestamp : lastAlertTime.value();
         } catch (...) {}
         return system;
     }
 
     // Methods from class diagram
     void broadcastAlertMessage(const std::string& message, const std::string& type = "General") {
+        metrics::ScopedTimer fanoutTimer(metrics::alertFanout());
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             
@@ -106,24 +115,27 @@ public:
             std::string typeCopy = type;
             
             // Record the alert
-            session << "INSERT INTO alert_history (type, message, timestamp) VALUES (?, ?, datetime('now'))",
-                use(typeCopy), use(messageCopy), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO alert_history (type, message, timestamp) VALUES (?, ?, ?)",
+                use(typeCopy), use(messageCopy), use(timestamp), now;
             
             // Update last alert info
-            session << "UPDATE alert_system SET last_alert_time = datetime('now'), last_alert_type = ?, last_alert_message = ? WHERE id = ?",
-                use(typeCopy), use(messageCopy), use(id), now;
+            Poco::Int64 alertTime = nowMillis();
+            session << "UPDATE alert_system SET last_alert_time = ?, last_alert_type = ?, last_alert_message = ? WHERE id = ?",
+                use(alertTime), use(typeCopy), use(messageCopy), use(id), now;
             
             // Notify subscribers
             for (const auto& subscriber : subscribers) {
                 std::string subscriberCopy = subscriber;
-                session << "INSERT INTO alert_notifications (subscriber, alert_type, message, timestamp) VALUES (?, ?, ?, datetime('now'))",
-                    use(subscriberCopy), use(typeCopy), use(messageCopy), now;
+                Poco::Int64 timestamp = nowMillis();
+                session << "INSERT INTO alert_notifications (subscriber, alert_type, message, timestamp) VALUES (?, ?, ?, ?)",
+                    use(subscriberCopy), use(typeCopy), use(messageCopy), use(timestamp), now;
             }
             
             // Log the broadcast
-            std::cout << "Broadcasting alert: " << message << " to " << subscribers.size() << " subscribers" << std::endl;
+            LOG_DEBUG("Broadcasting alert: " << message << " to " << subscribers.size() << " subscribers");
         } catch (const std::exception& e) {
-            std::cerr << "Error broadcasting alert: " << e.what() << std::endl;
+            LOG_ERROR("Error broadcasting alert: " << e.what());
         }
     }
     
@@ -136,7 +148,7 @@ public:
                 use(subscriberCopy), now;
             subscribers.push_back(subscriber);
         } catch (const std::exception& e) {
-            std::cerr << "Error adding subscriber: " << e.what() << std::endl;
+            LOG_ERROR("Error adding subscriber: " << e.what());
         }
     }
     
@@ -149,7 +161,7 @@ public:
                 use(subscriberCopy), now;
             subscribers.remove(subscriber);
         } catch (const std::exception& e) {
-            std::cerr << "Error removing subscriber: " << e.what() << std::endl;
+            LOG_ERROR("Error removing subscriber: " << e.what());
         }
     }
 
@@ -169,7 +181,7 @@ public:
                 subscribers.push_back(subscriber);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error loading subscribers: " << e.what() << std::endl;
+            LOG_ERROR("Error loading subscribers: " << e.what());
         }
     }
 
@@ -179,7 +191,8 @@ public:
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
-            std::string type, message, timestamp;
+            std::string type, message;
+            Poco::Nullable<Poco::Int64> timestamp;
 
             select << "SELECT type, message, timestamp FROM alert_history ORDER BY timestamp DESC LIMIT ?",
                 into(type), into(message), into(timestamp), use(limit), range(0, 1);
@@ -189,11 +202,11 @@ public:
                 std::map<std::string, std::string> alert;
                 alert["type"] = type;
                 alert["message"] = message;
-                alert["timestamp"] = timestamp;
+                alert["timestamp"] = formatTimestamp(timestamp.isNull() ? kNoTimestamp : timestamp.value());
                 history.push_back(alert);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error getting alert history: " << e.what() << std::endl;
+            LOG_ERROR("Error getting alert history: " << e.what());
         }
         return history;
     }
@@ -204,7 +217,8 @@ public:
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
-            std::string type, message, timestamp;
+            std::string type, message;
+            Poco::Nullable<Poco::Int64> timestamp;
             std::string subscriberCopy = subscriber;
 
             select << "SELECT alert_type, message, timestamp FROM alert_notifications "
@@ -216,11 +230,11 @@ public:
                 std::map<std::string, std::string> notification;
                 notification["type"] = type;
                 notification["message"] = message;
-                notification["timestamp"] = timestamp;
+                notification["timestamp"] = formatTimestamp(timestamp.isNull() ? kNoTimestamp : timestamp.value());
                 notifications.push_back(notification);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error getting pending notifications: " << e.what() << std::endl;
+            LOG_ERROR("Error getting pending notifications: " << e.what());
         }
         return notifications;
     }
@@ -234,7 +248,7 @@ public:
                 use(subscriberCopy), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error marking notifications as delivered: " << e.what() << std::endl;
+            LOG_ERROR("Error marking notifications as delivered: " << e.what());
             return false;
         }
     }
@@ -245,7 +259,7 @@ public:
         json->set("id", id);
         json->set("urgency_threshold", urgencyThreshold);
         json->set("auto_assign", autoAssign);
-        json->set("last_alert_time", lastAlertTime);
+        json->set("last_alert_time", formatTimestamp(lastAlertTime));
         json->set("last_alert_type", lastAlertType);
         json->set("last_alert_message", lastAlertMessage);
         
@@ -291,7 +305,7 @@ public:
             session << "UPDATE alert_config SET enabled = ? WHERE alert_type = ?",
                 use(enabled), use(typeCopy), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error setting alert enabled: " << e.what() << std::endl;
+            LOG_ERROR("Error setting alert enabled: " << e.what());
         }
     }
 };
\ No newline at end of file
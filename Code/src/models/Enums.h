@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Small fixed vocabularies stored as integer columns.
+//
+// Each enum's underlying value is its storage code, so the order of the
+// enumerators is part of the database format: append new values, never
+// reorder or remove. The name tables give the strings used in JSON and by
+// the frontend; parsing ignores case so legacy rows ("active", "Active")
+// map to the same value.
+
+enum class RequestStatus : uint8_t { Pending, InProgress, AidProvided, Resolved, Cancelled };
+
+enum class HelpType : uint8_t { Other, Food, Shelter, Medical, Evacuation };
+
+enum class OrgType : uint8_t { Other, Individual, NGO, PrivateCompany, InternationalOrganization, LocalCharity };
+
+enum class TaskStatus : uint8_t { Available, Assigned, Completed };
+
+enum class Urgency : uint8_t { Low, Medium, High, Critical };
+
+// Lifecycle of relief operations and the allocations, budgets and military requests attached to them
+enum class OperationStatus : uint8_t { Active, Pending, Available, Allocated, Completed };
+
+enum class EmergencyLevel : uint8_t { Normal, Low, Medium, High, Critical };
+
+// names: indexed by code; fallback: used for codes outside the table
+template <typename E>
+struct EnumTraits;
+
+template <>
+struct EnumTraits<RequestStatus> {
+    static constexpr const char* names[] = {"Pending", "In Progress", "Aid Provided", "Resolved", "Cancelled"};
+    static constexpr RequestStatus fallback = RequestStatus::Pending;
+};
+
+template <>
+struct EnumTraits<HelpType> {
+    static constexpr const char* names[] = {"Other", "Food", "Shelter", "Medical", "Evacuation"};
+    static constexpr HelpType fallback = HelpType::Other;
+};
+
+template <>
+struct EnumTraits<OrgType> {
+    static constexpr const char* names[] = {"Other", "Individual", "NGO", "Private Company",
+                                            "International Organization", "Local Charity"};
+    static constexpr OrgType fallback = OrgType::Other;
+};
+
+template <>
+struct EnumTraits<TaskStatus> {
+    static constexpr const char* names[] = {"Available", "Assigned", "Completed"};
+    static constexpr TaskStatus fallback = TaskStatus::Available;
+};
+
+template <>
+struct EnumTraits<Urgency> {
+    static constexpr const char* names[] = {"Low", "Medium", "High", "Critical"};
+    static constexpr Urgency fallback = Urgency::Medium;
+};
+
+template <>
+struct EnumTraits<OperationStatus> {
+    static constexpr const char* names[] = {"active", "pending", "available", "allocated", "completed"};
+    static constexpr OperationStatus fallback = OperationStatus::Pending;
+};
+
+template <>
+struct EnumTraits<EmergencyLevel> {
+    static constexpr const char* names[] = {"normal", "low", "medium", "high", "critical"};
+    static constexpr EmergencyLevel fallback = EmergencyLevel::Normal;
+};
+
+template <typename E>
+constexpr std::size_t enumCount() {
+    return sizeof(EnumTraits<E>::names) / sizeof(EnumTraits<E>::names[0]);
+}
+
+// Storage code, bound to INTEGER columns
+template <typename E>
+constexpr int enumCode(E value) {
+    return static_cast<int>(value);
+}
+
+// Value for a stored code; unknown codes read as the fallback
+template <typename E>
+constexpr E enumFromCode(int code) {
+    return code >= 0 && static_cast<std::size_t>(code) < enumCount<E>() ? static_cast<E>(code)
+                                                                         : EnumTraits<E>::fallback;
+}
+
+template <typename E>
+constexpr const char* enumName(E value) {
+    return EnumTraits<E>::names[static_cast<std::size_t>(enumFromCode<E>(enumCode(value)))];
+}
+
+constexpr char asciiLower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+// False if text names no value; value is left unchanged then
+template <typename E>
+constexpr bool parseEnum(std::string_view text, E& value) {
+    for (std::size_t i = 0; i < enumCount<E>(); ++i) {
+        if (equalsIgnoreCase(text, EnumTraits<E>::names[i])) {
+            value = static_cast<E>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// For open-ended input such as a request's type: unknown text becomes the fallback
+template <typename E>
+constexpr E parseEnumOr(std::string_view text, E fallback) {
+    E value = fallback;
+    parseEnum(text, value);
+    return value;
+}
+
+static_assert(enumFromCode<RequestStatus>(3) == RequestStatus::Resolved, "codes are enumerator order");
+static_assert(parseEnumOr("aid provided", RequestStatus::Pending) == RequestStatus::AidProvided, "parse ignores case");
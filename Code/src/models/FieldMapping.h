@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstddef>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <Poco/Exception.h>
+#include <Poco/Nullable.h>
+#include <Poco/Types.h>
+#include <Poco/Data/Session.h>
+#include <Poco/Data/Statement.h>
+#include <Poco/JSON/JSONException.h>
+#include <Poco/JSON/Object.h>
+#include "../api/Json.h"
+#include "Enums.h"
+#include "Fields.h"
+#include "Timestamp.h"
+
+// Row binding, row extraction and JSON encoding generated from ModelFields.
+// Columns travel as plain typed values bound with use()/into(), so no
+// RecordSet and no Dynamic::Var sits between a row and the model.
+
+namespace fields {
+
+// How a field's value is held for its column: enums and flags as INTEGER
+// codes, everything else as itself
+template <typename T, typename = void>
+struct Column {
+    using type = T;
+    static const T& store(const T& value) { return value; }
+    static const T& load(const type& value) { return value; }
+};
+
+template <>
+struct Column<bool> {
+    using type = int;
+    static int store(bool value) { return value ? 1 : 0; }
+    static bool load(int value) { return value != 0; }
+};
+
+template <typename E>
+struct Column<E, std::enable_if_t<std::is_enum<E>::value>> {
+    using type = int;
+    static int store(E value) { return enumCode(value); }
+    static E load(int value) { return enumFromCode<E>(value); }
+};
+
+// Nullable fields: the type's zero value travels as NULL
+template <typename T>
+struct NullableColumn {
+    using type = Poco::Nullable<typename Column<T>::type>;
+    static type store(const T& value) { return value == T() ? type() : type(Column<T>::store(value)); }
+    static T load(const type& value) { return value.isNull() ? T() : T(Column<T>::load(value.value())); }
+};
+
+// Timestamp fields: kNoTimestamp travels as NULL
+struct TimestampColumn {
+    using type = Poco::Nullable<Poco::Int64>;
+    static type store(EpochMillis value) { return value == kNoTimestamp ? type() : type(value); }
+    static EpochMillis load(const type& value) { return value.isNull() ? kNoTimestamp : value.value(); }
+};
+
+template <typename Model, std::size_t I>
+using ColumnOf = std::conditional_t<
+    std::get<I>(ModelFields<Model>::all).has(Timestamp), TimestampColumn,
+    std::conditional_t<std::get<I>(ModelFields<Model>::all).has(Nullable),
+                       NullableColumn<typename FieldAt<Model, I>::value_type>,
+                       Column<typename FieldAt<Model, I>::value_type>>>;
+
+template <typename Model, typename = std::make_index_sequence<fieldCount<Model>()>>
+struct RowTypes;
+
+template <typename Model, std::size_t... I>
+struct RowTypes<Model, std::index_sequence<I...>> {
+    using values = std::tuple<typename ColumnOf<Model, I>::type...>;
+    using columns = std::tuple<std::vector<typename ColumnOf<Model, I>::type>...>;
+};
+
+// Column values of one model, held so Poco can bind them by reference.
+// A statement bound to a Row can be executed again after assign() to run
+// it for another model without preparing it anew.
+template <typename Model>
+class Row {
+private:
+    typename RowTypes<Model>::values values;
+
+public:
+    Row() = default;
+
+    explicit Row(const Model& model) { assign(model); }
+
+    void assign(const Model& model) {
+        forEachField<Model>([&](const auto& field, auto i) {
+            std::get<decltype(i)::value>(values) = ColumnOf<Model, decltype(i)::value>::store((model.*field.get)());
+        });
+    }
+
+    // Every column but the key, in descriptor order; the key last when
+    // withKey, for UPDATE ... WHERE key = ?
+    void bind(Poco::Data::Statement& statement, bool withKey) {
+        forEachField<Model>([&](const auto& field, auto i) {
+            if (!field.has(Key)) statement, Poco::Data::Keywords::use(std::get<decltype(i)::value>(values));
+        });
+        if (withKey) statement, Poco::Data::Keywords::use(std::get<keyPosition<Model>()>(values));
+    }
+};
+
+template <typename Model>
+void setKey(Model& model, Poco::Int64 id) {
+    constexpr std::size_t key = keyPosition<Model>();
+    using KeyType = typename FieldAt<Model, key>::value_type;
+    (model.*std::get<key>(ModelFields<Model>::all).set)(static_cast<KeyType>(id));
+}
+
+// Inserts model and sets its key to the new row's id
+template <typename Model>
+void insert(Poco::Data::Session& session, Model& model) {
+    Row<Model> row(model);
+    Poco::Data::Statement insert(session);
+    insert << insertSql<Model>();
+    row.bind(insert, false);
+    insert.execute();
+
+    Poco::Int64 lastId = 0;
+    session << "SELECT last_insert_rowid()", Poco::Data::Keywords::into(lastId), Poco::Data::Keywords::now;
+    setKey(model, lastId);
+}
+
+template <typename Model>
+void update(Poco::Data::Session& session, const Model& model) {
+    Row<Model> row(model);
+    Poco::Data::Statement update(session);
+    update << updateSql<Model>();
+    row.bind(update, true);
+    update.execute();
+}
+
+// Runs a statement that starts with selectSql<Model>() and has its own
+// parameters bound, extracting column-wise in one pass and building one
+// model per row
+template <typename Model>
+std::vector<Model> fetch(Poco::Data::Statement& select) {
+    typename RowTypes<Model>::columns columns;
+    forEachField<Model>([&](const auto&, auto i) {
+        select, Poco::Data::Keywords::into(std::get<decltype(i)::value>(columns));
+    });
+    select.execute();
+
+    std::vector<Model> models(std::get<0>(columns).size());
+    forEachField<Model>([&](const auto& field, auto i) {
+        const auto& column = std::get<decltype(i)::value>(columns);
+        for (std::size_t row = 0; row < models.size(); ++row) {
+            (models[row].*field.set)(ColumnOf<Model, decltype(i)::value>::load(column[row]));
+        }
+    });
+    return models;
+}
+
+// First row, or a default model (key 0) when there is none
+template <typename Model>
+Model fetchOne(Poco::Data::Statement& select) {
+    std::vector<Model> models = fetch<Model>(select);
+    return models.empty() ? Model() : std::move(models.front());
+}
+
+// Every field but Secret ones: enums by name, Timestamp fields as datetime text
+template <typename Model>
+Poco::JSON::Object::Ptr toJSON(const Model& model) {
+    Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
+    forEachField<Model>([&](const auto& field, auto) {
+        using T = typename std::decay_t<decltype(field)>::value_type;
+        if (field.has(Secret)) return;
+        std::string name(field.name);
+        const auto& value = (model.*field.get)();
+        if constexpr (std::is_enum<T>::value) {
+            json->set(name, enumName(value));
+        } else if constexpr (std::is_same<T, EpochMillis>::value) {
+            if (field.has(Timestamp)) {
+                json->set(name, formatTimestamp(value));
+            } else {
+                json->set(name, value);
+            }
+        } else {
+            json->set(name, value);
+        }
+    });
+    return json;
+}
+
+// Same members as toJSON(), streamed into an object the caller has opened
+template <typename Model>
+void writeFields(json::Writer& writer, const Model& model) {
+    forEachField<Model>([&](const auto& field, auto) {
+        using T = typename std::decay_t<decltype(field)>::value_type;
+        if (field.has(Secret)) return;
+        const auto& value = (model.*field.get)();
+        if constexpr (std::is_enum<T>::value) {
+            writer.field(field.name, enumName(value));
+        } else if constexpr (std::is_same<T, EpochMillis>::value) {
+            if (field.has(Timestamp)) {
+                char text[kTimestampLength];
+                writer.field(field.name, std::string_view(text, formatTimestamp(value, text)));
+            } else {
+                writer.field(field.name, value);
+            }
+        } else {
+            writer.field(field.name, value);
+        }
+    });
+}
+
+template <typename Model>
+void writeJSON(json::Writer& writer, const Model& model) {
+    writer.beginObject();
+    writeFields(writer, model);
+    writer.endObject();
+}
+
+// Sets the members of an already parsed object that name fields of Model,
+// under json::Decoder's rules: Required fields must be present, enum names
+// must be known unless OpenEnum, Timestamp fields take text or a number.
+// Throws Poco::JSON::JSONException naming the field otherwise.
+template <typename Model>
+void fromJSON(const Poco::JSON::Object::Ptr& json, Model& model) {
+    forEachField<Model>([&](const auto& field, auto) {
+        using T = typename std::decay_t<decltype(field)>::value_type;
+        std::string name(field.name);
+        if (!json->has(name)) {
+            if (field.has(Required)) throw Poco::JSON::JSONException("missing field '" + name + "'");
+            return;
+        }
+        T value{};
+        bool ok = true;
+        try {
+            if constexpr (std::is_enum<T>::value) {
+                ok = parseEnum(json->getValue<std::string>(name), value);
+                if (!ok && field.has(OpenEnum)) {
+                    value = EnumTraits<T>::fallback;
+                    ok = true;
+                }
+            } else if constexpr (std::is_same<T, EpochMillis>::value) {
+                Poco::Dynamic::Var member = json->get(name);
+                if (field.has(Timestamp) && member.isString()) {
+                    ok = parseTimestamp(member.toString(), value);
+                } else {
+                    value = member.convert<T>();
+                }
+            } else {
+                value = json->getValue<T>(name);
+            }
+        } catch (const Poco::Exception&) {
+            ok = false;
+        }
+        if (!ok) throw Poco::JSON::JSONException("invalid value for field '" + name + "'");
+        (model.*field.set)(value);
+    });
+}
+
+// Sets one field from text such as a CSV cell, under the rules JSON input
+// follows: integers in range, true/false (or 1/0) for flags, enum names the
+// enum knows unless OpenEnum, datetime text or epoch milliseconds of at
+// least kMinMillisDigits digits for Timestamp fields. False, leaving the model unchanged, if text is invalid.
+template <typename Model, typename Field>
+bool setFromText(Model& model, const Field& field, std::string_view text) {
+    using T = typename Field::value_type;
+    T value{};
+    if constexpr (std::is_same<T, bool>::value) {
+        if (equalsIgnoreCase(text, "true") || text == "1") {
+            value = true;
+        } else if (!equalsIgnoreCase(text, "false") && text != "0") {
+            return false;
+        }
+    } else if constexpr (std::is_enum<T>::value) {
+        if (!parseEnum(text, value)) {
+            if (!field.has(OpenEnum)) return false;
+            value = EnumTraits<T>::fallback;
+        }
+    } else if constexpr (std::is_integral<T>::value) {
+        if (std::is_same<T, EpochMillis>::value && field.has(Timestamp)) {
+            EpochMillis millis = 0;
+            if (!parseTimestampOrMillis(text, millis)) return false;
+            value = static_cast<T>(millis);
+        } else {
+            if (text.empty() || text.size() > 20) return false;
+            char digits[21];
+            text.copy(digits, text.size());
+            digits[text.size()] = '\0';
+            char* end = nullptr;
+            errno = 0;
+            long long number = std::strtoll(digits, &end, 10);
+            if (errno != 0 || end != digits + text.size() || number < std::numeric_limits<T>::min() ||
+                number > std::numeric_limits<T>::max()) {
+                return false;
+            }
+            value = static_cast<T>(number);
+        }
+    } else if constexpr (std::is_floating_point<T>::value) {
+        std::string digits(text);
+        char* end = nullptr;
+        double number = std::strtod(digits.c_str(), &end);
+        if (digits.empty() || end != digits.c_str() + digits.size()) return false;
+        value = static_cast<T>(number);
+    } else {
+        static_assert(std::is_same<T, std::string>::value, "unsupported field type");
+        value.assign(text.data(), text.size());
+    }
+    (model.*field.set)(std::move(value));
+    return true;
+}
+
+}  // namespace fields
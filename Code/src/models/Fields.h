@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Compile-time description of a model's fields.
+//
+// Each model lists its fields once, as a constexpr tuple of descriptors
+// holding the JSON name, the column name and the getter/setter pair, next to
+// the table it lives in. Everything that moves models in and out of other
+// representations is generated from that list: the statement text below, the
+// row binding and extraction and the JSON encoders in FieldMapping.h, and
+// json::Decoder. The tuple is expanded at compile time, so a field costs a
+// direct member call: no name lookup through a map, no virtual dispatch, no
+// Dynamic::Var in between.
+
+namespace fields {
+
+enum Flags : unsigned {
+    None = 0,
+    Required = 1 << 0,   // rejected when absent from input
+    Timestamp = 1 << 1,  // EpochMillis, NULL when unset; accepts datetime text as well as a number
+    OpenEnum = 1 << 2,   // unknown names read as the enum's fallback instead of failing
+    Key = 1 << 3,        // primary key: assigned on insert, matched on update
+    Secret = 1 << 4,     // read from input and stored, never written to JSON
+    Nullable = 1 << 5,   // 0 or "" is stored as NULL, so unset values pass a UNIQUE column
+};
+
+// Value type a setter takes: int for setId(int), std::string for
+// setName(const std::string&)
+template <typename Setter>
+struct SetterTraits;
+
+template <typename Model, typename Arg>
+struct SetterTraits<void (Model::*)(Arg)> {
+    using model_type = Model;
+    using value_type = std::decay_t<Arg>;
+};
+
+template <typename Getter, typename Setter>
+struct Field {
+    using model_type = typename SetterTraits<Setter>::model_type;
+    using value_type = typename SetterTraits<Setter>::value_type;
+
+    std::string_view name;
+    std::string_view column;
+    Getter get;
+    Setter set;
+    unsigned flags;
+
+    constexpr bool has(Flags flag) const { return (flags & flag) != 0; }
+};
+
+template <typename Getter, typename Setter>
+constexpr Field<Getter, Setter> field(std::string_view name, std::string_view column, Getter get, Setter set,
+                                      unsigned flags = None) {
+    return Field<Getter, Setter>{name, column, get, set, flags};
+}
+
+}  // namespace fields
+
+// Specialised next to each model:
+//   template <> struct ModelFields<T> {
+//       static constexpr std::string_view table = "...";
+//       static constexpr auto all = std::make_tuple(fields::field(...), ...);
+//   };
+template <typename Model>
+struct ModelFields;
+
+template <typename Model>
+constexpr std::size_t fieldCount() {
+    return std::tuple_size<std::decay_t<decltype(ModelFields<Model>::all)>>::value;
+}
+
+template <typename Model, std::size_t I>
+using FieldAt = std::tuple_element_t<I, std::decay_t<decltype(ModelFields<Model>::all)>>;
+
+// Calls f(descriptor, std::integral_constant<std::size_t, I>) for every field in order
+template <typename Model, typename F, std::size_t... I>
+constexpr void forEachField(F&& f, std::index_sequence<I...>) {
+    (f(std::get<I>(ModelFields<Model>::all), std::integral_constant<std::size_t, I>()), ...);
+}
+
+template <typename Model, typename F>
+constexpr void forEachField(F&& f) {
+    forEachField<Model>(std::forward<F>(f), std::make_index_sequence<fieldCount<Model>()>());
+}
+
+namespace fields {
+
+// Position of the Key field
+template <typename Model>
+constexpr std::size_t keyIndex() {
+    std::size_t index = fieldCount<Model>();
+    std::size_t keys = 0;
+    forEachField<Model>([&](const auto& field, auto i) {
+        if (field.has(Key)) {
+            index = decltype(i)::value;
+            ++keys;
+        }
+    });
+    return keys == 1 ? index : fieldCount<Model>();
+}
+
+// keyIndex() for indexing the descriptors: a model without exactly one Key
+// field stops at this assertion instead of at an out-of-range std::get
+template <typename Model>
+constexpr std::size_t keyPosition() {
+    static_assert(keyIndex<Model>() < fieldCount<Model>(), "a model needs exactly one Key field");
+    return keyIndex<Model>() < fieldCount<Model>() ? keyIndex<Model>() : 0;
+}
+
+enum class Sql { Select, Insert, Update, Delete };
+
+// Statement text is written twice at compile time: once into a counter to
+// size the buffer, once into the buffer itself
+struct SqlLength {
+    std::size_t size = 0;
+    constexpr void append(std::string_view text) { size += text.size(); }
+};
+
+template <std::size_t N>
+struct SqlText {
+    char text[N + 1] = {};
+    std::size_t size = 0;
+
+    constexpr void append(std::string_view part) {
+        for (char c : part) text[size++] = c;
+    }
+    constexpr std::string_view view() const { return std::string_view(text, size); }
+};
+
+// SELECT lists every column; INSERT and UPDATE every column but the key, in
+// descriptor order, which is also the order Row binds them in
+template <typename Model, Sql kind, typename Out>
+constexpr void writeSql(Out& out) {
+    constexpr std::string_view table = ModelFields<Model>::table;
+    constexpr std::string_view key = std::get<keyPosition<Model>()>(ModelFields<Model>::all).column;
+    bool first = true;
+    auto separate = [&out, &first] {
+        if (!first) out.append(", ");
+        first = false;
+    };
+    switch (kind) {
+        case Sql::Select:
+            out.append("SELECT ");
+            forEachField<Model>([&](const auto& field, auto) {
+                separate();
+                out.append(field.column);
+            });
+            out.append(" FROM ");
+            out.append(table);
+            break;
+        case Sql::Insert:
+            out.append("INSERT INTO ");
+            out.append(table);
+            out.append(" (");
+            forEachField<Model>([&](const auto& field, auto) {
+                if (field.has(Key)) return;
+                separate();
+                out.append(field.column);
+            });
+            out.append(") VALUES (");
+            first = true;
+            forEachField<Model>([&](const auto& field, auto) {
+                if (field.has(Key)) return;
+                separate();
+                out.append("?");
+            });
+            out.append(")");
+            break;
+        case Sql::Update:
+            out.append("UPDATE ");
+            out.append(table);
+            out.append(" SET ");
+            forEachField<Model>([&](const auto& field, auto) {
+                if (field.has(Key)) return;
+                separate();
+                out.append(field.column);
+                out.append(" = ?");
+            });
+            out.append(" WHERE ");
+            out.append(key);
+            out.append(" = ?");
+            break;
+        case Sql::Delete:
+            out.append("DELETE FROM ");
+            out.append(table);
+            out.append(" WHERE ");
+            out.append(key);
+            out.append(" = ?");
+            break;
+    }
+}
+
+template <typename Model, Sql kind>
+constexpr std::size_t sqlLength() {
+    SqlLength length;
+    writeSql<Model, kind>(length);
+    return length.size;
+}
+
+template <typename Model, Sql kind>
+constexpr SqlText<sqlLength<Model, kind>()> makeSql() {
+    SqlText<sqlLength<Model, kind>()> text;
+    writeSql<Model, kind>(text);
+    return text;
+}
+
+template <typename Model, Sql kind>
+inline constexpr auto sqlText = makeSql<Model, kind>();
+
+// Accessors are deliberately not constexpr: models call them from their own
+// member functions, before their ModelFields specialisation is complete, and
+// a constexpr template would be instantiated on the spot. The text itself is
+// still built at compile time, in sqlText.
+
+// "SELECT <columns> FROM <table>", for callers to append WHERE/ORDER BY to
+template <typename Model>
+inline std::string_view selectSql() { return sqlText<Model, Sql::Select>.view(); }
+
+template <typename Model>
+inline std::string_view insertSql() { return sqlText<Model, Sql::Insert>.view(); }
+
+template <typename Model>
+inline std::string_view updateSql() { return sqlText<Model, Sql::Update>.view(); }
+
+template <typename Model>
+inline std::string_view deleteSql() { return sqlText<Model, Sql::Delete>.view(); }
+
+}  // namespace fields
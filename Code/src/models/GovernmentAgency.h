@@ -5,10 +5,22 @@
 #include <Poco/Data/Session.h>
 #include <Poco/Data/Statement.h>
 #include "../database/DatabaseManager.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+#include "../security/PasswordHasher.h"
+#include "../security/CredentialIndex.h"
+#include "Enums.h"
+#include "FieldMapping.h"
+#include "Timestamp.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
 
+class GovernmentAgency;
+// Defined after the class; declared first so its members can use the mapping
+template <>
+struct ModelFields<GovernmentAgency>;
+
 class GovernmentAgency {
 private:
     int id = 0;
@@ -35,107 +47,100 @@ public:
 
     // JSON serialization
     Poco::JSON::Object::Ptr toJSON() const {
-        Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
-        json->set("id", id);
-        json->set("agencyName", agencyName);
-        json->set("severityLevel", severityLevel);
-        json->set("username", username);
-        return json;
+        return fields::toJSON(*this);
     }
 
     // Save or update
     bool save() {
+        static metrics::Histogram& latency = metrics::dbStatement("government_agencies.save");
+        // Passwords are only ever stored hashed
+        if (!PasswordHasher::instance().ensureHashed(password)) {
+            LOG_WARN("Password hashing pool saturated, not saving government agency");
+            return false;
+        }
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            std::string insertQuery = "INSERT INTO government_agencies (agency_name, severity_level, username, password) VALUES (?, ?, ?, ?)";
-            std::string updateQuery = "UPDATE government_agencies SET agency_name = ?, severity_level = ?, username = ?, password = ? WHERE id = ?";
-            std::string lastIdQuery = "SELECT last_insert_rowid()";
-            
             if (id == 0) {
-                session << insertQuery,
-                    use(agencyName), use(severityLevel), use(username), use(password), now;
-                Poco::Int64 lastId;
-                session << lastIdQuery, into(lastId), now;
-                id = static_cast<int>(lastId);
+                fields::insert(session, *this);
             } else {
-                session << updateQuery,
-                    use(agencyName), use(severityLevel), use(username), use(password), use(id), now;
+                fields::update(session, *this);
             }
+            CredentialIndex::instance().put("government_agency", username, id, password);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Save error: " << e.what() << std::endl;
+            LOG_ERROR("Save error: " << e.what());
             return false;
         }
     }
 
     static GovernmentAgency findById(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("government_agencies.find_by_id");
+        metrics::ScopedTimer timer(latency);
         GovernmentAgency agency;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "SELECT id, agency_name, severity_level, username, password FROM government_agencies WHERE id = ?",
-                into(agency.id), into(agency.agencyName), into(agency.severityLevel),
-                into(agency.username), into(agency.password), use(id), now;
+            Statement select(session);
+            select << fields::selectSql<GovernmentAgency>() << " WHERE id = ?", use(id);
+            agency = fields::fetchOne<GovernmentAgency>(select);
         } catch (...) {}
         return agency;
     }
 
     static GovernmentAgency findByUsername(const std::string& uname) {
+        static metrics::Histogram& latency = metrics::dbStatement("government_agencies.find_by_username");
+        metrics::ScopedTimer timer(latency);
         GovernmentAgency agency;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             std::string username=uname;
-            session << "SELECT id, agency_name, severity_level, username, password FROM government_agencies WHERE username = ?",
-                into(agency.id), into(agency.agencyName), into(agency.severityLevel),
-                into(agency.username), into(agency.password), use(username), now;
+            Statement select(session);
+            select << fields::selectSql<GovernmentAgency>() << " WHERE username = ?", use(username);
+            agency = fields::fetchOne<GovernmentAgency>(select);
         } catch (...) {}
         return agency;
     }
 
     static bool remove(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("government_agencies.remove");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "DELETE FROM government_agencies WHERE id = ?", use(id), now;
+            session << fields::deleteSql<GovernmentAgency>(), use(id), now;
+            CredentialIndex::instance().erase("government_agency", id);
             return true;
         } catch (...) { return false; }
     }
 
     static std::vector<GovernmentAgency> findAll() {
+        static metrics::Histogram& latency = metrics::dbStatement("government_agencies.find_all");
+        metrics::ScopedTimer timer(latency);
         std::vector<GovernmentAgency> list;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Poco::Data::Statement select(session);
-            int id, severity; std::string name, uname, pwd;
-
-            select << "SELECT id, agency_name, severity_level, username, password FROM government_agencies",
-                into(id), into(name), into(severity), into(uname), into(pwd), range(0, 1);
-
-            while (!select.done()) {
-                select.execute();
-                GovernmentAgency agency;
-                agency.setId(id); agency.setAgencyName(name);
-                agency.setSeverityLevel(severity);
-                agency.setUsername(uname);
-                agency.setPassword(pwd);
-                list.push_back(agency);
-            }
+            select << fields::selectSql<GovernmentAgency>();
+            list = fields::fetch<GovernmentAgency>(select);
         } catch (...) {}
         return list;
     }
 
     bool verifyPassword(const std::string& input) const {
-        return input == password; // Replace with hashed comparison for production
+        return PasswordHasher::instance().verify(input, password).status == HashStatus::Match;
     }
     bool offerAid(int requestId, const std::string& aidType) {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             std::string description = "Aid provided for request ID: " + std::to_string(requestId);
             std::string aidTypeStr = "Aid";
-            session << "UPDATE help_requests SET status = 'Aid Provided' WHERE id = ?", use(requestId), now;
-            session << "INSERT INTO alerts (type, message, timestamp, sender) VALUES (?, ?, datetime('now'), ?)",
-                use(aidTypeStr), use(description), use(agencyName), now;
+            int aidProvided = enumCode(RequestStatus::AidProvided);
+            session << "UPDATE help_requests SET status = ? WHERE id = ?", use(aidProvided), use(requestId), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO alerts (type, message, timestamp, sender) VALUES (?, ?, ?, ?)",
+                use(aidTypeStr), use(description), use(timestamp), use(agencyName), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "offerAid Error: " << e.what() << std::endl;
+            LOG_ERROR("offerAid Error: " << e.what());
             return false;
         }
     }
@@ -170,7 +175,7 @@ public:
             }
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "allocateResources Error: " << e.what() << std::endl;
+            LOG_ERROR("allocateResources Error: " << e.what());
             return false;
         }
     }
@@ -183,12 +188,13 @@ public:
             session << "UPDATE government_agencies SET severity_level = ? WHERE id = ?", use(severityLevel), use(id), now;
 
             std::string alert = "EMERGENCY PROTOCOL triggered by " + agencyName;
-            session << "INSERT INTO alerts (type, message, timestamp, sender) VALUES (?, ?, datetime('now'), ?)",
-                use(emergencyType), use(alert), use(agencyName), now;
+            Poco::Int64 timestamp = nowMillis();
+            session << "INSERT INTO alerts (type, message, timestamp, sender) VALUES (?, ?, ?, ?)",
+                use(emergencyType), use(alert), use(timestamp), use(agencyName), now;
 
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "emergencyProtocol Error: " << e.what() << std::endl;
+            LOG_ERROR("emergencyProtocol Error: " << e.what());
             return false;
         }
     }
@@ -199,12 +205,12 @@ public:
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
             int requestId;
-            std::string status;
-            select << "SELECT id, status FROM help_requests WHERE status = 'Aid Provided'",
-                into(requestId), into(status), range(0, 1);
+            int aidProvided = enumCode(RequestStatus::AidProvided);
+            select << "SELECT id FROM help_requests WHERE status = ?",
+                into(requestId), use(aidProvided), range(0, 1);
             while (!select.done()) {
                 select.execute();
-                results.push_back("Request ID: " + std::to_string(requestId) + " => " + status);
+                results.push_back("Request ID: " + std::to_string(requestId) + " => " + enumName(RequestStatus::AidProvided));
             }
         } catch (...) {
             results.push_back("Error tracking efforts.");
@@ -216,50 +222,66 @@ public:
     void trackSeverity() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO severity_tracking (agency_id, tracking_date) VALUES (?, datetime('now'))",
-                use(id), now;
+            Poco::Int64 trackingDate = nowMillis();
+            session << "INSERT INTO severity_tracking (agency_id, tracking_date) VALUES (?, ?)",
+                use(id), use(trackingDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error tracking severity: " << e.what() << std::endl;
+            LOG_ERROR("Error tracking severity: " << e.what());
         }
     }
 
     void provisionResources() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO resource_provision (agency_id, provision_date) VALUES (?, datetime('now'))",
-                use(id), now;
+            Poco::Int64 provisionDate = nowMillis();
+            session << "INSERT INTO resource_provision (agency_id, provision_date) VALUES (?, ?)",
+                use(id), use(provisionDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error provisioning resources: " << e.what() << std::endl;
+            LOG_ERROR("Error provisioning resources: " << e.what());
         }
     }
 
     void allocatePersonnel() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO personnel_allocation (agency_id, allocation_date) VALUES (?, datetime('now'))",
-                use(id), now;
+            Poco::Int64 allocationDate = nowMillis();
+            session << "INSERT INTO personnel_allocation (agency_id, allocation_date) VALUES (?, ?)",
+                use(id), use(allocationDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error allocating personnel: " << e.what() << std::endl;
+            LOG_ERROR("Error allocating personnel: " << e.what());
         }
     }
 
     void emergencyBudget() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO emergency_budget (agency_id, budget_date) VALUES (?, datetime('now'))",
-                use(id), now;
+            Poco::Int64 budgetDate = nowMillis();
+            session << "INSERT INTO emergency_budget (agency_id, budget_date) VALUES (?, ?)",
+                use(id), use(budgetDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error creating emergency budget: " << e.what() << std::endl;
+            LOG_ERROR("Error creating emergency budget: " << e.what());
         }
     }
 
     void callMilitary() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO military_calls (agency_id, call_date) VALUES (?, datetime('now'))",
-                use(id), now;
+            Poco::Int64 callDate = nowMillis();
+            session << "INSERT INTO military_calls (agency_id, call_date) VALUES (?, ?)",
+                use(id), use(callDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error calling military: " << e.what() << std::endl;
+            LOG_ERROR("Error calling military: " << e.what());
         }
     }
 };
+
+template <>
+struct ModelFields<GovernmentAgency> {
+    static constexpr std::string_view table = "government_agencies";
+    static constexpr auto all = std::make_tuple(
+        fields::field("id", "id", &GovernmentAgency::getId, &GovernmentAgency::setId, fields::Key),
+        fields::field("agencyName", "agency_name", &GovernmentAgency::getAgencyName, &GovernmentAgency::setAgencyName, fields::Required),
+        fields::field("severityLevel", "severity_level", &GovernmentAgency::getSeverityLevel, &GovernmentAgency::setSeverityLevel),
+        fields::field("username", "username", &GovernmentAgency::getUsername, &GovernmentAgency::setUsername, fields::Required),
+        fields::field("password", "password", &GovernmentAgency::getPassword, &GovernmentAgency::setPassword, fields::Required | fields::Secret));
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "../metrics/Metrics.h"
+
+// Process-wide pool of deduplicated strings.
+//
+// Fields such as locations repeat a few hundred distinct values across
+// thousands of rows. Each distinct value is stored once and named by a
+// 4-byte id that stays valid for the life of the process. Entries live in
+// fixed-size chunks that never move, so str()/view() are a couple of loads
+// with no lock; intern() takes a shared lock for the lookup and an
+// exclusive one only to add a new value. Id 0 is the empty string.
+//
+// Values are never removed, so the pool is capped at kMaxStrings values and
+// kMaxBytes of text. Once it is full, values it does not already hold are
+// not added: tryIntern() fails and InternedString keeps its own copy, so a
+// field such as location, which users type freely, can neither grow the pool
+// without bound nor make decoding fail.
+class InternPool {
+public:
+    using Id = uint32_t;
+
+    struct Stats {
+        std::size_t strings = 0;      // distinct values held
+        std::size_t bytes = 0;        // heap and entry bytes held by the pool
+        uint64_t lookups = 0;         // intern() calls
+        uint64_t hits = 0;            // ... that found an existing value
+    };
+
+private:
+    static constexpr std::size_t kChunkBits = 12;
+    static constexpr std::size_t kChunkSize = std::size_t(1) << kChunkBits;
+    static constexpr std::size_t kMaxChunks = 64;
+
+public:
+    static constexpr std::size_t kMaxStrings = kChunkSize * kMaxChunks;
+    static constexpr std::size_t kMaxBytes = 16 << 20;
+
+private:
+    std::array<std::atomic<std::string*>, kMaxChunks> chunks{};
+    std::unordered_map<std::string_view, Id> index;
+    mutable std::shared_mutex mutex;
+    std::size_t count = 0;
+    std::size_t heapBytes = 0;
+    std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> hits{0};
+    metrics::Counter& overflows = metrics::Registry::instance().counter(
+        "intern_pool_overflows_total", "Values kept outside the intern pool because it was full");
+
+    InternPool() {
+        add(std::string_view());
+        metrics::Registry& registry = metrics::Registry::instance();
+        registry.gauge("intern_pool_strings", "Distinct strings held by the intern pool",
+            [this]() { return static_cast<double>(stats().strings); });
+        registry.gauge("intern_pool_bytes", "Bytes held by the intern pool",
+            [this]() { return static_cast<double>(stats().bytes); });
+    }
+
+    std::string& entry(Id id) const {
+        return chunks[id >> kChunkBits].load(std::memory_order_acquire)[id & (kChunkSize - 1)];
+    }
+
+    // Caller holds the exclusive lock and has checked there is room
+    Id add(std::string_view value) {
+        Id id = static_cast<Id>(count);
+        std::size_t chunk = id >> kChunkBits;
+        if (!chunks[chunk].load(std::memory_order_relaxed)) {
+            chunks[chunk].store(new std::string[kChunkSize], std::memory_order_release);
+        }
+        std::string& slot = chunks[chunk].load(std::memory_order_relaxed)[id & (kChunkSize - 1)];
+        slot.assign(value.data(), value.size());
+        if (slot.capacity() > std::string().capacity()) {
+            heapBytes += slot.capacity() + 1;
+        }
+        index.emplace(std::string_view(slot), id);
+        ++count;
+        return id;
+    }
+
+public:
+    static InternPool& instance() {
+        static InternPool pool;
+        return pool;
+    }
+
+    InternPool(const InternPool&) = delete;
+    InternPool& operator=(const InternPool&) = delete;
+
+    // Id of value, adding it if there is room; false if the pool is full and
+    // does not hold it
+    bool tryIntern(std::string_view value, Id& id) {
+        id = 0;
+        if (value.empty()) return true;
+        lookups.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = index.find(value);
+            if (it != index.end()) {
+                hits.fetch_add(1, std::memory_order_relaxed);
+                id = it->second;
+                return true;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(value);
+        if (it != index.end()) {
+            hits.fetch_add(1, std::memory_order_relaxed);
+            id = it->second;
+            return true;
+        }
+        if (count == kMaxStrings || heapBytes + value.size() > kMaxBytes) {
+            overflows.inc();
+            return false;
+        }
+        id = add(value);
+        return true;
+    }
+
+    // Look up without adding; false if the value was never interned
+    bool find(std::string_view value, Id& id) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(value);
+        if (it == index.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    // Ids come from intern(), so their entry is already published
+    const std::string& str(Id id) const {
+        return entry(id);
+    }
+
+    std::string_view view(Id id) const {
+        return entry(id);
+    }
+
+    Stats stats() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        Stats result;
+        std::size_t allocatedChunks = (count + kChunkSize - 1) / kChunkSize;
+        result.strings = count;
+        result.bytes = heapBytes + allocatedChunks * kChunkSize * sizeof(std::string) +
+                       index.bucket_count() * sizeof(void*) +
+                       index.size() * (sizeof(std::string_view) + sizeof(Id) + 2 * sizeof(void*));
+        result.lookups = lookups.load(std::memory_order_relaxed);
+        result.hits = hits.load(std::memory_order_relaxed);
+        return result;
+    }
+};
+
+// A string field held as an intern pool id, or as its own copy when the
+// pool is full. Equal values are either both interned, with the same id, or
+// both owned: a value the pool refused once it will refuse again.
+class InternedString {
+private:
+    InternPool::Id id = 0;
+    std::shared_ptr<const std::string> owned;
+
+    void assign(std::string_view value) {
+        if (!InternPool::instance().tryIntern(value, id)) owned = std::make_shared<const std::string>(value);
+    }
+
+public:
+    InternedString() = default;
+    InternedString(std::string_view value) { assign(value); }
+    InternedString(const std::string& value) : InternedString(std::string_view(value)) {}
+    InternedString(const char* value) : InternedString(std::string_view(value)) {}
+
+    InternPool::Id handle() const { return id; }
+    const std::string& str() const { return owned ? *owned : InternPool::instance().str(id); }
+    std::string_view view() const { return owned ? std::string_view(*owned) : InternPool::instance().view(id); }
+    bool empty() const { return id == 0 && !owned; }
+
+    bool operator==(const InternedString& other) const {
+        if (owned || other.owned) return owned && other.owned && *owned == *other.owned;
+        return id == other.id;
+    }
+    bool operator!=(const InternedString& other) const { return !(*this == other); }
+};
+
+namespace std {
+template <>
+struct hash<InternedString> {
+    size_t operator()(const InternedString& value) const noexcept {
+        if (value.handle() == 0 && !value.empty()) return std::hash<std::string_view>()(value.view());
+        return std::hash<uint32_t>()(value.handle());
+    }
+};
+}
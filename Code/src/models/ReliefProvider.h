@@ -7,18 +7,31 @@
 #include <Poco/Data/Session.h>
 #include <Poco/Data/Statement.h>
 #include "../database/DatabaseManager.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+#include "../security/PasswordHasher.h"
+#include "../security/CredentialIndex.h"
+#include "Enums.h"
+#include "FieldMapping.h"
+#include "InternPool.h"
+#include "Timestamp.h"
 #include "PeopleInCrisis.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
 
+class ReliefProvider;
+// Defined after the class; declared first so its members can use the mapping
+template <>
+struct ModelFields<ReliefProvider>;
+
 // Model class for relief providers
 class ReliefProvider {
 private:
     int id;
     std::string name;
-    std::string orgType;
-    std::string location;
+    OrgType orgType;
+    InternedString location;
     std::string username;
     std::string password;
     std::vector<int> incidentReports;
@@ -26,36 +39,39 @@ private:
 
 public:
     // Constructor
-    ReliefProvider() : id(0) {}
+    ReliefProvider() : id(0), orgType(OrgType::Other) {}
     
-    ReliefProvider(const std::string& name, const std::string& orgType) 
+    ReliefProvider(const std::string& name, OrgType orgType) 
         : id(0), name(name), orgType(orgType) {}
 
     // Getters
     int getId() const { return id; }
     std::string getName() const { return name; }
-    std::string getOrgType() const { return orgType; }
-    std::string getLocation() const { return location; }
+    OrgType getOrgType() const { return orgType; }
+    const std::string& getLocation() const { return location.str(); }
     std::string getUsername() const { return username; }
+    std::string getPassword() const { return password; }
     std::vector<int> getIncidentReports() const { return incidentReports; }
     std::map<std::string, int> getResources() const { return resources; }
 
     // Setters
     void setId(int id) { this->id = id; }
     void setName(const std::string& name) { this->name = name; }
-    void setOrgType(const std::string& orgType) { this->orgType = orgType; }
-    void setLocation(const std::string& location) { this->location = location; }
+    void setOrgType(OrgType orgType) { this->orgType = orgType; }
+    void setLocation(const std::string& location) { this->location = InternedString(location); }
     void setUsername(const std::string& username) { this->username = username; }
     void setPassword(const std::string& password) { this->password = password; }
 
     // Methods from class diagram
     void accessIncidentReports() {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.access_incident_reports");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
             int reportId;
             std::string description;
-            std::string timestamp;
+            Poco::Int64 timestamp = kNoTimestamp;
 
             select << "SELECT id, description, timestamp FROM incident_reports WHERE provider_id = ?",
                 into(reportId), into(description), into(timestamp), use(id), range(0, 1);
@@ -68,7 +84,7 @@ public:
                 }
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error accessing incident reports: " << e.what() << std::endl;
+            LOG_ERROR("Error accessing incident reports: " << e.what());
         }
     }
     
@@ -91,148 +107,141 @@ public:
     void requestManpower() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO manpower_requests (provider_id, status, request_date) VALUES (?, 'Pending', datetime('now'))",
-                use(id), now;
+            Poco::Int64 requestDate = nowMillis();
+            session << "INSERT INTO manpower_requests (provider_id, status, request_date) VALUES (?, 'Pending', ?)",
+                use(id), use(requestDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting manpower: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting manpower: " << e.what());
         }
     }
 
     void requestGovtAid() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO government_aid_requests (provider_id, status, request_date) VALUES (?, 'Pending', datetime('now'))",
-                use(id), now;
+            Poco::Int64 requestDate = nowMillis();
+            session << "INSERT INTO government_aid_requests (provider_id, status, request_date) VALUES (?, 'Pending', ?)",
+                use(id), use(requestDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting government aid: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting government aid: " << e.what());
         }
     }
 
     void requestAdditionalAid() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO additional_aid_requests (provider_id, status, request_date) VALUES (?, 'Pending', datetime('now'))",
-                use(id), now;
+            Poco::Int64 requestDate = nowMillis();
+            session << "INSERT INTO additional_aid_requests (provider_id, status, request_date) VALUES (?, 'Pending', ?)",
+                use(id), use(requestDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting additional aid: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting additional aid: " << e.what());
         }
     }
 
     void requestMonetaryService() {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "INSERT INTO monetary_service_requests (provider_id, status, request_date) VALUES (?, 'Pending', datetime('now'))",
-                use(id), now;
+            Poco::Int64 requestDate = nowMillis();
+            session << "INSERT INTO monetary_service_requests (provider_id, status, request_date) VALUES (?, 'Pending', ?)",
+                use(id), use(requestDate), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error requesting monetary service: " << e.what() << std::endl;
+            LOG_ERROR("Error requesting monetary service: " << e.what());
         }
     }
 
     // Database operations
     bool save() {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.save");
+        // Passwords are only ever stored hashed
+        if (!PasswordHasher::instance().ensureHashed(password)) {
+            LOG_WARN("Password hashing pool saturated, not saving relief provider");
+            return false;
+        }
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            std::string nameCopy = name;
-            std::string locationCopy = location;
-            std::string usernameCopy = username;
-            std::string passwordCopy = password;
-
             if (id == 0) {
-                // Insert new record
-                session << "INSERT INTO relief_providers (name, location, username, password) VALUES (?, ?, ?, ?)",
-                    use(nameCopy), use(locationCopy), use(usernameCopy), use(passwordCopy), now;
-                
-                // Get the inserted ID
-                session << "SELECT last_insert_rowid()", into(id), now;
+                fields::insert(session, *this);
             } else {
-                // Update existing record
-                session << "UPDATE relief_providers SET name = ?, location = ?, username = ?, password = ? WHERE id = ?",
-                    use(nameCopy), use(locationCopy), use(usernameCopy), use(passwordCopy), use(id), now;
+                fields::update(session, *this);
             }
+            CredentialIndex::instance().put("relief_provider", username, id, password);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error saving relief provider: " << e.what() << std::endl;
+            LOG_ERROR("Error saving relief provider: " << e.what());
             return false;
         }
     }
 
     static ReliefProvider findById(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.find_by_id");
+        metrics::ScopedTimer timer(latency);
         ReliefProvider provider;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "SELECT id, name, org_type, location, username, password FROM relief_providers WHERE id = ?",
-                into(provider.id), into(provider.name), into(provider.orgType), 
-                into(provider.location), into(provider.username), into(provider.password),
-                use(id), now;
+            Statement select(session);
+            select << fields::selectSql<ReliefProvider>() << " WHERE id = ?", use(id);
+            provider = fields::fetchOne<ReliefProvider>(select);
             
             if (provider.id != 0) {
                 provider.loadResources();
                 provider.accessIncidentReports();
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error finding relief provider: " << e.what() << std::endl;
+            LOG_ERROR("Error finding relief provider: " << e.what());
         }
         return provider;
     }
 
     static ReliefProvider findByUsername(const std::string& username) {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.find_by_username");
+        metrics::ScopedTimer timer(latency);
         ReliefProvider provider;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             std::string usernameCopy = username;  // Create non-const copy
-            session << "SELECT id, name, org_type, location, username, password FROM relief_providers WHERE username = ?",
-                into(provider.id), into(provider.name), into(provider.orgType),
-                into(provider.location), into(provider.username), into(provider.password),
-                use(usernameCopy), now;
+            Statement select(session);
+            select << fields::selectSql<ReliefProvider>() << " WHERE username = ?", use(usernameCopy);
+            provider = fields::fetchOne<ReliefProvider>(select);
             
             if (provider.id != 0) {
                 provider.loadResources();
                 provider.accessIncidentReports();
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error finding relief provider: " << e.what() << std::endl;
+            LOG_ERROR("Error finding relief provider: " << e.what());
         }
         return provider;
     }
 
     static std::vector<ReliefProvider> findAll() {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.find_all");
+        metrics::ScopedTimer timer(latency);
         std::vector<ReliefProvider> providers;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
-            int id;
-            std::string name, orgType, location, username, password;
-
-            select << "SELECT id, name, org_type, location, username, password FROM relief_providers",
-                into(id), into(name), into(orgType), into(location), into(username), into(password),
-                range(0, 1);
-
-            while (!select.done()) {
-                select.execute();
-                ReliefProvider provider;
-                provider.id = id;
-                provider.name = name;
-                provider.orgType = orgType;
-                provider.location = location;
-                provider.username = username;
-                provider.password = password;
+            select << fields::selectSql<ReliefProvider>();
+            providers = fields::fetch<ReliefProvider>(select);
+            for (ReliefProvider& provider : providers) {
                 provider.loadResources();
                 provider.accessIncidentReports();
-                providers.push_back(provider);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error finding all relief providers: " << e.what() << std::endl;
+            LOG_ERROR("Error finding all relief providers: " << e.what());
         }
         return providers;
     }
 
     static bool remove(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.remove");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "DELETE FROM relief_providers WHERE id = ?", use(id), now;
+            session << fields::deleteSql<ReliefProvider>(), use(id), now;
+            CredentialIndex::instance().erase("relief_provider", id);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error removing relief provider: " << e.what() << std::endl;
+            LOG_ERROR("Error removing relief provider: " << e.what());
             return false;
         }
     }
@@ -246,7 +255,7 @@ public:
             session << "INSERT OR REPLACE INTO provider_resources (provider_id, resource_type, quantity) VALUES (?, ?, ?)",
                 use(id), use(typeCopy), use(resources[type]), now;
         } catch (const std::exception& e) {
-            std::cerr << "Error adding resource: " << e.what() << std::endl;
+            LOG_ERROR("Error adding resource: " << e.what());
         }
     }
 
@@ -260,12 +269,14 @@ public:
                 use(resources[type]), use(id), use(typeCopy), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error using resource: " << e.what() << std::endl;
+            LOG_ERROR("Error using resource: " << e.what());
             return false;
         }
     }
 
     void loadResources() {
+        static metrics::Histogram& latency = metrics::dbStatement("relief_providers.load_resources");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
@@ -281,23 +292,18 @@ public:
                 resources[type] = quantity;
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error loading resources: " << e.what() << std::endl;
+            LOG_ERROR("Error loading resources: " << e.what());
         }
     }
 
     // Authentication
     bool verifyPassword(const std::string& password) const {
-        return this->password == password;
+        return PasswordHasher::instance().verify(password, this->password).status == HashStatus::Match;
     }
 
     // Convert to JSON for API responses
     Poco::JSON::Object::Ptr toJSON() const {
-        Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
-        json->set("id", id);
-        json->set("name", name);
-        json->set("orgType", orgType);
-        json->set("location", location);
-        json->set("username", username);
+        Poco::JSON::Object::Ptr json = fields::toJSON(*this);
         
         Poco::JSON::Array reportsArray;
         for (const auto& reportId : incidentReports) {
@@ -317,11 +323,19 @@ public:
     // Create from JSON for API requests
     static ReliefProvider fromJSON(const Poco::JSON::Object::Ptr& json) {
         ReliefProvider provider;
-        provider.setName(json->getValue<std::string>("name"));
-        provider.setOrgType(json->getValue<std::string>("orgType"));
-        provider.setLocation(json->getValue<std::string>("location"));
-        provider.setUsername(json->getValue<std::string>("username"));
-        provider.setPassword(json->getValue<std::string>("password"));
+        fields::fromJSON(json, provider);
         return provider;
     }
-};
\ No newline at end of file
+};
+
+template <>
+struct ModelFields<ReliefProvider> {
+    static constexpr std::string_view table = "relief_providers";
+    static constexpr auto all = std::make_tuple(
+        fields::field("id", "id", &ReliefProvider::getId, &ReliefProvider::setId, fields::Key),
+        fields::field("name", "name", &ReliefProvider::getName, &ReliefProvider::setName, fields::Required),
+        fields::field("orgType", "org_type", &ReliefProvider::getOrgType, &ReliefProvider::setOrgType, fields::Required | fields::OpenEnum),
+        fields::field("location", "location", &ReliefProvider::getLocation, &ReliefProvider::setLocation, fields::Required),
+        fields::field("username", "username", &ReliefProvider::getUsername, &ReliefProvider::setUsername, fields::Required),
+        fields::field("password", "password", &ReliefProvider::getPassword, &ReliefProvider::setPassword, fields::Required | fields::Secret));
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Time columns hold UTC epoch milliseconds as INTEGER, so ordering and range
+// filters compare integers and can use an index. The API still returns the
+// "YYYY-MM-DD HH:MM:SS" text it always has.
+//
+// Formatting writes into a caller buffer without allocating. Each thread
+// caches the text of the last second it formatted, so rows written within
+// the same second (and "now" on a busy server) are a single copy; other
+// seconds are converted with integer arithmetic rather than gmtime/strftime.
+
+using EpochMillis = int64_t;
+
+// "No time recorded": NULL in the database, "" in the API. Not a value any
+// real time can take, so the epoch itself stays storable.
+constexpr EpochMillis kNoTimestamp = INT64_MIN;
+
+// Shortest digit string read as epoch milliseconds where a number can only
+// arrive as text; 12 digits is March 1973, so dates like "20240501" and
+// years are rejected rather than taken as a few seconds after 1970
+constexpr std::size_t kMinMillisDigits = 12;
+
+// Length of "YYYY-MM-DD HH:MM:SS"
+constexpr std::size_t kTimestampLength = 19;
+
+inline EpochMillis nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+namespace timestamp {
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's algorithm)
+constexpr int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Days in the month (1-12) of a proleptic Gregorian year
+constexpr unsigned daysInMonth(int64_t y, unsigned m) {
+    if (m == 2) return (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 29 : 28;
+    return (m == 4 || m == 6 || m == 9 || m == 11) ? 30 : 31;
+}
+
+struct CivilDate {
+    int64_t year;
+    unsigned month;
+    unsigned day;
+};
+
+constexpr CivilDate civilFromDays(int64_t z) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    return CivilDate{static_cast<int64_t>(yoe) + era * 400 + (m <= 2), m, d};
+}
+
+inline void putDigits(char* out, unsigned value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+inline void formatSecond(int64_t second, char* out) {
+    int64_t days = second / 86400;
+    int64_t secondOfDay = second % 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        --days;
+    }
+    CivilDate date = civilFromDays(days);
+    unsigned year = date.year < 0 ? 0 : date.year > 9999 ? 9999 : static_cast<unsigned>(date.year);
+    putDigits(out, year, 4);
+    out[4] = '-';
+    putDigits(out + 5, date.month, 2);
+    out[7] = '-';
+    putDigits(out + 8, date.day, 2);
+    out[10] = ' ';
+    putDigits(out + 11, static_cast<unsigned>(secondOfDay / 3600), 2);
+    out[13] = ':';
+    putDigits(out + 14, static_cast<unsigned>(secondOfDay / 60 % 60), 2);
+    out[16] = ':';
+    putDigits(out + 17, static_cast<unsigned>(secondOfDay % 60), 2);
+}
+
+// Parses exactly `width` digits at text[pos]
+inline bool readDigits(std::string_view text, std::size_t pos, int width, unsigned& value) {
+    if (pos + width > text.size()) return false;
+    value = 0;
+    for (int i = 0; i < width; ++i) {
+        char c = text[pos + i];
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + static_cast<unsigned>(c - '0');
+    }
+    return true;
+}
+
+}  // namespace timestamp
+
+// Writes exactly kTimestampLength characters (no terminator) and returns
+// them; returns 0 and writes nothing for kNoTimestamp
+inline std::size_t formatTimestamp(EpochMillis millis, char* out) {
+    if (millis == kNoTimestamp) return 0;
+    struct Cache {
+        int64_t second = INT64_MIN;
+        char text[kTimestampLength];
+    };
+    thread_local Cache cache;
+
+    int64_t second = millis / 1000 - (millis % 1000 < 0 ? 1 : 0);
+    if (second != cache.second) {
+        timestamp::formatSecond(second, cache.text);
+        cache.second = second;
+    }
+    for (std::size_t i = 0; i < kTimestampLength; ++i) out[i] = cache.text[i];
+    return kTimestampLength;
+}
+
+inline std::string formatTimestamp(EpochMillis millis) {
+    char buffer[kTimestampLength];
+    return std::string(buffer, formatTimestamp(millis, buffer));
+}
+
+// Accepts the API's "YYYY-MM-DD HH:MM:SS", ISO 8601 variants ('T' separator,
+// optional seconds, fraction and trailing 'Z') or a bare "YYYY-MM-DD", taken
+// as UTC. Epoch milliseconds are not text: JSON carries them as numbers, and
+// text-only inputs use parseTimestampOrMillis().
+inline bool parseTimestamp(std::string_view text, EpochMillis& millis) {
+    using timestamp::readDigits;
+    unsigned year, month, day, hour = 0, minute = 0, second = 0, fraction = 0;
+    if (!readDigits(text, 0, 4, year) || text.size() < 10 || text[4] != '-' ||
+        !readDigits(text, 5, 2, month) || text[7] != '-' || !readDigits(text, 8, 2, day)) {
+        return false;
+    }
+    std::size_t pos = 10;
+    if (pos < text.size() && (text[pos] == ' ' || text[pos] == 'T')) {
+        if (!readDigits(text, pos + 1, 2, hour) || pos + 3 >= text.size() || text[pos + 3] != ':' ||
+            !readDigits(text, pos + 4, 2, minute)) {
+            return false;
+        }
+        pos += 6;
+        if (pos < text.size() && text[pos] == ':') {
+            if (!readDigits(text, pos + 1, 2, second)) return false;
+            pos += 3;
+            if (pos < text.size() && text[pos] == '.') {
+                unsigned scale = 100;
+                for (++pos; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+                    fraction += static_cast<unsigned>(text[pos] - '0') * scale;
+                    scale /= 10;
+                }
+            }
+        }
+    }
+    if (pos < text.size() && text[pos] == 'Z') ++pos;
+    if (pos != text.size() || month < 1 || month > 12 || day < 1 || day > timestamp::daysInMonth(year, month) ||
+        hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    int64_t days = timestamp::daysFromCivil(year, month, day);
+    millis = ((days * 24 + hour) * 60 + minute) * 60000 + static_cast<int64_t>(second) * 1000 + fraction;
+    return true;
+}
+
+// For inputs that are always text (CSV cells, query parameters): datetime
+// text, or epoch milliseconds written as kMinMillisDigits to 18 digits
+inline bool parseTimestampOrMillis(std::string_view text, EpochMillis& millis) {
+    if (text.size() >= kMinMillisDigits && text.size() <= 18 &&
+        text.find_first_not_of("0123456789") == std::string_view::npos) {
+        int64_t value = 0;
+        for (char c : text) value = value * 10 + (c - '0');
+        millis = value;
+        return true;
+    }
+    return parseTimestamp(text, millis);
+}
+
+static_assert(timestamp::daysFromCivil(1970, 1, 1) == 0, "epoch is day zero");
+static_assert(timestamp::daysInMonth(2024, 2) == 29 && timestamp::daysInMonth(1900, 2) == 28 &&
+              timestamp::daysInMonth(2000, 2) == 29, "Gregorian leap years");
+static_assert(timestamp::civilFromDays(19844).month == 5, "2024-05-01 is day 19844");
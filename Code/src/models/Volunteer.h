@@ -6,42 +6,57 @@
 #include <Poco/Data/Session.h>
 #include <Poco/Data/Statement.h>
 #include "../database/DatabaseManager.h"
+#include "../metrics/Metrics.h"
+#include "../logging/Logger.h"
+#include "../security/PasswordHasher.h"
+#include "../security/CredentialIndex.h"
+#include "Enums.h"
+#include "FieldMapping.h"
+#include "InternPool.h"
 
 using namespace Poco::Data::Keywords;
 using Poco::Data::Session;
 
+class Volunteer;
+// Defined after the class; declared first so its members can use the mapping
+template <>
+struct ModelFields<Volunteer>;
+
 // Model class for volunteers
 class Volunteer {
 private:
     int id;
     std::string name;
-    std::string location;
+    InternedString location;
     bool available;
     std::string username;
     std::string password;
     std::vector<int> assignedTasks;
-    std::string orgType;
+    OrgType orgType;
 
 public:
     // Constructor
-    Volunteer() : id(0), available(true) {}
+    Volunteer() : id(0), available(true), orgType(OrgType::Other) {}
     
     // Getters
     int getUserID() const { return id; }
     std::string getName() const { return name; }
-    std::string getLocation() const { return location; }
+    const std::string& getLocation() const { return location.str(); }
     bool isAvailable() const { return available; }
     std::string getUsername() const { return username; }
+    std::string getPassword() const { return password; }
     std::vector<int> getAssignedTasks() const { return assignedTasks; }
-    std::string getOrgType() const { return orgType; }
+    OrgType getOrgType() const { return orgType; }
 
     // Setters
     void setUserID(int id) { this->id = id; }
     void setName(const std::string& name) { this->name = name; }
-    void setLocation(const std::string& location) { this->location = location; }
+    void setLocation(const std::string& location) { this->location = InternedString(location); }
     void setUsername(const std::string& username) { this->username = username; }
     void setPassword(const std::string& password) { this->password = password; }
-    void setOrgType(const std::string& orgType) { this->orgType = orgType; }
+    void setOrgType(OrgType orgType) { this->orgType = orgType; }
+    // Local state only; setAvailability() also writes it through
+    void setAvailable(bool available) { this->available = available; }
 
     // Method from class diagram
     void setAvailability(bool status) {
@@ -51,122 +66,110 @@ public:
                 use(status), use(id), now;
             available = status;  // Only update the local state if the database update succeeds
         } catch (const std::exception& e) {
-            std::cerr << "Error updating availability: " << e.what() << std::endl;
+            LOG_ERROR("Error updating availability: " << e.what());
             throw;  // Re-throw to let the controller handle the error
         }
     }
 
     // Database operations
     bool save() {
+        static metrics::Histogram& latency = metrics::dbStatement("volunteers.save");
+        // Passwords are only ever stored hashed
+        if (!PasswordHasher::instance().ensureHashed(password)) {
+            LOG_WARN("Password hashing pool saturated, not saving volunteer");
+            return false;
+        }
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            std::string nameCopy = name;
-            std::string locationCopy = location;
-            std::string usernameCopy = username;
-            std::string passwordCopy = password;
-            std::string orgTypeCopy = orgType;
-
             if (id == 0) {
-                // Insert new record
-                session << "INSERT INTO volunteers (name, location, available, username, password, org_type) VALUES (?, ?, ?, ?, ?, ?)",
-                    use(nameCopy), use(locationCopy), use(available), use(usernameCopy), use(passwordCopy), use(orgTypeCopy), now;
-                
-                // Get the inserted ID
-                session << "SELECT last_insert_rowid()", into(id), now;
+                fields::insert(session, *this);
             } else {
-                // Update existing record
-                session << "UPDATE volunteers SET name = ?, location = ?, available = ?, username = ?, password = ?, org_type = ? WHERE id = ?",
-                    use(nameCopy), use(locationCopy), use(available), use(usernameCopy), use(passwordCopy), use(orgTypeCopy), use(id), now;
+                fields::update(session, *this);
             }
+            CredentialIndex::instance().put("volunteer", username, id, password);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error saving volunteer: " << e.what() << std::endl;
+            LOG_ERROR("Error saving volunteer: " << e.what());
             return false;
         }
     }
 
     static Volunteer findById(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("volunteers.find_by_id");
+        metrics::ScopedTimer timer(latency);
         Volunteer volunteer;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "SELECT id, name, location, available, username, password, org_type FROM volunteers WHERE id = ?",
-                into(volunteer.id), into(volunteer.name), into(volunteer.location),
-                into(volunteer.available), into(volunteer.username), into(volunteer.password),
-                into(volunteer.orgType), use(id), now;
+            Statement select(session);
+            select << fields::selectSql<Volunteer>() << " WHERE id = ?", use(id);
+            volunteer = fields::fetchOne<Volunteer>(select);
             
             if (volunteer.id != 0) {
                 volunteer.loadAssignedTasks();
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error finding volunteer: " << e.what() << std::endl;
+            LOG_ERROR("Error finding volunteer: " << e.what());
         }
         return volunteer;
     }
 
     static Volunteer findByUsername(const std::string& username) {
+        static metrics::Histogram& latency = metrics::dbStatement("volunteers.find_by_username");
+        metrics::ScopedTimer timer(latency);
         Volunteer volunteer;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             std::string usernameCopy = username;  // Create non-const copy
-            session << "SELECT id, name, location, available, username, password, org_type FROM volunteers WHERE username = ?",
-                into(volunteer.id), into(volunteer.name), into(volunteer.location),
-                into(volunteer.available), into(volunteer.username), into(volunteer.password),
-                into(volunteer.orgType), use(usernameCopy), now;
+            Statement select(session);
+            select << fields::selectSql<Volunteer>() << " WHERE username = ?", use(usernameCopy);
+            volunteer = fields::fetchOne<Volunteer>(select);
             
             if (volunteer.id != 0) {
                 volunteer.loadAssignedTasks();
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error finding volunteer: " << e.what() << std::endl;
+            LOG_ERROR("Error finding volunteer: " << e.what());
         }
         return volunteer;
     }
 
     static std::vector<Volunteer> findAll() {
+        static metrics::Histogram& latency = metrics::dbStatement("volunteers.find_all");
+        metrics::ScopedTimer timer(latency);
         std::vector<Volunteer> volunteers;
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
-            int id;
-            std::string name, location, username, password, orgType;
-            bool available;
-
-            select << "SELECT id, name, location, available, username, password, org_type FROM volunteers",
-                into(id), into(name), into(location), into(available), into(username), into(password), into(orgType),
-                range(0, 1);
-
-            while (!select.done()) {
-                select.execute();
-                Volunteer volunteer;
-                volunteer.id = id;
-                volunteer.name = name;
-                volunteer.location = location;
-                volunteer.available = available;
-                volunteer.username = username;
-                volunteer.password = password;
-                volunteer.orgType = orgType;
+            select << fields::selectSql<Volunteer>();
+            volunteers = fields::fetch<Volunteer>(select);
+            for (Volunteer& volunteer : volunteers) {
                 volunteer.loadAssignedTasks();
-                volunteers.push_back(volunteer);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error finding all volunteers: " << e.what() << std::endl;
+            LOG_ERROR("Error finding all volunteers: " << e.what());
         }
         return volunteers;
     }
 
     static bool remove(int id) {
+        static metrics::Histogram& latency = metrics::dbStatement("volunteers.remove");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "DELETE FROM volunteers WHERE id = ?", use(id), now;
+            session << fields::deleteSql<Volunteer>(), use(id), now;
+            CredentialIndex::instance().erase("volunteer", id);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error removing volunteer: " << e.what() << std::endl;
+            LOG_ERROR("Error removing volunteer: " << e.what());
             return false;
         }
     }
 
     // Task management
     void loadAssignedTasks() {
+        static metrics::Histogram& latency = metrics::dbStatement("volunteers.load_assigned_tasks");
+        metrics::ScopedTimer timer(latency);
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
             Statement select(session);
@@ -181,19 +184,20 @@ public:
                 assignedTasks.push_back(taskId);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Error loading assigned tasks: " << e.what() << std::endl;
+            LOG_ERROR("Error loading assigned tasks: " << e.what());
         }
     }
 
     bool assignTask(int taskId) {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "UPDATE tasks SET assigned_volunteer_id = ?, status = 'Assigned' WHERE id = ?",
-                use(id), use(taskId), now;
+            int assigned = enumCode(TaskStatus::Assigned);
+            session << "UPDATE tasks SET assigned_volunteer_id = ?, status = ? WHERE id = ?",
+                use(id), use(assigned), use(taskId), now;
             assignedTasks.push_back(taskId);
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error assigning task: " << e.what() << std::endl;
+            LOG_ERROR("Error assigning task: " << e.what());
             return false;
         }
     }
@@ -201,28 +205,24 @@ public:
     bool completeTask(int taskId) {
         try {
             Session& session = DatabaseManager::getInstance()->getSession();
-            session << "UPDATE tasks SET status = 'Completed' WHERE id = ? AND assigned_volunteer_id = ?",
-                use(taskId), use(id), now;
+            int completed = enumCode(TaskStatus::Completed);
+            session << "UPDATE tasks SET status = ? WHERE id = ? AND assigned_volunteer_id = ?",
+                use(completed), use(taskId), use(id), now;
             return true;
         } catch (const std::exception& e) {
-            std::cerr << "Error completing task: " << e.what() << std::endl;
+            LOG_ERROR("Error completing task: " << e.what());
             return false;
         }
     }
 
     // Authentication
     bool verifyPassword(const std::string& password) const {
-        return this->password == password;
+        return PasswordHasher::instance().verify(password, this->password).status == HashStatus::Match;
     }
 
     // Convert to JSON for API responses
     Poco::JSON::Object::Ptr toJSON() const {
-        Poco::JSON::Object::Ptr json = new Poco::JSON::Object();
-        json->set("id", id);
-        json->set("name", name);
-        json->set("location", location);
-        json->set("available", available);
-        json->set("username", username);
+        Poco::JSON::Object::Ptr json = fields::toJSON(*this);
         
         Poco::JSON::Array tasksArray;
         for (const auto& taskId : assignedTasks) {
@@ -236,11 +236,20 @@ public:
     // Create from JSON for API requests
     static Volunteer fromJSON(const Poco::JSON::Object::Ptr& json) {
         Volunteer volunteer;
-        volunteer.setName(json->getValue<std::string>("name"));
-        volunteer.setLocation(json->getValue<std::string>("location"));
-        volunteer.setUsername(json->getValue<std::string>("username"));
-        volunteer.setPassword(json->getValue<std::string>("password"));
-        volunteer.setOrgType(json->getValue<std::string>("orgType"));
+        fields::fromJSON(json, volunteer);
         return volunteer;
     }
-};
\ No newline at end of file
+};
+
+template <>
+struct ModelFields<Volunteer> {
+    static constexpr std::string_view table = "volunteers";
+    static constexpr auto all = std::make_tuple(
+        fields::field("id", "id", &Volunteer::getUserID, &Volunteer::setUserID, fields::Key),
+        fields::field("name", "name", &Volunteer::getName, &Volunteer::setName, fields::Required),
+        fields::field("location", "location", &Volunteer::getLocation, &Volunteer::setLocation, fields::Required),
+        fields::field("available", "available", &Volunteer::isAvailable, &Volunteer::setAvailable),
+        fields::field("username", "username", &Volunteer::getUsername, &Volunteer::setUsername, fields::Required),
+        fields::field("password", "password", &Volunteer::getPassword, &Volunteer::setPassword, fields::Required | fields::Secret),
+        fields::field("orgType", "org_type", &Volunteer::getOrgType, &Volunteer::setOrgType, fields::Required | fields::OpenEnum));
+};
@@ -0,0 +1,545 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../logging/Logger.h"
+#include "../cluster/ClusterChannel.h"
+
+// One security event as read back from the audit log
+struct AuditRecord {
+    uint64_t sequence = 0;
+    int64_t timestampMs = 0;
+    std::string type;
+    std::string subject;
+    std::string description;
+};
+
+// Append-only security audit log.
+//
+// Events go to fixed-size, memory-mapped segment files instead of SQLite, so
+// auditing never competes with operational writes for the database lock.
+// Each record is a length-prefixed, checksummed binary entry; a new segment
+// starts every kRotateSeconds or when the current one fills, and the oldest
+// segments beyond the retention count are deleted. Every segment keeps a
+// sparse in-memory index (one entry per kIndexInterval records) so time-range
+// and latest-N reads seek close to the answer instead of scanning.
+//
+// In multi-process mode only the supervisor writes: workers forward events
+// over the cluster channel and read by following the segment files, picking
+// up new segments and records before each query. A process taking over from
+// a running one (api/ListenerHandoff.h) holds its events in memory and reads
+// as a follower until resume(), since only one process may write at a time.
+class AuditLog {
+public:
+    static constexpr std::size_t kSegmentBytes = 8 * 1024 * 1024;
+    static constexpr std::size_t kMaxDescription = 16 * 1024;
+    static constexpr int64_t kRotateSeconds = 3600;
+    static constexpr std::size_t kRetainedSegments = 168;  // a week of hourly segments
+    static constexpr uint32_t kIndexInterval = 64;
+    static constexpr std::size_t kMaxHeld = 100000;
+
+private:
+    // On-disk record layout; the payload (type, subject, description) follows
+    // and the record is padded to 8 bytes. A zero length marks the end of data.
+    struct RecordHeader {
+        uint32_t length;
+        uint32_t checksum;
+        int64_t timestampMs;
+        uint64_t sequence;
+        uint16_t typeLength;
+        uint16_t subjectLength;
+        uint32_t descriptionLength;
+    };
+
+    struct IndexEntry {
+        int64_t timestampMs;
+        uint32_t offset;
+        uint32_t recordsBefore;
+    };
+
+    struct Segment {
+        std::string path;
+        int64_t startMs = 0;
+        int fd = -1;
+        char* data = nullptr;
+        std::atomic<std::size_t> end{0};       // bytes of published records
+        std::atomic<uint32_t> records{0};
+        std::atomic<int64_t> lastMs{0};
+
+        std::mutex indexMutex;
+        std::vector<IndexEntry> index;
+
+        ~Segment() {
+            if (data) munmap(data, kSegmentBytes);
+            if (fd >= 0) close(fd);
+        }
+
+        std::vector<IndexEntry> indexSnapshot() {
+            std::lock_guard<std::mutex> lock(indexMutex);
+            return index;
+        }
+    };
+
+    std::string directory = "audit";
+
+    std::mutex writeMutex;
+    std::shared_mutex segmentsMutex;
+    std::vector<std::shared_ptr<Segment>> segments;  // oldest first; the last one is active
+    uint64_t nextSequence = 1;
+    bool opened = false;
+    bool paused = false;             // another process is still writing; see pause()
+    std::vector<AuditRecord> held;   // events appended while paused
+
+    AuditLog() {
+        logging::Logger::instance();
+        ClusterChannel::instance().subscribe("writer.audit", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() == 3) append(fields[0], fields[1], fields[2]);
+        });
+    }
+
+    static bool follower() {
+        return ClusterChannel::instance().isWorker();
+    }
+
+    static int64_t nowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static uint32_t checksum(const char* data, std::size_t size) {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    static std::size_t padded(std::size_t size) {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    std::string segmentPath(int64_t startMs) const {
+        char name[48];
+        std::snprintf(name, sizeof(name), "audit-%016lld.seg", static_cast<long long>(startMs));
+        return directory + "/" + name;
+    }
+
+    std::shared_ptr<Segment> mapSegment(const std::string& path, int64_t startMs, bool writable) {
+        auto segment = std::make_shared<Segment>();
+        segment->path = path;
+        segment->startMs = startMs;
+        segment->fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0640);
+        if (segment->fd < 0) {
+            LOG_ERROR("Error opening audit segment " << path << ": " << std::strerror(errno));
+            return nullptr;
+        }
+        if (writable) {
+            if (ftruncate(segment->fd, static_cast<off_t>(kSegmentBytes)) != 0) {
+                LOG_ERROR("Error sizing audit segment " << path << ": " << std::strerror(errno));
+                return nullptr;
+            }
+        } else {
+            // The writer may not have sized a brand-new segment yet; look again next time
+            struct stat info;
+            if (fstat(segment->fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < kSegmentBytes) {
+                return nullptr;
+            }
+        }
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* mapped = mmap(nullptr, kSegmentBytes, protection, MAP_SHARED, segment->fd, 0);
+        if (mapped == MAP_FAILED) {
+            LOG_ERROR("Error mapping audit segment " << path << ": " << std::strerror(errno));
+            return nullptr;
+        }
+        segment->data = static_cast<char*>(mapped);
+        return segment;
+    }
+
+    // Extend end offset and index past records written since the last look;
+    // stops at the first torn or unfinished record
+    void recover(Segment& segment) {
+        std::size_t offset = segment.end.load(std::memory_order_relaxed);
+        uint32_t count = segment.records.load(std::memory_order_relaxed);
+        while (offset + sizeof(RecordHeader) <= kSegmentBytes) {
+            RecordHeader header;
+            std::memcpy(&header, segment.data + offset, sizeof(header));
+            if (header.length < sizeof(RecordHeader) || offset + header.length > kSegmentBytes) break;
+            const char* body = segment.data + offset + sizeof(uint32_t) * 2;
+            if (checksum(body, header.length - sizeof(uint32_t) * 2) != header.checksum) break;
+
+            if (count % kIndexInterval == 0) {
+                std::lock_guard<std::mutex> lock(segment.indexMutex);
+                segment.index.push_back({header.timestampMs, static_cast<uint32_t>(offset), count});
+            }
+            segment.lastMs.store(header.timestampMs, std::memory_order_relaxed);
+            nextSequence = std::max(nextSequence, header.sequence + 1);
+            offset += padded(header.length);
+            ++count;
+        }
+        segment.records.store(count, std::memory_order_release);
+        segment.end.store(offset, std::memory_order_release);
+    }
+
+    // Map segments not seen yet, drop ones deleted by retention and catch up on
+    // appended records; caller holds writeMutex
+    void refreshLocked(bool writable) {
+        mkdir(directory.c_str(), 0750);
+        std::vector<std::string> names;
+        if (DIR* dir = opendir(directory.c_str())) {
+            while (dirent* entry = readdir(dir)) {
+                std::string name = entry->d_name;
+                if (name.compare(0, 6, "audit-") == 0 && name.size() > 10 &&
+                    name.compare(name.size() - 4, 4, ".seg") == 0) {
+                    names.push_back(name);
+                }
+            }
+            closedir(dir);
+        }
+        std::sort(names.begin(), names.end());
+
+        std::vector<std::shared_ptr<Segment>> current = snapshot();
+        std::vector<std::shared_ptr<Segment>> refreshed;
+        for (const auto& name : names) {
+            std::string path = directory + "/" + name;
+            auto known = std::find_if(current.begin(), current.end(),
+                [&path](const std::shared_ptr<Segment>& segment) { return segment->path == path; });
+            std::shared_ptr<Segment> segment = known != current.end()
+                ? *known
+                : mapSegment(path, std::stoll(name.substr(6, name.size() - 10)), writable);
+            if (!segment) continue;
+            recover(*segment);
+            refreshed.push_back(segment);
+        }
+
+        std::unique_lock<std::shared_mutex> lock(segmentsMutex);
+        segments.swap(refreshed);
+    }
+
+    // Open on first use; followers catch up with the writer on every call
+    void ensureCurrent() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!opened || follower() || paused) {
+            refreshLocked(!follower());
+            opened = true;
+        }
+    }
+
+    // Caller holds writeMutex
+    Segment* activeSegment(std::size_t recordBytes, int64_t timestampMs) {
+        if (!opened) {
+            refreshLocked(true);
+            opened = true;
+        }
+        if (!segments.empty()) {
+            Segment& current = *segments.back();
+            bool expired = timestampMs - current.startMs >= kRotateSeconds * 1000;
+            bool full = current.end.load(std::memory_order_relaxed) + recordBytes > kSegmentBytes;
+            if (!expired && !full) return &current;
+        }
+
+        int64_t startMs = timestampMs;
+        if (!segments.empty()) startMs = std::max(startMs, segments.back()->startMs + 1);
+        auto segment = mapSegment(segmentPath(startMs), startMs, true);
+        if (!segment) return nullptr;
+
+        std::unique_lock<std::shared_mutex> lock(segmentsMutex);
+        segments.push_back(segment);
+        while (segments.size() > kRetainedSegments) {
+            // Readers holding the segment keep its mapping alive until they finish
+            unlink(segments.front()->path.c_str());
+            segments.erase(segments.begin());
+        }
+        return segments.back().get();
+    }
+
+    static std::size_t recordLength(const std::string& type, const std::string& subject,
+                                    const std::string& description) {
+        return sizeof(RecordHeader) + std::min<std::size_t>(type.size(), UINT16_MAX) +
+               std::min<std::size_t>(subject.size(), UINT16_MAX) +
+               std::min<std::size_t>(description.size(), kMaxDescription);
+    }
+
+    // Caller holds writeMutex and has checked the record fits in segment
+    void writeLocked(Segment& segment, int64_t timestampMs, const std::string& type,
+                     const std::string& subject, const std::string& description) {
+        std::size_t typeLength = std::min<std::size_t>(type.size(), UINT16_MAX);
+        std::size_t subjectLength = std::min<std::size_t>(subject.size(), UINT16_MAX);
+        std::size_t descriptionLength = std::min<std::size_t>(description.size(), kMaxDescription);
+        std::size_t length = recordLength(type, subject, description);
+
+        // Keep timestamps monotonic within a segment so the index stays sorted
+        timestampMs = std::max(timestampMs, segment.lastMs.load(std::memory_order_relaxed));
+
+        std::size_t offset = segment.end.load(std::memory_order_relaxed);
+        char* out = segment.data + offset;
+
+        RecordHeader header;
+        header.length = static_cast<uint32_t>(length);
+        header.checksum = 0;
+        header.timestampMs = timestampMs;
+        header.sequence = nextSequence++;
+        header.typeLength = static_cast<uint16_t>(typeLength);
+        header.subjectLength = static_cast<uint16_t>(subjectLength);
+        header.descriptionLength = static_cast<uint32_t>(descriptionLength);
+
+        std::memcpy(out, &header, sizeof(header));
+        char* payload = out + sizeof(header);
+        std::memcpy(payload, type.data(), typeLength);
+        std::memcpy(payload + typeLength, subject.data(), subjectLength);
+        std::memcpy(payload + typeLength + subjectLength, description.data(), descriptionLength);
+        header.checksum = checksum(out + sizeof(uint32_t) * 2, length - sizeof(uint32_t) * 2);
+        std::memcpy(out + sizeof(uint32_t), &header.checksum, sizeof(header.checksum));
+
+        uint32_t count = segment.records.load(std::memory_order_relaxed);
+        if (count % kIndexInterval == 0) {
+            std::lock_guard<std::mutex> lock(segment.indexMutex);
+            segment.index.push_back({timestampMs, static_cast<uint32_t>(offset), count});
+        }
+        segment.lastMs.store(timestampMs, std::memory_order_relaxed);
+        segment.records.store(count + 1, std::memory_order_release);
+        segment.end.store(offset + padded(length), std::memory_order_release);
+    }
+
+    // Caller holds writeMutex
+    bool appendLocked(const std::string& type, const std::string& subject, const std::string& description,
+                      int64_t timestampMs) {
+        if (paused) {
+            if (held.size() >= kMaxHeld) return false;
+            held.push_back({0, timestampMs, type, subject, description.substr(0, kMaxDescription)});
+            return true;
+        }
+        Segment* segment = activeSegment(padded(recordLength(type, subject, description)), timestampMs);
+        if (!segment) return false;
+        writeLocked(*segment, timestampMs, type, subject, description);
+        return true;
+    }
+
+    static AuditRecord decode(const char* data) {
+        RecordHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const char* payload = data + sizeof(header);
+        AuditRecord record;
+        record.sequence = header.sequence;
+        record.timestampMs = header.timestampMs;
+        record.type.assign(payload, header.typeLength);
+        record.subject.assign(payload + header.typeLength, header.subjectLength);
+        record.description.assign(payload + header.typeLength + header.subjectLength, header.descriptionLength);
+        return record;
+    }
+
+    static uint32_t lengthAt(const char* data) {
+        uint32_t length;
+        std::memcpy(&length, data, sizeof(length));
+        return length;
+    }
+
+    static int64_t timestampAt(const char* data) {
+        int64_t timestampMs;
+        std::memcpy(&timestampMs, data + offsetof(RecordHeader, timestampMs), sizeof(timestampMs));
+        return timestampMs;
+    }
+
+    std::vector<std::shared_ptr<Segment>> snapshot() {
+        std::shared_lock<std::shared_mutex> lock(segmentsMutex);
+        return segments;
+    }
+
+public:
+    static AuditLog& instance() {
+        static AuditLog log;
+        return log;
+    }
+
+    // Must be called before the first append
+    void setDirectory(const std::string& path) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        directory = path;
+    }
+
+    // Hold appends in memory while a previous process still owns the log
+    void pause() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        paused = true;
+    }
+
+    // Catch up with what the previous process wrote, then write held events
+    void resume() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!paused) return;
+        paused = false;
+        refreshLocked(!follower());
+        opened = true;
+        for (const auto& record : held) {
+            appendLocked(record.type, record.subject, record.description, record.timestampMs);
+        }
+        held.clear();
+        if (!segments.empty()) {
+            msync(segments.back()->data, kSegmentBytes, MS_ASYNC);
+        }
+    }
+
+    bool append(const std::string& type, const std::string& subject, const std::string& description) {
+        if (follower()) {
+            return ClusterChannel::instance().publish("writer.audit",
+                {type, subject, description.substr(0, kMaxDescription)});
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return appendLocked(type, subject, description, nowMs());
+    }
+
+    // Write events recorded before this log existed, keeping their times, into
+    // segments of their own ahead of the current ones. Times at or after the
+    // oldest current segment are moved just before it so segments stay in
+    // time order. Retention applies to these segments like any others.
+    bool importRecords(std::vector<AuditRecord> records) {
+        if (follower()) return false;
+        if (records.empty()) return true;
+        std::stable_sort(records.begin(), records.end(),
+            [](const AuditRecord& a, const AuditRecord& b) { return a.timestampMs < b.timestampMs; });
+
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (!opened) {
+            refreshLocked(true);
+            opened = true;
+        }
+        std::vector<std::shared_ptr<Segment>> current = snapshot();
+        int64_t beforeMs = current.empty() ? INT64_MAX : current.front()->startMs;
+
+        std::vector<std::shared_ptr<Segment>> imported;
+        for (const auto& record : records) {
+            int64_t timestampMs = std::min(record.timestampMs, beforeMs - 1);
+            std::size_t length = padded(recordLength(record.type, record.subject, record.description));
+            if (imported.empty() || imported.back()->end.load(std::memory_order_relaxed) + length > kSegmentBytes) {
+                int64_t startMs = timestampMs;
+                if (!imported.empty()) startMs = std::max(startMs, imported.back()->startMs + 1);
+                if (startMs >= beforeMs) {
+                    LOG_ERROR("No room to import audit records before " << beforeMs);
+                    return false;
+                }
+                auto segment = mapSegment(segmentPath(startMs), startMs, true);
+                if (!segment) return false;
+                imported.push_back(segment);
+            }
+            writeLocked(*imported.back(), timestampMs, record.type, record.subject, record.description);
+        }
+        for (const auto& segment : imported) {
+            msync(segment->data, kSegmentBytes, MS_SYNC);
+        }
+
+        std::unique_lock<std::shared_mutex> segmentsLock(segmentsMutex);
+        segments.insert(segments.begin(), imported.begin(), imported.end());
+        return true;
+    }
+
+    // Append several events under one lock acquisition
+    template <typename Events>
+    void appendBatch(const Events& events) {
+        if (follower()) {
+            for (const auto& event : events) {
+                append(event.type, event.subject, event.description);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        int64_t timestampMs = nowMs();
+        for (const auto& event : events) {
+            appendLocked(event.type, event.subject, event.description, timestampMs);
+        }
+        if (!paused && !segments.empty()) {
+            msync(segments.back()->data, kSegmentBytes, MS_ASYNC);
+        }
+    }
+
+    // Force written segments to disk
+    void sync() {
+        if (follower()) return;
+        std::lock_guard<std::mutex> lock(writeMutex);
+        for (const auto& segment : snapshot()) {
+            msync(segment->data, kSegmentBytes, MS_SYNC);
+        }
+    }
+
+    // Visit records with fromMs <= timestamp < toMs in time order; stop when visit returns false
+    template <typename Visitor>
+    void scan(int64_t fromMs, int64_t toMs, Visitor visit) {
+        ensureCurrent();
+        auto current = snapshot();
+        for (std::size_t s = 0; s < current.size(); ++s) {
+            Segment& segment = *current[s];
+            std::size_t end = segment.end.load(std::memory_order_acquire);
+            if (end == 0 || segment.lastMs.load(std::memory_order_relaxed) < fromMs) continue;
+            if (segment.startMs >= toMs) break;
+
+            // Seek to the last index entry at or before fromMs
+            std::size_t offset = 0;
+            for (const auto& entry : segment.indexSnapshot()) {
+                if (entry.timestampMs >= fromMs) break;
+                offset = entry.offset;
+            }
+
+            while (offset < end) {
+                const char* data = segment.data + offset;
+                int64_t timestampMs = timestampAt(data);
+                if (timestampMs >= toMs) return;
+                if (timestampMs >= fromMs && !visit(decode(data))) return;
+                offset += padded(lengthAt(data));
+            }
+        }
+    }
+
+    // The newest records, newest first
+    std::vector<AuditRecord> latest(std::size_t limit) {
+        ensureCurrent();
+        std::vector<AuditRecord> result;
+        auto current = snapshot();
+        for (auto it = current.rbegin(); it != current.rend() && result.size() < limit; ++it) {
+            Segment& segment = **it;
+            uint32_t count = segment.records.load(std::memory_order_acquire);
+            std::size_t end = segment.end.load(std::memory_order_acquire);
+            if (count == 0) continue;
+
+            uint32_t wanted = static_cast<uint32_t>(std::min<std::size_t>(limit - result.size(), count));
+            uint32_t first = count - wanted;
+
+            // Start from the index entry covering the first wanted record
+            std::vector<IndexEntry> index = segment.indexSnapshot();
+            std::size_t offset = 0;
+            uint32_t position = 0;
+            for (const auto& entry : index) {
+                if (entry.recordsBefore > first) break;
+                offset = entry.offset;
+                position = entry.recordsBefore;
+            }
+
+            std::vector<AuditRecord> chunk;
+            while (offset < end && position < count) {
+                const char* data = segment.data + offset;
+                if (position >= first) chunk.push_back(decode(data));
+                offset += padded(lengthAt(data));
+                ++position;
+            }
+            for (auto record = chunk.rbegin(); record != chunk.rend(); ++record) {
+                result.push_back(std::move(*record));
+            }
+        }
+        return result;
+    }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <Poco/Data/Session.h>
+#include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
+#include "../cluster/ClusterChannel.h"
+#include "../metrics/Metrics.h"
+
+using namespace Poco::Data::Keywords;
+using Poco::Data::Session;
+
+// Login credential for one account
+struct Credential {
+    int id = 0;
+    std::string passwordHash;
+
+    bool found() const { return id != 0; }
+};
+
+// (userType, username) -> (id, password hash) across the five account tables.
+//
+// Login only needs the id and the stored hash, so it probes this index instead
+// of hydrating the full model (a volunteer's task list, a provider's resources
+// and incident reports). A miss costs one query on the table's unique username
+// index and fills the entry; the models keep it current on save and remove.
+// In multi-process mode those changes evict the entry in the other workers.
+class CredentialIndex {
+private:
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, Credential> byUsername;  // "type\nusername"
+    std::unordered_map<std::string, std::string> usernameById;  // "type\nid" -> "type\nusername"
+
+    metrics::CacheStats stats = metrics::cache("credentials");
+
+    CredentialIndex() {
+        ClusterChannel::instance().subscribe("credentials.evict", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() != 2) return;
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            eraseLocked(fields[0], std::stoi(fields[1]));
+        });
+    }
+
+    static void evictElsewhere(const std::string& userType, int id) {
+        ClusterChannel::instance().publish("credentials.evict", {userType, std::to_string(id)});
+    }
+
+    static std::string usernameKey(const std::string& userType, const std::string& username) {
+        return userType + '\n' + username;
+    }
+
+    static std::string idKey(const std::string& userType, int id) {
+        return userType + '\n' + std::to_string(id);
+    }
+
+    // Caller holds the exclusive lock
+    void eraseLocked(const std::string& userType, int id) {
+        auto it = usernameById.find(idKey(userType, id));
+        if (it == usernameById.end()) return;
+        byUsername.erase(it->second);
+        usernameById.erase(it);
+    }
+
+    void putLocked(const std::string& userType, const std::string& username, const Credential& credential) {
+        eraseLocked(userType, credential.id);
+        std::string key = usernameKey(userType, username);
+        byUsername[key] = credential;
+        usernameById[idKey(userType, credential.id)] = key;
+    }
+
+public:
+    static CredentialIndex& instance() {
+        static CredentialIndex index;
+        return index;
+    }
+
+    // Table holding accounts of the given type; empty if the type is unknown
+    static std::string tableFor(const std::string& userType) {
+        if (userType == "people_in_crisis") return "people_in_crisis";
+        if (userType == "volunteer") return "volunteers";
+        if (userType == "relief_provider") return "relief_providers";
+        if (userType == "government_agency") return "government_agencies";
+        if (userType == "admin") return "admins";
+        return "";
+    }
+
+    Credential lookup(const std::string& userType, const std::string& username) {
+        std::string key = usernameKey(userType, username);
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto it = byUsername.find(key);
+            if (it != byUsername.end()) {
+                stats.record(true);
+                return it->second;
+            }
+        }
+        stats.record(false);
+
+        std::string table = tableFor(userType);
+        if (table.empty()) return Credential();
+
+        Credential credential;
+        try {
+            static metrics::Histogram& latency = metrics::dbStatement("credentials.find_by_username");
+            metrics::ScopedTimer timer(latency);
+            Session& session = DatabaseManager::getInstance()->getSession();
+            std::string usernameCopy = username;
+            session << "SELECT id, password FROM " + table + " WHERE username = ?",
+                into(credential.id), into(credential.passwordHash), use(usernameCopy), now;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error looking up credential: " << e.what());
+            return Credential();
+        }
+
+        // Unknown usernames are not cached, so accounts created elsewhere are found on the next try
+        if (credential.found()) {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            putLocked(userType, username, credential);
+        }
+        return credential;
+    }
+
+    void put(const std::string& userType, const std::string& username, int id, const std::string& passwordHash) {
+        if (id == 0 || username.empty()) return;
+        Credential credential;
+        credential.id = id;
+        credential.passwordHash = passwordHash;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            putLocked(userType, username, credential);
+        }
+        evictElsewhere(userType, id);
+    }
+
+    // Update the stored hash for an account that is already indexed
+    void updateHash(const std::string& userType, int id, const std::string& passwordHash) {
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            auto it = usernameById.find(idKey(userType, id));
+            if (it != usernameById.end()) {
+                byUsername[it->second].passwordHash = passwordHash;
+            }
+        }
+        evictElsewhere(userType, id);
+    }
+
+    void erase(const std::string& userType, int id) {
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            eraseLocked(userType, id);
+        }
+        evictElsewhere(userType, id);
+    }
+
+    void clear() {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        byUsername.clear();
+        usernameById.clear();
+    }
+
+    std::size_t size() {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return byUsername.size();
+    }
+};
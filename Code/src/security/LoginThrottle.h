@@ -0,0 +1,435 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <Poco/Data/Session.h>
+#include "../database/DatabaseManager.h"
+#include "../logging/Logger.h"
+#include "../cluster/ClusterChannel.h"
+#include "../metrics/Metrics.h"
+#include "AuditLog.h"
+
+using namespace Poco::Data::Keywords;
+using Poco::Data::Session;
+
+// Failed-login tracking and lockout.
+//
+// Failures are counted in memory in per-minute sliding windows keyed by
+// account and by client IP, spread over independently locked shards, so a
+// brute-force attempt costs a hash lookup and an increment rather than a
+// database write. An account locks once it reaches
+// security_settings.max_login_attempts failures within the lockout window; an
+// IP locks at kIpMultiplier times that, since many users can share one
+// address. Only accounts that exist get a window, and each shard holds at
+// most kMaxWindowsPerShard, so failures under made-up usernames or from many
+// addresses cannot grow memory without bound. Account and IP windows are kept
+// apart: a full shard evicts the longest idle IP windows first and never an
+// account window at or over the limit, so a spray from fresh addresses cannot
+// push a locked account out and lift its lockout. A global window answers failed_logins_last_hour without a scan,
+// and events reach the audit log in batches from a background writer. In
+// multi-process mode failures and successes are replayed in every worker so
+// the limits hold no matter which process a client reaches.
+class LoginThrottle {
+public:
+    static constexpr int kWindowMinutes = 60;
+    static constexpr int kLockoutMinutes = 15;
+    static constexpr int kIpMultiplier = 10;
+
+    struct Decision {
+        bool allowed;
+        int retryAfterSeconds;
+    };
+
+private:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kMaxWindowsPerShard = 4096;
+    static constexpr const char* kUnknownAccount = " (no such account)";
+
+    // Failure counts for the last kWindowMinutes, one bucket per minute
+    struct Window {
+        std::array<uint32_t, kWindowMinutes> counts{};
+        std::array<int64_t, kWindowMinutes> minutes{};
+        int64_t lastMinute = 0;
+
+        void add(int64_t minute) {
+            std::size_t slot = static_cast<std::size_t>(minute % kWindowMinutes);
+            if (minutes[slot] != minute) {
+                minutes[slot] = minute;
+                counts[slot] = 0;
+            }
+            ++counts[slot];
+            lastMinute = minute;
+        }
+
+        uint32_t sum(int64_t minute, int spanMinutes) const {
+            uint32_t total = 0;
+            for (int i = 0; i < spanMinutes; ++i) {
+                int64_t m = minute - i;
+                std::size_t slot = static_cast<std::size_t>(m % kWindowMinutes);
+                if (minutes[slot] == m) total += counts[slot];
+            }
+            return total;
+        }
+
+        // Minute in which the oldest failure still inside the span was recorded
+        int64_t oldest(int64_t minute, int spanMinutes) const {
+            for (int i = spanMinutes - 1; i >= 0; --i) {
+                int64_t m = minute - i;
+                std::size_t slot = static_cast<std::size_t>(m % kWindowMinutes);
+                if (minutes[slot] == m && counts[slot] > 0) return m;
+            }
+            return minute;
+        }
+    };
+
+    using Windows = std::unordered_map<std::string, Window>;
+
+    struct Shard {
+        std::mutex mutex;
+        Windows accounts;
+        Windows ips;
+
+        Windows& table(bool account) {
+            return account ? accounts : ips;
+        }
+    };
+
+    struct Event {
+        std::string type;
+        std::string subject;
+        std::string description;
+    };
+
+    std::array<Shard, kShards> shards;
+
+    // Global failures per minute for failed_logins_last_hour
+    std::array<std::atomic<uint32_t>, kWindowMinutes> globalCounts{};
+    std::array<std::atomic<int64_t>, kWindowMinutes> globalMinutes{};
+
+    std::atomic<int> maxAttempts{3};
+
+    std::mutex eventsMutex;
+    std::vector<Event> events;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread writer;
+
+    metrics::Counter& failures = metrics::Registry::instance().counter(
+        "auth_failed_logins_total", "Failed login attempts");
+    metrics::Counter& lockedOut = metrics::Registry::instance().counter(
+        "auth_lockout_rejections_total", "Login attempts rejected by an active lockout");
+
+    LoginThrottle() {
+        // Make sure the logger and audit log outlive the writer's final flush
+        logging::Logger::instance();
+        AuditLog::instance();
+        loadMaxAttempts();
+        subscribe();
+        writer = std::thread([this] { run(); });
+    }
+
+    ~LoginThrottle() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (writer.joinable()) writer.join();
+    }
+
+    static int64_t currentMinute() {
+        return static_cast<int64_t>(std::time(nullptr)) / 60;
+    }
+
+    static std::string accountKey(const std::string& userType, const std::string& username) {
+        return "u\n" + userType + "\n" + username;
+    }
+
+    static std::string ipKey(const std::string& clientIp) {
+        return "ip\n" + clientIp;
+    }
+
+    Shard& shardFor(const std::string& key) {
+        return shards[std::hash<std::string>()(key) % kShards];
+    }
+
+    // Seconds until the key drops below the limit, or 0 if it is under it
+    int lockedFor(const std::string& key, bool account, uint32_t limit, int64_t minute) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Windows& windows = shard.table(account);
+        auto it = windows.find(key);
+        if (it == windows.end()) return 0;
+        const Window& window = it->second;
+        if (window.sum(minute, kLockoutMinutes) < limit) return 0;
+        int64_t unlockMinute = window.oldest(minute, kLockoutMinutes) + kLockoutMinutes;
+        int64_t seconds = unlockMinute * 60 - static_cast<int64_t>(std::time(nullptr));
+        return seconds > 0 ? static_cast<int>(seconds) : 1;
+    }
+
+    // Drops every evictable window last touched in the oldest minute; false if none is evictable
+    template <typename Evictable>
+    static bool dropOldest(Windows& windows, Evictable evictable) {
+        int64_t oldest = INT64_MAX;
+        for (const auto& entry : windows) {
+            if (evictable(entry.second)) oldest = std::min(oldest, entry.second.lastMinute);
+        }
+        if (oldest == INT64_MAX) return false;
+        for (auto it = windows.begin(); it != windows.end();) {
+            if (it->second.lastMinute == oldest && evictable(it->second)) {
+                it = windows.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return true;
+    }
+
+    // Makes room in a full shard: IP windows first, then account windows
+    // under the limit. Locked accounts stay until prune() drops them, so the
+    // shard can exceed its size by the number of locked accounts in it.
+    static void evictOldest(Shard& shard, uint32_t limit, int64_t minute) {
+        if (dropOldest(shard.ips, [](const Window&) { return true; })) return;
+        dropOldest(shard.accounts, [&](const Window& window) { return window.sum(minute, kLockoutMinutes) < limit; });
+    }
+
+    // Returns the failure count within the lockout window after recording
+    uint32_t addFailure(const std::string& key, bool account, int64_t minute) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Windows& windows = shard.table(account);
+        if (shard.accounts.size() + shard.ips.size() >= kMaxWindowsPerShard && windows.find(key) == windows.end()) {
+            evictOldest(shard, static_cast<uint32_t>(maxAttempts.load(std::memory_order_relaxed)), minute);
+        }
+        Window& window = windows[key];
+        window.add(minute);
+        return window.sum(minute, kLockoutMinutes);
+    }
+
+    void enqueue(const std::string& type, const std::string& subject, const std::string& description) {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        if (events.size() < 10000) {
+            events.push_back({type, subject, description});
+        }
+    }
+
+    void persist(const std::vector<Event>& batch) {
+        if (batch.empty()) return;
+        AuditLog::instance().appendBatch(batch);
+    }
+
+    // Drop windows with no failures in the last hour
+    void prune(int64_t minute) {
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (Windows* windows : {&shard.accounts, &shard.ips}) {
+                for (auto it = windows->begin(); it != windows->end();) {
+                    if (it->second.lastMinute <= minute - kWindowMinutes) {
+                        it = windows->erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+        }
+    }
+
+    void run() {
+        int64_t lastPrune = currentMinute();
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::seconds(1));
+            lock.unlock();
+
+            std::vector<Event> batch;
+            {
+                std::lock_guard<std::mutex> eventsLock(eventsMutex);
+                batch.swap(events);
+            }
+            persist(batch);
+
+            int64_t minute = currentMinute();
+            if (minute != lastPrune) {
+                prune(minute);
+                lastPrune = minute;
+            }
+
+            lock.lock();
+        }
+        lock.unlock();
+
+        std::vector<Event> batch;
+        {
+            std::lock_guard<std::mutex> eventsLock(eventsMutex);
+            batch.swap(events);
+        }
+        persist(batch);
+    }
+
+    // Count a failure in the windows; returns the account's failures within the
+    // lockout window, or 0 for an account that does not exist
+    uint32_t countFailure(const std::string& userType, const std::string& username, const std::string& clientIp,
+                          bool accountExists, int64_t minute = currentMinute()) {
+        std::size_t slot = static_cast<std::size_t>(minute % kWindowMinutes);
+        int64_t slotMinute = globalMinutes[slot].load(std::memory_order_relaxed);
+        if (slotMinute != minute &&
+            globalMinutes[slot].compare_exchange_strong(slotMinute, minute, std::memory_order_relaxed)) {
+            globalCounts[slot].store(0, std::memory_order_relaxed);
+        }
+        globalCounts[slot].fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t accountFailures = accountExists ? addFailure(accountKey(userType, username), true, minute) : 0;
+        if (!clientIp.empty()) {
+            addFailure(ipKey(clientIp), false, minute);
+        }
+        return accountFailures;
+    }
+
+    // False if the account had no failures to clear
+    bool clearAccount(const std::string& userType, const std::string& username) {
+        std::string key = accountKey(userType, username);
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.accounts.erase(key) > 0;
+    }
+
+    // Replay other workers' outcomes without re-auditing them
+    void subscribe() {
+        ClusterChannel& channel = ClusterChannel::instance();
+        channel.subscribe("login.failure", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() == 4) countFailure(fields[0], fields[1], fields[2], fields[3] == "1");
+        });
+        channel.subscribe("login.success", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() == 2) clearAccount(fields[0], fields[1]);
+        });
+        channel.subscribe("login.max_attempts", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() == 1) setMaxAttempts(std::stoi(fields[0]), false);
+        });
+    }
+
+    void loadMaxAttempts() {
+        try {
+            Session& session = DatabaseManager::getInstance()->getSession();
+            int attempts = 0;
+            session << "SELECT max_login_attempts FROM security_settings ORDER BY id DESC LIMIT 1", into(attempts), now;
+            if (attempts > 0) maxAttempts.store(attempts, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error loading max login attempts: " << e.what());
+        }
+    }
+
+public:
+    static LoginThrottle& instance() {
+        static LoginThrottle throttle;
+        return throttle;
+    }
+
+    // Hand queued events to the audit log now instead of on the next tick
+    void flush() {
+        std::vector<Event> batch;
+        {
+            std::lock_guard<std::mutex> eventsLock(eventsMutex);
+            batch.swap(events);
+        }
+        persist(batch);
+    }
+
+    // Check before verifying the password
+    Decision check(const std::string& userType, const std::string& username, const std::string& clientIp) {
+        int64_t minute = currentMinute();
+        uint32_t limit = static_cast<uint32_t>(maxAttempts.load(std::memory_order_relaxed));
+        int retryAfter = lockedFor(accountKey(userType, username), true, limit, minute);
+        if (retryAfter == 0 && !clientIp.empty()) {
+            retryAfter = lockedFor(ipKey(clientIp), false, limit * kIpMultiplier, minute);
+        }
+        if (retryAfter > 0) {
+            lockedOut.inc();
+            return {false, retryAfter};
+        }
+        return {true, 0};
+    }
+
+    // accountExists: whether the username names an account; unknown ones count only against the IP
+    void recordFailure(const std::string& userType, const std::string& username, const std::string& clientIp,
+                       bool accountExists) {
+        failures.inc();
+        uint32_t limit = static_cast<uint32_t>(maxAttempts.load(std::memory_order_relaxed));
+        uint32_t accountFailures = countFailure(userType, username, clientIp, accountExists);
+        ClusterChannel::instance().publish("login.failure", {userType, username, clientIp, accountExists ? "1" : "0"});
+
+        std::string subject = userType + ":" + username;
+        enqueue("failed_login", subject,
+                userType + " '" + username + "' from " + clientIp + (accountExists ? "" : kUnknownAccount));
+        if (accountExists && accountFailures == limit) {
+            enqueue("account_locked", subject, userType + " '" + username + "' locked for " +
+                    std::to_string(kLockoutMinutes) + " minutes after " + std::to_string(limit) + " failed logins");
+        }
+    }
+
+    // A successful login clears the account's failures (not the IP's)
+    void recordSuccess(const std::string& userType, const std::string& username) {
+        if (clearAccount(userType, username)) {
+            // Lets restore() forget the failures too
+            enqueue("failures_cleared", userType + ":" + username, userType + " '" + username + "' signed in");
+        }
+        ClusterChannel::instance().publish("login.success", {userType, username});
+    }
+
+    // Replay the last kWindowMinutes of failed_login and failures_cleared
+    // events from the audit log, so a restart does not lift lockouts. Call
+    // once, after any previous process has flushed its events.
+    void restore() {
+        int64_t fromMs = (currentMinute() - kWindowMinutes + 1) * 60000;
+        std::size_t restored = 0;
+        std::string unknown = kUnknownAccount;
+        AuditLog::instance().scan(fromMs, INT64_MAX, [&](const AuditRecord& record) {
+            std::size_t colon = record.subject.find(':');
+            if (colon == std::string::npos) return true;
+            std::string userType = record.subject.substr(0, colon);
+            std::string username = record.subject.substr(colon + 1);
+            if (record.type == "failed_login") {
+                std::string description = record.description;
+                bool accountExists = description.size() < unknown.size() ||
+                    description.compare(description.size() - unknown.size(), unknown.size(), unknown) != 0;
+                if (!accountExists) description.resize(description.size() - unknown.size());
+                std::size_t from = description.rfind("' from ");
+                std::string clientIp = from == std::string::npos ? "" : description.substr(from + 7);
+                countFailure(userType, username, clientIp, accountExists, record.timestampMs / 60000);
+                ++restored;
+            } else if (record.type == "failures_cleared") {
+                clearAccount(userType, username);
+            }
+            return true;
+        });
+        if (restored > 0) LOG_INFO("Restored " << restored << " failed logins from the audit log");
+    }
+
+    uint32_t failedLoginsLastHour() const {
+        int64_t minute = currentMinute();
+        uint32_t total = 0;
+        for (int i = 0; i < kWindowMinutes; ++i) {
+            if (globalMinutes[i].load(std::memory_order_relaxed) > minute - kWindowMinutes) {
+                total += globalCounts[i].load(std::memory_order_relaxed);
+            }
+        }
+        return total;
+    }
+
+    void setMaxAttempts(int attempts, bool broadcast = true) {
+        if (attempts <= 0) return;
+        maxAttempts.store(attempts, std::memory_order_relaxed);
+        if (broadcast) ClusterChannel::instance().publish("login.max_attempts", {std::to_string(attempts)});
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <Poco/DigestEngine.h>
+#include <Poco/HMACEngine.h>
+#include <Poco/PBKDF2Engine.h>
+#include <Poco/RandomStream.h>
+#include <Poco/SHA2Engine.h>
+
+// The stored password format, "pbkdf2-sha256$<iterations>$<salt>$<key>".
+//
+// Kept apart from PasswordHasher, which runs these on its pool, so that
+// DatabaseManager can hash the admin it seeds and the plaintext rows it
+// migrates without depending on the pool.
+class PasswordHash {
+private:
+    typedef Poco::PBKDF2Engine<Poco::HMACEngine<Poco::SHA2Engine256>> PBKDF2;
+
+    static constexpr std::size_t kSaltBytes = 16;
+    static constexpr std::size_t kKeyBytes = 32;
+
+    static std::string toHex(const Poco::DigestEngine::Digest& bytes) {
+        return Poco::DigestEngine::digestToHex(bytes);
+    }
+
+public:
+    static constexpr const char* kScheme = "pbkdf2-sha256";
+    static constexpr unsigned kDefaultIterations = 100000;
+
+    static bool isHashed(const std::string& stored) {
+        std::size_t length = std::char_traits<char>::length(kScheme);
+        return stored.compare(0, length, kScheme) == 0 && stored.size() > length && stored[length] == '$';
+    }
+
+    static std::string derive(const std::string& password, const std::string& salt, unsigned rounds) {
+        PBKDF2 engine(salt, rounds, kKeyBytes);
+        engine.update(password);
+        return toHex(engine.digest());
+    }
+
+    // A stored value for password with a fresh random salt
+    static std::string make(const std::string& password, unsigned rounds) {
+        unsigned char bytes[kSaltBytes];
+        Poco::RandomInputStream random;
+        random.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+        std::string salt = toHex(Poco::DigestEngine::Digest(bytes, bytes + sizeof(bytes)));
+        return std::string(kScheme) + "$" + std::to_string(rounds) + "$" + salt + "$" + derive(password, salt, rounds);
+    }
+
+    // Splits "scheme$iterations$salt$key"; false if the value is not in that form
+    static bool parse(const std::string& stored, unsigned& rounds, std::string& salt, std::string& key) {
+        std::size_t first = stored.find('$');
+        std::size_t second = stored.find('$', first + 1);
+        std::size_t third = stored.find('$', second + 1);
+        if (first == std::string::npos || second == std::string::npos || third == std::string::npos) return false;
+        if (stored.compare(0, first, kScheme) != 0) return false;
+        try {
+            rounds = static_cast<unsigned>(std::stoul(stored.substr(first + 1, second - first - 1)));
+        } catch (const std::exception&) {
+            return false;
+        }
+        salt = stored.substr(second + 1, third - second - 1);
+        key = stored.substr(third + 1);
+        return rounds > 0;
+    }
+
+    static bool constantTimeEquals(const std::string& a, const std::string& b) {
+        if (a.size() != b.size()) return false;
+        unsigned char diff = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+        }
+        return diff == 0;
+    }
+};
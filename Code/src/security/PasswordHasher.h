@@ -0,0 +1,250 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Poco/DigestEngine.h>
+#include "../database/DatabaseManager.h"
+#include "PasswordHash.h"
+#include "../logging/Logger.h"
+#include "../metrics/Metrics.h"
+
+using namespace Poco::Data::Keywords;
+using Poco::Data::Session;
+
+enum class HashStatus { Match, Mismatch, Busy };
+
+struct PasswordCheck {
+    HashStatus status;
+    bool needsRehash;  // stored value uses older cost parameters
+};
+
+// Password hashing on a small dedicated pool.
+//
+// Hashes are PBKDF2-HMAC-SHA256 in the PasswordHash format. The work is
+// CPU-heavy by design, so it runs on a fixed number of hashing threads behind
+// a short queue: a login storm can occupy at most that many cores and queue
+// slots, and anything beyond is rejected immediately (Busy) instead of tying
+// up the HTTP workers that serve emergency endpoints. Plaintext rows were
+// hashed by schema version 5 (DatabaseManager), so a stored value that is
+// not a hash never matches; it still costs one hash, like any other login.
+class PasswordHasher {
+private:
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<std::function<void()>> queue;
+    std::deque<std::function<void()>> bulk;  // hashAll() jobs, taken only while queue is empty
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    std::size_t queueCapacity = 4;  // keeps most of the 16 HTTP workers free during a login storm
+    std::atomic<unsigned> iterations{PasswordHash::kDefaultIterations};
+    std::string dummy;  // see dummyHash(); rebuilt by configure()
+
+    metrics::Counter& rejected = metrics::Registry::instance().counter(
+        "password_hash_rejected_total", "Hashing jobs rejected because the queue was full");
+
+    PasswordHasher() {
+        // Make sure the logger outlives the workers
+        logging::Logger::instance();
+        dummy = makeDummy();
+        start(2);
+    }
+
+    ~PasswordHasher() {
+        stop();
+    }
+
+    void start(std::size_t threads) {
+        stopping = false;
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { run(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    void run() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this] { return stopping || !queue.empty() || !bulk.empty(); });
+                if (stopping && queue.empty() && bulk.empty()) return;
+                std::deque<std::function<void()>>& from = queue.empty() ? bulk : queue;
+                job = std::move(from.front());
+                from.pop_front();
+            }
+            job();
+        }
+    }
+
+    // Queue a job unless the pool is saturated
+    bool submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= queueCapacity) {
+                rejected.inc();
+                return false;
+            }
+            queue.push_back(std::move(job));
+        }
+        available.notify_one();
+        return true;
+    }
+
+    std::string makeDummy() {
+        return hashNow(Poco::DigestEngine::digestToHex(Poco::DigestEngine::Digest(16, 0)) + "-no-such-account");
+    }
+
+    // Run fn on the pool and wait for its result, or return false straight away if saturated
+    template <typename T>
+    bool runOnPool(std::function<T()> fn, T& result) {
+        auto task = std::make_shared<std::packaged_task<T()>>(std::move(fn));
+        std::future<T> future = task->get_future();
+        if (!submit([task] { (*task)(); })) return false;
+        result = future.get();
+        return true;
+    }
+
+public:
+    static PasswordHasher& instance() {
+        static PasswordHasher hasher;
+        return hasher;
+    }
+
+    // Resize the pool; callers must not be hashing concurrently
+    void configure(std::size_t threads, std::size_t capacity, unsigned rounds) {
+        stop();
+        queueCapacity = capacity > 0 ? capacity : 1;
+        iterations.store(rounds > 0 ? rounds : 1, std::memory_order_relaxed);
+        dummy = makeDummy();
+        start(threads > 0 ? threads : 1);
+    }
+
+    static bool isHashed(const std::string& stored) {
+        return PasswordHash::isHashed(stored);
+    }
+
+    // Hash on the calling thread (benchmarks and background migration)
+    std::string hashNow(const std::string& password) {
+        return PasswordHash::make(password, iterations.load(std::memory_order_relaxed));
+    }
+
+    // Hash on the pool; false if the pool is saturated
+    bool hash(const std::string& password, std::string& out) {
+        return runOnPool<std::string>([this, password] { return hashNow(password); }, out);
+    }
+
+    // Replace a plaintext password with its hash in place; false if the pool is saturated
+    bool ensureHashed(std::string& password) {
+        if (password.empty() || isHashed(password)) return true;
+        std::string hashed;
+        if (!hash(password, hashed)) return false;
+        password = hashed;
+        return true;
+    }
+
+    // Check a password against the stored value on the calling thread; a
+    // value that is not a hash is checked against dummyHash() and never matches
+    PasswordCheck verifyNow(const std::string& password, const std::string& stored) {
+        unsigned rounds = 0;
+        std::string salt, key;
+        bool valid = PasswordHash::parse(stored, rounds, salt, key);
+        if (!valid) PasswordHash::parse(dummy, rounds, salt, key);
+        bool match = PasswordHash::constantTimeEquals(PasswordHash::derive(password, salt, rounds), key) && valid;
+        bool stale = match && rounds != iterations.load(std::memory_order_relaxed);
+        return {match ? HashStatus::Match : HashStatus::Mismatch, stale};
+    }
+
+    // A hash at the current cost that no password is expected to match. Logins
+    // for unknown accounts are verified against it, so they take as long as
+    // logins for real ones and response time does not reveal which usernames
+    // exist. Built at startup and by configure(), never on a request thread.
+    const std::string& dummyHash() const {
+        return dummy;
+    }
+
+    // Check a password on the pool; Busy if the pool is saturated
+    PasswordCheck verify(const std::string& password, const std::string& stored) {
+        PasswordCheck check{HashStatus::Busy, false};
+        if (!runOnPool<PasswordCheck>([this, password, stored] { return verifyNow(password, stored); }, check)) {
+            return {HashStatus::Busy, false};
+        }
+        return check;
+    }
+
+    // Store a fresh hash for the row in the background; skipped if the pool is saturated
+    // (the row migrates on a later login instead). The update applies only while the
+    // row still holds stored, the value the password was verified against, so a
+    // password changed in the meantime is not overwritten. onStored runs after it.
+    void rehashAsync(const std::string& table, int id, const std::string& password, const std::string& stored,
+                     std::function<void(const std::string&)> onStored = nullptr) {
+        submit([this, table, id, plaintext = std::string(password), stored, onStored]() mutable {
+            try {
+                std::string hashed = hashNow(plaintext);
+                // Drop the plaintext as soon as it has been used
+                std::fill(plaintext.begin(), plaintext.end(), '\0');
+                plaintext.clear();
+
+                int rowId = id;
+                // A connection of its own: the shared one belongs to request threads
+                DatabaseManager* dbManager = DatabaseManager::getInstance();
+                std::unique_ptr<Session> own = dbManager->openSession();
+                Session& session = own ? *own : dbManager->getSession();
+                Statement update(session);
+                update << "UPDATE " + table + " SET password = ? WHERE id = ? AND password = ?",
+                    use(hashed), use(rowId), use(stored);
+                if (update.execute() > 0 && onStored) onStored(hashed);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Error rehashing password: " << e.what());
+            }
+        });
+    }
+
+    // Hash every password in place on the pool and wait for all of them
+    // (bulk imports). Each hash is its own job behind any queued login, so
+    // logins wait for at most one bulk hash per thread; bulk jobs are not
+    // counted against the queue capacity and are never rejected.
+    void hashAll(std::vector<std::string>& passwords) {
+        if (passwords.empty()) return;
+        std::vector<std::future<void>> done;
+        done.reserve(passwords.size());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::string& password : passwords) {
+                auto task = std::make_shared<std::packaged_task<void()>>([this, &password] {
+                    password = hashNow(password);
+                });
+                done.push_back(task->get_future());
+                bulk.push_back([task] { (*task)(); });
+            }
+        }
+        available.notify_all();
+        for (auto& future : done) future.get();
+    }
+
+    std::size_t queueDepth() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+};
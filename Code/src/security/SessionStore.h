@@ -0,0 +1,505 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <Poco/RandomStream.h>
+#include <Poco/Data/Session.h>
+#include "../database/DatabaseManager.h"
+#include "TokenHash.h"
+#include "../models/Timestamp.h"
+#include "../logging/Logger.h"
+#include "../cluster/ClusterChannel.h"
+
+using namespace Poco::Data::Keywords;
+using Poco::Data::Session;
+
+// Authenticated session issued at login
+struct SessionInfo {
+    int userId = 0;
+    std::string userType;
+    std::time_t createdAt = 0;
+    std::time_t expiresAt = 0;
+
+    bool valid() const { return userId != 0; }
+};
+
+// In-memory session store.
+//
+// Tokens live in a sharded hash map so validating a request is one shared
+// lock and one lookup, never a query. Expiry is handled by a one-second timer
+// wheel, and inserts/revocations are written to active_sessions by a
+// background thread so sessions survive a restart without the request thread
+// waiting on SQLite. The TTL comes from security_settings.session_timeout.
+//
+// Sessions are keyed by the token's SHA-256 (TokenHash.h), in memory and in
+// active_sessions alike; the token itself is only ever held by the client.
+//
+// Persisted sessions are loaded by recover(), which the server calls before
+// serving or, on a hot restart, once the previous process has flushed its
+// own. Until then a token missing from memory is looked up in active_sessions.
+//
+// In multi-process mode each worker keeps a full replica: issued and revoked
+// tokens are published on the cluster channel and applied by every other
+// worker, and only the supervisor writes them to active_sessions.
+class SessionStore {
+private:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kWheelSlots = 4096;  // one slot per second
+    static constexpr std::size_t kMaxPending = 100000;  // writes kept while the database refuses them
+    static constexpr std::chrono::seconds kMinReopenDelay{1};
+    static constexpr std::chrono::seconds kMaxReopenDelay{60};
+
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<std::string, SessionInfo> sessions;
+    };
+
+    struct WheelEntry {
+        std::string key;
+        std::time_t expiresAt;
+    };
+
+    struct PendingWrite {
+        bool insert;
+        std::string key;  // hashToken() of the token
+        SessionInfo info;
+    };
+
+    std::array<Shard, kShards> shards;
+
+    std::mutex wheelMutex;
+    std::array<std::vector<WheelEntry>, kWheelSlots> wheel;
+    std::time_t wheelTime = 0;  // last second the sweeper processed
+
+    std::mutex pendingMutex;
+    std::vector<PendingWrite> pending;
+
+    std::atomic<int> timeoutSeconds{3600};
+    std::atomic<std::size_t> activeCount{0};
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+    std::mutex persistMutex;        // one writer: the worker, or flush()
+    std::unique_ptr<Session> writer;  // the worker's own connection, opened on first use
+    std::chrono::steady_clock::time_point reopenAt;  // no new writer before this
+    std::chrono::seconds reopenDelay{kMinReopenDelay};
+
+    std::mutex recoveryMutex;
+    std::atomic<bool> recovered{false};
+    std::unordered_set<std::string> revokedEarly;  // revoked before recover(); not loaded by it
+
+    SessionStore() {
+        // Make sure the logger outlives the worker's final flush
+        logging::Logger::instance();
+        loadTimeout();
+        wheelTime = std::time(nullptr);
+        subscribe();
+        worker = std::thread([this] { run(); });
+    }
+
+    ~SessionStore() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+    Shard& shardFor(const std::string& key) {
+        return shards[std::hash<std::string>()(key) % kShards];
+    }
+
+    static std::string generateToken() {
+        unsigned char bytes[32];
+        Poco::RandomInputStream random;
+        random.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+
+        static const char* hex = "0123456789abcdef";
+        std::string token(sizeof(bytes) * 2, '0');
+        for (std::size_t i = 0; i < sizeof(bytes); ++i) {
+            token[2 * i] = hex[bytes[i] >> 4];
+            token[2 * i + 1] = hex[bytes[i] & 0x0f];
+        }
+        return token;
+    }
+
+    void schedule(const std::string& key, std::time_t expiresAt) {
+        std::lock_guard<std::mutex> lock(wheelMutex);
+        wheel[static_cast<std::size_t>(expiresAt) % kWheelSlots].push_back({key, expiresAt});
+    }
+
+    void enqueue(PendingWrite write) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.push_back(std::move(write));
+    }
+
+    // Workers leave persistence to the supervisor
+    static bool persistsLocally() {
+        return !ClusterChannel::instance().isWorker();
+    }
+
+    void insert(const std::string& key, const SessionInfo& info) {
+        bool added = false;
+        {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            added = shard.sessions.find(key) == shard.sessions.end();
+            shard.sessions[key] = info;
+        }
+        if (added) activeCount.fetch_add(1, std::memory_order_relaxed);
+        schedule(key, info.expiresAt);
+    }
+
+    bool erase(const std::string& key) {
+        {
+            Shard& shard = shardFor(key);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            if (shard.sessions.erase(key) == 0) return false;
+        }
+        activeCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Apply sessions issued and revoked by other processes
+    void subscribe() {
+        ClusterChannel& channel = ClusterChannel::instance();
+        channel.subscribe("session.create", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() != 5) return;
+            SessionInfo info;
+            info.userId = std::stoi(fields[1]);
+            info.userType = fields[2];
+            info.createdAt = static_cast<std::time_t>(std::stoll(fields[3]));
+            info.expiresAt = static_cast<std::time_t>(std::stoll(fields[4]));
+            insert(fields[0], info);
+            if (persistsLocally()) enqueue({true, fields[0], info});
+        });
+        channel.subscribe("session.revoke", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() != 1) return;
+            erase(fields[0]);
+            if (persistsLocally()) enqueue({false, fields[0], SessionInfo()});
+        });
+        channel.subscribe("session.timeout", [this](const ClusterChannel::Fields& fields) {
+            if (fields.size() == 1) setTimeout(std::stoi(fields[0]), false);
+        });
+    }
+
+    // Remove the session unless it was re-issued with a later expiry
+    bool expire(const std::string& key, std::time_t now) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(key);
+        if (it == shard.sessions.end() || it->second.expiresAt > now) return false;
+        shard.sessions.erase(it);
+        activeCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Advance the wheel up to now, expiring everything due
+    std::size_t sweep(std::time_t now) {
+        std::size_t expired = 0;
+        while (wheelTime < now) {
+            ++wheelTime;
+            std::vector<WheelEntry> due;
+            {
+                std::lock_guard<std::mutex> lock(wheelMutex);
+                auto& slot = wheel[static_cast<std::size_t>(wheelTime) % kWheelSlots];
+                // Entries more than one rotation away stay in the slot
+                for (auto it = slot.begin(); it != slot.end();) {
+                    if (it->expiresAt <= wheelTime) {
+                        due.push_back(std::move(*it));
+                        it = slot.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            for (const auto& entry : due) {
+                if (expire(entry.key, now)) ++expired;
+            }
+        }
+        return expired;
+    }
+
+    // Puts writes that failed back on the queue, ahead of anything queued since
+    void requeue(std::vector<PendingWrite>& writes) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        writes.insert(writes.end(), std::make_move_iterator(pending.begin()),
+                      std::make_move_iterator(pending.end()));
+        pending.swap(writes);
+        if (pending.size() > kMaxPending) {
+            LOG_ERROR("Dropping " << pending.size() - kMaxPending << " unpersisted session writes");
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(pending.size() - kMaxPending));
+        }
+    }
+
+    // Writes a batch in one transaction, so it costs one commit rather than
+    // one per login. If it fails the writes go back on the queue and the
+    // connection is reopened after a delay that doubles up to a minute;
+    // force (flush and shutdown) skips the delay.
+    void persist(std::vector<PendingWrite>& writes, bool purgeExpired, bool force = false) {
+        if (writes.empty() && !purgeExpired) return;
+        std::lock_guard<std::mutex> persistLock(persistMutex);
+        DatabaseManager* dbManager = DatabaseManager::getInstance();
+        // A transaction on the shared connection would take in other requests'
+        // statements; an in-memory database has no other, so it autocommits
+        bool transaction = !dbManager->inMemory();
+        if (transaction && !writer && !force && std::chrono::steady_clock::now() < reopenAt) {
+            requeue(writes);
+            return;
+        }
+
+        try {
+            if (transaction && !writer) writer = dbManager->openSession();
+            Session& session = transaction ? *writer : dbManager->getSession();
+            try {
+                if (transaction) session.begin();
+                for (auto& write : writes) {
+                    if (write.insert) {
+                        Poco::Int64 createdAt = static_cast<Poco::Int64>(write.info.createdAt) * 1000;
+                        Poco::Int64 expiresAt = static_cast<Poco::Int64>(write.info.expiresAt) * 1000;
+                        session << "INSERT OR REPLACE INTO active_sessions (user_id, user_type, session_token, created_at, expires_at) "
+                                   "VALUES (?, ?, ?, ?, ?)",
+                            use(write.info.userId), use(write.info.userType), use(write.key), use(createdAt), use(expiresAt), now;
+                    } else {
+                        session << "DELETE FROM active_sessions WHERE session_token = ?", use(write.key), now;
+                    }
+                }
+                if (purgeExpired && persistsLocally()) {
+                    Poco::Int64 cutoff = nowMillis();
+                    session << "DELETE FROM active_sessions WHERE expires_at <= ?", use(cutoff), now;
+                }
+                if (transaction) session.commit();
+            } catch (const std::exception&) {
+                try {
+                    if (transaction && session.isTransaction()) session.rollback();
+                } catch (const std::exception& rollbackError) {
+                    LOG_ERROR("Error rolling back session writes: " << rollbackError.what());
+                }
+                throw;
+            }
+            reopenDelay = kMinReopenDelay;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error persisting sessions: " << e.what());
+            if (!transaction) return;  // autocommitted writes before the failure are in
+            writer.reset();
+            reopenAt = std::chrono::steady_clock::now() + reopenDelay;
+            reopenDelay = std::min(reopenDelay * 2, kMaxReopenDelay);
+            requeue(writes);
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (!stopping) {
+            wake.wait_for(lock, std::chrono::seconds(1));
+            lock.unlock();
+
+            std::size_t expired = sweep(std::time(nullptr));
+            std::vector<PendingWrite> writes;
+            {
+                std::lock_guard<std::mutex> pendingLock(pendingMutex);
+                writes.swap(pending);
+            }
+            persist(writes, expired > 0);
+
+            lock.lock();
+        }
+        lock.unlock();
+
+        std::vector<PendingWrite> writes;
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex);
+            writes.swap(pending);
+        }
+        persist(writes, false, true);
+    }
+
+    void loadTimeout() {
+        try {
+            Session& session = DatabaseManager::getInstance()->getSession();
+            int timeout = 0;
+            session << "SELECT session_timeout FROM security_settings ORDER BY id DESC LIMIT 1", into(timeout), now;
+            if (timeout > 0) timeoutSeconds.store(timeout, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error loading session timeout: " << e.what());
+        }
+    }
+
+    // A stored session, for tokens validated before recover() has run
+    SessionInfo lookupStored(const std::string& key) {
+        {
+            std::lock_guard<std::mutex> lock(recoveryMutex);
+            if (revokedEarly.count(key)) return SessionInfo();
+        }
+        SessionInfo info;
+        try {
+            Session& session = DatabaseManager::getInstance()->getSession();
+            std::string lookup = key;
+            Poco::Int64 cutoff = nowMillis();
+            Poco::Int64 created = 0;
+            Poco::Int64 expires = 0;
+            Statement select(session);
+            select << "SELECT user_id, user_type, created_at / 1000, expires_at / 1000 FROM active_sessions "
+                      "WHERE session_token = ? AND expires_at > ?",
+                use(lookup), use(cutoff), into(info.userId), into(info.userType), into(created), into(expires),
+                limit(1);
+            if (select.execute() == 0) return SessionInfo();
+            info.createdAt = static_cast<std::time_t>(created);
+            info.expiresAt = static_cast<std::time_t>(expires);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error looking up session: " << e.what());
+            return SessionInfo();
+        }
+        return info;
+    }
+
+public:
+    static SessionStore& instance() {
+        static SessionStore store;
+        return store;
+    }
+
+    // Issue a token for a successful login; returns the token
+    std::string create(int userId, const std::string& userType, SessionInfo* issued = nullptr) {
+        SessionInfo info;
+        info.userId = userId;
+        info.userType = userType;
+        info.createdAt = std::time(nullptr);
+        info.expiresAt = info.createdAt + timeoutSeconds.load(std::memory_order_relaxed);
+
+        std::string token = generateToken();
+        std::string key = hashToken(token);
+        insert(key, info);
+        bool published = ClusterChannel::instance().publish("session.create", {
+            key, std::to_string(userId), userType,
+            std::to_string(static_cast<long long>(info.createdAt)),
+            std::to_string(static_cast<long long>(info.expiresAt))});
+        if (!published) enqueue({true, key, info});
+
+        if (issued) *issued = info;
+        return token;
+    }
+
+    // Load sessions still valid in active_sessions and drop expired ones.
+    // Sessions issued or revoked here in the meantime are kept as they are.
+    void recover() {
+        try {
+            Session& session = DatabaseManager::getInstance()->getSession();
+            std::vector<int> userIds;
+            std::vector<std::string> userTypes;
+            std::vector<std::string> keys;
+            std::vector<Poco::Int64> created;
+            std::vector<Poco::Int64> expires;
+            Poco::Int64 cutoff = nowMillis();
+            session << "SELECT user_id, user_type, session_token, created_at / 1000, expires_at / 1000 "
+                       "FROM active_sessions WHERE expires_at > ?",
+                into(userIds), into(userTypes), into(keys), into(created), into(expires), use(cutoff), now;
+
+            std::lock_guard<std::mutex> lock(recoveryMutex);
+            for (std::size_t i = 0; i < keys.size(); ++i) {
+                if (revokedEarly.count(keys[i])) continue;
+                SessionInfo info;
+                info.userId = userIds[i];
+                info.userType = userTypes[i];
+                info.createdAt = static_cast<std::time_t>(created[i]);
+                info.expiresAt = static_cast<std::time_t>(expires[i]);
+                bool added = false;
+                {
+                    Shard& shard = shardFor(keys[i]);
+                    std::unique_lock<std::shared_mutex> shardLock(shard.mutex);
+                    added = shard.sessions.emplace(keys[i], info).second;
+                }
+                if (!added) continue;
+                activeCount.fetch_add(1, std::memory_order_relaxed);
+                schedule(keys[i], info.expiresAt);
+            }
+            revokedEarly.clear();
+            recovered.store(true, std::memory_order_release);
+            session << "DELETE FROM active_sessions WHERE expires_at <= ?", use(cutoff), now;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Error recovering sessions: " << e.what());
+        }
+    }
+
+    // Look up a token; returns an invalid SessionInfo if unknown or expired
+    SessionInfo validate(const std::string& token) {
+        if (token.empty()) return SessionInfo();
+        std::string key = hashToken(token);
+        {
+            Shard& shard = shardFor(key);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.sessions.find(key);
+            if (it != shard.sessions.end()) {
+                if (it->second.expiresAt <= std::time(nullptr)) return SessionInfo();
+                return it->second;
+            }
+        }
+        if (!recovered.load(std::memory_order_acquire)) return lookupStored(key);
+        return SessionInfo();
+    }
+
+    bool revoke(const std::string& token) {
+        if (token.empty()) return false;
+        std::string key = hashToken(token);
+        bool removed = false;
+        if (recovered.load(std::memory_order_acquire)) {
+            removed = erase(key);
+        } else {
+            // It may only be in active_sessions so far; keep recover() from loading it
+            std::lock_guard<std::mutex> lock(recoveryMutex);
+            removed = erase(key);
+            if (!recovered.load(std::memory_order_relaxed)) {
+                revokedEarly.insert(key);
+                removed = true;
+            }
+        }
+        if (!removed) return false;
+        if (!ClusterChannel::instance().publish("session.revoke", {key})) {
+            enqueue({false, key, SessionInfo()});
+        }
+        return true;
+    }
+
+    // Write queued inserts and revocations now instead of on the next tick
+    void flush() {
+        std::vector<PendingWrite> writes;
+        {
+            std::lock_guard<std::mutex> pendingLock(pendingMutex);
+            writes.swap(pending);
+        }
+        persist(writes, false, true);
+    }
+
+    // Applies to sessions issued from now on
+    void setTimeout(int seconds, bool broadcast = true) {
+        if (seconds <= 0) return;
+        timeoutSeconds.store(seconds, std::memory_order_relaxed);
+        if (broadcast) ClusterChannel::instance().publish("session.timeout", {std::to_string(seconds)});
+    }
+
+    int getTimeout() const {
+        return timeoutSeconds.load(std::memory_order_relaxed);
+    }
+
+    std::size_t activeSessions() const {
+        return activeCount.load(std::memory_order_relaxed);
+    }
+};
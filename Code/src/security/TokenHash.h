@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <Poco/DigestEngine.h>
+#include <Poco/SHA2Engine.h>
+
+// SHA-256 of a bearer token as hex. Sessions are stored and looked up by
+// this, so neither active_sessions nor the cluster channel ever holds a
+// token that could be presented as it is.
+inline std::string hashToken(const std::string& token) {
+    Poco::SHA2Engine256 engine;
+    engine.update(token);
+    return Poco::DigestEngine::digestToHex(engine.digest());
+}